@@ -0,0 +1,95 @@
+// Cost of composing coroutines: a child call through co_await (symmetric transfer, no queue) vs
+// spawning the child and waiting on a Channel for its result, and a fan-out of CPU-bound children
+// run one after another vs through when_all. Reports ns per child call and ms per fan-out.
+// Usage: await_bench [workers] [calls] [fanout] [rounds]
+#include "scheduler.h"
+#include "channel.h"
+#include "when_all.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+Lazy<long> add_one(long x) { co_return x + 1; }
+
+Task add_one_spawned(long x, Channel<long>& out) { co_await out.send(x + 1); }
+
+// Stand-in for a backend call: some work that does not suspend
+Lazy<uint64_t> crunch(uint64_t seed, long iters) {
+    uint64_t h = seed;
+    for (long i = 0; i < iters; ++i) h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ull + i;
+    co_return h;
+}
+
+Task awaited_calls(long n, Join& done, long& sink) {
+    long v = 0;
+    for (long i = 0; i < n; ++i) v = co_await add_one(v);
+    sink = v;
+    done.arrive();
+}
+
+Task spawned_calls(Scheduler& s, long n, Join& done, long& sink) {
+    Channel<long> ch(s, 1);
+    long v = 0;
+    for (long i = 0; i < n; ++i) {
+        s.spawn(add_one_spawned(v, ch));
+        v = *co_await ch.recv();
+    }
+    sink = v;
+    done.arrive();
+}
+
+Task fan_out_serial(int k, long iters, Join& done, uint64_t& sink) {
+    uint64_t x = 0;
+    for (int i = 0; i < k; ++i) x ^= co_await crunch(i, iters);
+    sink = x;
+    done.arrive();
+}
+
+Task fan_out_parallel(Scheduler& s, int k, long iters, Join& done, uint64_t& sink) {
+    std::vector<Lazy<uint64_t>> calls;
+    for (int i = 0; i < k; ++i) calls.push_back(crunch(i, iters));
+    uint64_t x = 0;
+    for (uint64_t r : co_await when_all(s, std::move(calls))) x ^= r;
+    sink = x;
+    done.arrive();
+}
+
+template <typename Start>
+double best(int rounds, Start start) {
+    double best = 1e18;
+    for (int r = 0; r < rounds; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        Join done(1);
+        start(done);
+        done.wait();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    long n = argc > 2 ? std::atol(argv[2]) : 1000000;
+    int k = argc > 3 ? std::atoi(argv[3]) : 16;
+    int rounds = argc > 4 ? std::atoi(argv[4]) : 5;
+    constexpr long kIters = 2000000;
+
+    Scheduler s(workers);
+    long sink = 0;
+    uint64_t sink64 = 0;
+    std::printf("workers=%zu calls=%ld fanout=%d rounds=%d (best)\n", workers, n, k, rounds);
+    std::printf("%-22s %10.1f ns/call\n", "co_await Lazy<T>", best(rounds, [&](Join& d) {
+        s.spawn(awaited_calls(n, d, sink));
+    }) / n);
+    std::printf("%-22s %10.1f ns/call\n", "spawn + Channel", best(rounds, [&](Join& d) {
+        s.spawn(spawned_calls(s, n, d, sink));
+    }) / n);
+    std::printf("%-22s %10.2f ms\n", "fan-out sequential", best(rounds, [&](Join& d) {
+        s.spawn(fan_out_serial(k, kIters, d, sink64));
+    }) / 1e6);
+    std::printf("%-22s %10.2f ms\n", "fan-out when_all", best(rounds, [&](Join& d) {
+        s.spawn(fan_out_parallel(s, k, kIters, d, sink64));
+    }) / 1e6);
+    return sink == -1 && sink64 == 1; // Keep the results alive
+}
@@ -0,0 +1,795 @@
+// Benchmark suite: fixed workloads over the scheduler, the sync primitives, timers and the network
+// path, with JSON results so a change to GlobalQueue, StealQueue or the Poller can be compared run
+// to run. Every case runs --repeat times; the median is the result, min / max show the spread.
+//   spawn        empty tasks spawned from a task                        tasks/s
+//   yield        one task, co_await yield_now()                         ns/op
+//   ping_pong    two tasks, a round trip through two unbuffered Channels ns/op
+//   fan_out      steal_bench's tree: 64 mids x N leaves of ~200 ns work  tasks/s
+//   channel_mpmc 4 producers, 4 consumers, one Channel of 1024           msgs/s
+//   mutex        64 coroutines on one AsyncMutex                         ops/s
+//   timer        sleepers of 1-10 ms armed at once; lateness in extra    timers/s
+//   http / resp  loopback load from client coroutines on a second Scheduler, against an in-process
+//                server (HttpConnection / a RESP GET+SET loop) or --http-target / --resp-target
+//                (simple_http_web, mini_redis, bench/go)                 req/s, latency in extra
+// bench/go runs the same cases on the Go runtime and prints the same schema; bench/run_suite.sh
+// builds both in Release without sanitizers and runs them side by side.
+// Usage: bench_suite [--json path|-] [--repeat n] [--quick] [--only case,...] [--workers n]
+//                    [--client-workers n] [--connections n] [--depth n] [--seconds s]
+//                    [--http-target ip:port] [--resp-target ip:port] [--label s] [--meta key=value]
+#include "scheduler.h"
+#include "socket.h"
+#include "channel.h"
+#include "async_mutex.h"
+#include "http/http_connection.h"
+#include "redis/kv_store.h"
+#include "redis/resp_parser.h"
+#include "loopback.h"
+#include "latch.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define SUITE_SANITIZER "address"
+#elif defined(__SANITIZE_THREAD__)
+#define SUITE_SANITIZER "thread"
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SUITE_SANITIZER "address"
+#elif __has_feature(thread_sanitizer)
+#define SUITE_SANITIZER "thread"
+#endif
+#endif
+#ifndef SUITE_SANITIZER
+#define SUITE_SANITIZER "none"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int repeat = 5;
+    bool quick = false;
+    std::vector<std::string> only;
+    size_t workers = std::thread::hardware_concurrency();
+    size_t client_workers = std::max(1u, std::thread::hardware_concurrency() / 2);
+    int connections = 64;
+    int depth = 1;
+    double seconds = 2.0;
+    std::string http_target, resp_target;
+    std::string json, label;
+    std::vector<std::pair<std::string, std::string>> meta;
+
+    long scale(long full, long quick_n) const { return quick ? quick_n : full; }
+    bool wants(const char* name) const {
+        return only.empty() || std::find(only.begin(), only.end(), name) != only.end();
+    }
+};
+
+struct Result {
+    std::string name;
+    const char* unit;
+    bool higher_better;
+    std::vector<double> samples;
+    std::vector<std::pair<const char*, double>> params;
+    std::vector<std::pair<const char*, double>> extra;
+
+    Result(std::string n, const char* u, bool higher = true) : name(std::move(n)), unit(u), higher_better(higher) {}
+
+    double median() const {
+        std::vector<double> s = samples;
+        std::sort(s.begin(), s.end());
+        return s.empty() ? 0 : s.size() % 2 ? s[s.size() / 2] : (s[s.size() / 2 - 1] + s[s.size() / 2]) / 2;
+    }
+};
+
+static double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static uint64_t ns_since(Clock::time_point t0) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+}
+
+// Counters that move when the queues or the Poller change behaviour, summed over the repeats
+static void scheduler_extra(Result& r, const SchedulerStats& st) {
+    r.extra.push_back({"local_pops", double(st.local_pops)});
+    r.extra.push_back({"global_pops", double(st.global_pops)});
+    r.extra.push_back({"steals", double(st.steals)});
+    r.extra.push_back({"steal_failures", double(st.steal_failures)});
+    r.extra.push_back({"parks", double(st.parks)});
+    r.extra.push_back({"schedule_latency_p99_ns", double(st.schedule_latency.percentile(0.99))});
+}
+
+// ==========================================
+// 1. Scheduler
+// ==========================================
+
+Task empty_leaf(Join& join) {
+    join.arrive();
+    co_return;
+}
+
+Task spawner(Scheduler& s, Join& join, long n) {
+    for (long i = 0; i < n; ++i) s.spawn(empty_leaf(join));
+    co_return;
+}
+
+static Result bench_spawn(const Options& o) {
+    long n = o.scale(1'000'000, 200'000);
+    Result r{"spawn", "tasks/s"};
+    r.params = {{"tasks", double(n)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        Join join(n);
+        auto t0 = Clock::now();
+        s.spawn(spawner(s, join, n));
+        join.wait();
+        r.samples.push_back(n / seconds_since(t0));
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+Task yielder(long n, Join& join) {
+    for (long i = 0; i < n; ++i) co_await yield_now();
+    join.arrive();
+}
+
+static Result bench_yield(const Options& o) {
+    long n = o.scale(2'000'000, 500'000);
+    Result r{"yield", "ns/op", false};
+    r.params = {{"yields", double(n)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        Join join(1);
+        auto t0 = Clock::now();
+        s.spawn(yielder(n, join));
+        join.wait();
+        r.samples.push_back(seconds_since(t0) * 1e9 / n);
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+Task pinger(Channel<long>& out, Channel<long>& in, long n, Join& join) {
+    for (long i = 0; i < n; ++i) {
+        co_await out.send(i);
+        co_await in.recv();
+    }
+    join.arrive();
+}
+
+Task ponger(Channel<long>& in, Channel<long>& out, long n, Join& join) {
+    for (long i = 0; i < n; ++i) {
+        auto v = co_await in.recv();
+        co_await out.send(*v);
+    }
+    join.arrive();
+}
+
+static Result bench_ping_pong(const Options& o) {
+    long n = o.scale(500'000, 100'000);
+    Result r{"ping_pong", "ns/op", false};
+    r.params = {{"round_trips", double(n)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        Channel<long> a(s), b(s);
+        Join join(2);
+        auto t0 = Clock::now();
+        s.spawn(ponger(a, b, n, join));
+        s.spawn(pinger(a, b, n, join));
+        join.wait();
+        r.samples.push_back(seconds_since(t0) * 1e9 / n);
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+// A couple of hundred nanoseconds of pretend work
+static void burn(int iters) {
+    volatile unsigned x = 0;
+    for (int i = 0; i < iters; ++i) x = x * 31 + i;
+}
+
+Task work_leaf(Join& join, int work) {
+    burn(work);
+    join.arrive();
+    co_return;
+}
+
+Task fan_mid(Scheduler& s, Join& join, int leaves, int work) {
+    for (int i = 0; i < leaves; ++i) s.spawn(work_leaf(join, work));
+    join.arrive();
+    co_return;
+}
+
+Task fan_root(Scheduler& s, Join& join, int fanout, int leaves, int work) {
+    for (int i = 0; i < fanout; ++i) s.spawn(fan_mid(s, join, leaves, work));
+    co_return;
+}
+
+static Result bench_fan_out(const Options& o) {
+    const int fanout = 64, work = 200;
+    int leaves = int(o.scale(2000, 500));
+    long total = long(fanout) * leaves + fanout;
+    Result r{"fan_out", "tasks/s"};
+    r.params = {{"fanout", double(fanout)}, {"leaves", double(leaves)}, {"work", double(work)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        Join join(total);
+        auto t0 = Clock::now();
+        s.spawn(fan_root(s, join, fanout, leaves, work));
+        join.wait();
+        r.samples.push_back(total / seconds_since(t0));
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+// ==========================================
+// 2. Sync Primitives and Timers
+// ==========================================
+
+Task mpmc_producer(Channel<long>& ch, long n, Join& join) {
+    for (long i = 0; i < n; ++i) co_await ch.send(i);
+    join.arrive();
+}
+
+Task mpmc_consumer(Channel<long>& ch, std::atomic<long>& sum, Join& join) {
+    long local = 0;
+    while (auto v = co_await ch.recv()) local += *v;
+    sum.fetch_add(local);
+    join.arrive();
+}
+
+static Result bench_channel(const Options& o) {
+    const int producers = 4, consumers = 4;
+    const size_t capacity = 1024;
+    long n = o.scale(250'000, 50'000);
+    Result r{"channel_mpmc", "msgs/s"};
+    r.params = {{"producers", producers}, {"consumers", consumers}, {"capacity", double(capacity)},
+                {"msgs_per_producer", double(n)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        Channel<long> ch(s, capacity);
+        Join prod(producers), cons(consumers);
+        std::atomic<long> sum{0};
+        auto t0 = Clock::now();
+        for (int c = 0; c < consumers; ++c) s.spawn(mpmc_consumer(ch, sum, cons));
+        for (int p = 0; p < producers; ++p) s.spawn(mpmc_producer(ch, n, prod));
+        prod.wait();
+        ch.close();
+        cons.wait();
+        r.samples.push_back(producers * n / seconds_since(t0));
+        if (sum.load() != producers * (n * (n - 1) / 2)) std::fprintf(stderr, "channel_mpmc: checksum mismatch\n");
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+Task contender(AsyncMutex& mtx, long& counter, long n, Join& join) {
+    for (long i = 0; i < n; ++i) {
+        auto guard = co_await mtx.lock();
+        ++counter;
+    }
+    join.arrive();
+}
+
+static Result bench_mutex(const Options& o) {
+    const int coroutines = 64;
+    long n = o.scale(20'000, 5'000);
+    Result r{"mutex", "ops/s"};
+    r.params = {{"coroutines", coroutines}, {"ops_per_coroutine", double(n)}};
+    Scheduler s(o.workers);
+    for (int i = 0; i < o.repeat; ++i) {
+        AsyncMutex mtx(s);
+        long counter = 0;
+        Join join(coroutines);
+        auto t0 = Clock::now();
+        for (int c = 0; c < coroutines; ++c) s.spawn(contender(mtx, counter, n, join));
+        join.wait();
+        r.samples.push_back(coroutines * n / seconds_since(t0));
+        if (counter != coroutines * n) std::fprintf(stderr, "mutex: lost updates\n");
+    }
+    scheduler_extra(r, s.stats());
+    return r;
+}
+
+// Lateness: how long after its deadline the sleeper ran again (the wheel rounds up to 1 ms ticks)
+Task sleeper(Scheduler& s, int ms, uint64_t& late_ns, Join& join) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(ms);
+    co_await sleep_for(s, ms);
+    auto now = Clock::now();
+    late_ns = now > deadline ? uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count()) : 0;
+    join.arrive();
+}
+
+static Result bench_timer(const Options& o) {
+    long n = o.scale(100'000, 20'000);
+    Result r{"timer", "timers/s"};
+    r.params = {{"timers", double(n)}, {"min_ms", 1}, {"max_ms", 10}};
+    Scheduler s(o.workers);
+    Histogram late;
+    std::vector<uint64_t> late_ns(n);
+    for (int i = 0; i < o.repeat; ++i) {
+        Join join(n);
+        auto t0 = Clock::now();
+        for (long k = 0; k < n; ++k) s.spawn(sleeper(s, 1 + int(k % 10), late_ns[k], join));
+        join.wait();
+        r.samples.push_back(n / seconds_since(t0));
+        for (uint64_t v : late_ns) late.record(v);
+    }
+    r.extra = {{"late_p50_us", late.percentile(0.5) / 1e3},
+               {"late_p99_us", late.percentile(0.99) / 1e3},
+               {"late_max_us", late.max / 1e3},
+               {"timers_fired", double(s.stats().timers_fired)}};
+    return r;
+}
+
+// ==========================================
+// 3. Loopback Load
+// ==========================================
+
+static const char* kHttpRequest = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+static constexpr int kHttpPort = 18190;
+static constexpr int kRespPort = 18191;
+static constexpr int kRespKeys = 10000;
+static constexpr size_t kRespValue = 32;
+static constexpr int kRespGetPercent = 80;
+
+static bool split_target(const std::string& target, std::string& ip, int& port) {
+    size_t colon = target.rfind(':');
+    if (colon == std::string::npos) return false;
+    ip = target.substr(0, colon);
+    port = std::atoi(target.c_str() + colon + 1);
+    return port > 0;
+}
+
+// Blocking request / reply on a fresh connection, to learn reply sizes or load data before the run
+static bool exchange(const std::string& ip, int port, const std::string& req, size_t reply, std::string* out = nullptr) {
+    int fd = connect_to(ip, port);
+    if (fd < 0) return false;
+    bool ok = ::write(fd, req.data(), req.size()) == ssize_t(req.size());
+    std::string got;
+    char buf[16 * 1024];
+    while (ok && got.size() < reply) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        got.append(buf, size_t(n));
+        // Unknown length (reply == SIZE_MAX): one HTTP response, headers + Content-Length
+        size_t end = got.find("\r\n\r\n");
+        if (reply == SIZE_MAX && end != std::string::npos) {
+            std::string lower = got.substr(0, end);
+            for (char& c : lower) c = char(std::tolower(static_cast<unsigned char>(c)));
+            size_t cl = lower.find("content-length:");
+            if (cl == std::string::npos) break;
+            reply = end + 4 + std::strtoul(lower.c_str() + cl + 15, nullptr, 10);
+        }
+    }
+    ::close(fd);
+    if (out) *out = got;
+    return ok && got.size() >= reply && reply != SIZE_MAX;
+}
+
+// What one client coroutine sends per round trip, and how many reply bytes come back
+struct HttpWorkload {
+    size_t reply_len = 0;
+    size_t fill(std::string& out, uint64_t&, int depth) const {
+        for (int i = 0; i < depth; ++i) out += kHttpRequest;
+        return reply_len * size_t(depth);
+    }
+};
+
+// GET / SET over preloaded keys of fixed-size values, so reply sizes are known in advance
+struct RespWorkload {
+    static void append_command(std::string& out, std::initializer_list<std::string_view> args) {
+        out += '*' + std::to_string(args.size()) + "\r\n";
+        for (std::string_view a : args) {
+            out += '$' + std::to_string(a.size()) + "\r\n";
+            out.append(a).append("\r\n");
+        }
+    }
+    static std::string key(int i) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "key:%06d", i);
+        return buf;
+    }
+    size_t fill(std::string& out, uint64_t& rng, int depth) const {
+        static const std::string value(kRespValue, 'v');
+        static const size_t get_reply = std::to_string(kRespValue).size() + 5 + kRespValue;
+        size_t want = 0;
+        for (int i = 0; i < depth; ++i) {
+            rng ^= rng << 13, rng ^= rng >> 7, rng ^= rng << 17;
+            std::string k = key(int(rng % kRespKeys));
+            if (int(rng >> 32) % 100 < kRespGetPercent) {
+                append_command(out, {"GET", k});
+                want += get_reply;
+            } else {
+                append_command(out, {"SET", k, value});
+                want += 5; // +OK\r\n
+            }
+        }
+        return want;
+    }
+};
+
+struct ClientStats {
+    Histogram latency; // ns per round trip of `depth` requests
+    uint64_t requests = 0;
+};
+
+template <typename Workload>
+Task load_client(AsyncSocket sock, const Workload& w, int depth, std::atomic<bool>& stop, ClientStats& stats,
+                 Join& join) {
+    std::string batch;
+    std::vector<char> buf(64 * 1024);
+    uint64_t rng = uint64_t(sock.fd()) * 0x9E3779B97F4A7C15ull | 1;
+    bool open = true;
+    while (open && !stop.load(std::memory_order_relaxed)) {
+        batch.clear();
+        size_t want = w.fill(batch, rng, depth), got = 0;
+        auto t0 = Clock::now();
+        if (co_await sock.write_all(batch.data(), batch.size()) < 0) break;
+        while (got < want) {
+            ssize_t n = co_await sock.read(buf.data(), buf.size());
+            if (n <= 0) {
+                open = false;
+                break;
+            }
+            got += size_t(n);
+        }
+        if (!open) break;
+        stats.latency.record(ns_since(t0));
+        stats.requests += uint64_t(depth);
+    }
+    join.arrive();
+}
+
+// One run: `connections` client coroutines on their own Scheduler, for o.seconds
+template <typename Workload>
+static double drive(const Options& o, const std::string& ip, int port, const Workload& w, Histogram& latency) {
+    Scheduler clients(o.client_workers);
+    std::vector<ClientStats> stats(size_t(o.connections));
+    std::atomic<bool> stop{false};
+    Join join(o.connections);
+    for (int i = 0; i < o.connections; ++i) {
+        int fd = connect_to(ip, port);
+        if (fd < 0) {
+            join.arrive();
+            continue;
+        }
+        clients.spawn(load_client(AsyncSocket(fd, clients.reactor()), w, o.depth, stop, stats[size_t(i)], join));
+    }
+    auto t0 = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.seconds));
+    stop.store(true);
+    join.wait();
+    double elapsed = seconds_since(t0);
+    uint64_t requests = 0;
+    for (const ClientStats& s : stats) {
+        latency.merge(s.latency);
+        requests += s.requests;
+    }
+    return double(requests) / elapsed;
+}
+
+// Runs `body(ip, port)` against an in-process server built from on_accept, or against `target`
+template <typename F, typename Body>
+static bool with_server(const Options& o, const std::string& target, int port, F on_accept, Result& r, Body body) {
+    if (!target.empty()) {
+        std::string ip;
+        int tport = 0;
+        if (!split_target(target, ip, tport)) {
+            std::fprintf(stderr, "%s: bad target '%s'\n", r.name.c_str(), target.c_str());
+            return false;
+        }
+        return body(ip, tport);
+    }
+    Scheduler sched(o.workers);
+    LoopbackServer server(sched, port);
+    if (!server.bound()) {
+        std::perror("bind");
+        return false;
+    }
+    server.start(on_accept);
+    bool ok = body(std::string("127.0.0.1"), port);
+    server.shutdown();
+    SchedulerStats st = sched.stats();
+    r.extra.push_back({"server_reactor_waits", double(st.reactor_waits)});
+    r.extra.push_back({"server_reactor_batch_p50", double(st.reactor_batch.percentile(0.5))});
+    r.extra.push_back({"server_steals", double(st.steals)});
+    r.extra.push_back({"server_parks", double(st.parks)});
+    return ok;
+}
+
+static void latency_extra(Result& r, const Histogram& latency) {
+    r.extra.push_back({"latency_p50_us", latency.percentile(0.5) / 1e3});
+    r.extra.push_back({"latency_p99_us", latency.percentile(0.99) / 1e3});
+    r.extra.push_back({"latency_max_us", latency.max / 1e3});
+}
+
+static void net_params(const Options& o, Result& r) {
+    r.params = {{"connections", o.connections}, {"depth", o.depth}, {"seconds", o.seconds},
+                {"client_workers", double(o.client_workers)}};
+}
+
+static Result bench_http(const Options& o) {
+    Result r{"http", "req/s"};
+    net_params(o, r);
+    HttpRouter router;
+    router.get("/", [](const HttpRequest&, HttpResponse& res) { res.body_ref = "Hello, World!"; });
+    auto serve = [&router](AsyncSocket s) { return HttpConnection::serve(std::move(s), router); };
+    Histogram latency;
+    bool ok = with_server(o, o.http_target, kHttpPort, serve, r, [&](const std::string& ip, int port) {
+        std::string reply;
+        HttpWorkload w;
+        if (!exchange(ip, port, kHttpRequest, SIZE_MAX, &reply)) return false;
+        w.reply_len = reply.size();
+        for (int i = 0; i < o.repeat; ++i) r.samples.push_back(drive(o, ip, port, w, latency));
+        return true;
+    });
+    if (!ok) std::fprintf(stderr, "http: no server\n");
+    latency_extra(r, latency);
+    return r;
+}
+
+// The mini_redis command loop, cut down to GET / SET / PING
+Task resp_conn(AsyncSocket client, ShardedKvStore& kv) {
+    IoBuffer in;
+    RespParser parser;
+    std::vector<std::string_view> args;
+    std::string out;
+    while (true) {
+        if (parser.needed() > in.size()) in.reserve(parser.needed());
+        if (co_await client.read(in) <= 0) co_return;
+        while (true) {
+            std::string_view w = in.front();
+            long used = parser.parse(w.data(), w.size(), args);
+            if (used == RespParser::kIncomplete) {
+                if (in.grow_front(std::max(parser.needed(), w.size() + 1))) continue;
+                break;
+            }
+            if (used == RespParser::kError) co_return;
+            if (args.size() == 2 && args[0] == "GET") {
+                if (!kv.get(args[1], [&](std::string_view v) {
+                        out.append("$").append(std::to_string(v.size())).append("\r\n").append(v).append("\r\n");
+                    })) {
+                    out.append("$-1\r\n");
+                }
+            } else if (args.size() == 3 && args[0] == "SET") {
+                kv.set(args[1], args[2]);
+                out.append("+OK\r\n");
+            } else if (!args.empty() && args[0] == "PING") {
+                out.append("+PONG\r\n");
+            } else {
+                out.append("-ERR unknown command\r\n");
+            }
+            in.consume(used);
+        }
+        if (!out.empty()) {
+            if (co_await client.write_all(out.data(), out.size()) < 0) co_return;
+            out.clear();
+        }
+    }
+}
+
+static Result bench_resp(const Options& o) {
+    Result r{"resp", "req/s"};
+    net_params(o, r);
+    r.params.push_back({"keys", kRespKeys});
+    r.params.push_back({"value_size", double(kRespValue)});
+    r.params.push_back({"get_percent", kRespGetPercent});
+    ShardedKvStore kv(std::max<size_t>(1, o.workers) * 16);
+    auto serve = [&kv](AsyncSocket s) { return resp_conn(std::move(s), kv); };
+    Histogram latency;
+    bool ok = with_server(o, o.resp_target, kRespPort, serve, r, [&](const std::string& ip, int port) {
+        // Every key is set before the clock starts, so each GET returns a value of known size
+        const std::string value(kRespValue, 'v');
+        for (int base = 0; base < kRespKeys; base += 1000) {
+            std::string load;
+            int n = std::min(1000, kRespKeys - base);
+            for (int i = 0; i < n; ++i) RespWorkload::append_command(load, {"SET", RespWorkload::key(base + i), value});
+            if (!exchange(ip, port, load, size_t(n) * 5)) return false;
+        }
+        RespWorkload w;
+        for (int i = 0; i < o.repeat; ++i) r.samples.push_back(drive(o, ip, port, w, latency));
+        return true;
+    });
+    if (!ok) std::fprintf(stderr, "resp: no server\n");
+    latency_extra(r, latency);
+    return r;
+}
+
+// ==========================================
+// 4. Output
+// ==========================================
+
+static void json_string(std::string& out, std::string_view s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    out += '"';
+}
+
+static void json_number(std::string& out, double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    out += buf;
+}
+
+static void json_object(std::string& out, const std::vector<std::pair<const char*, double>>& kv) {
+    out += '{';
+    for (size_t i = 0; i < kv.size(); ++i) {
+        if (i) out += ',';
+        json_string(out, kv[i].first);
+        out += ':';
+        json_number(out, kv[i].second);
+    }
+    out += '}';
+}
+
+static std::string to_json(const Options& o, const std::vector<Result>& results) {
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+#ifdef __clang__
+    std::string compiler = std::string("clang ") + __clang_version__;
+#else
+    std::string compiler = std::string("gcc ") + __VERSION__;
+#endif
+
+    std::string out = "{\"schema\":1,\"suite\":\"tinycoro\",\"label\":";
+    json_string(out, o.label);
+    out += ",\"timestamp\":";
+    json_string(out, stamp);
+    out += ",\"host\":";
+    json_string(out, host);
+    out += ",\"cpus\":" + std::to_string(std::thread::hardware_concurrency());
+    out += ",\"workers\":" + std::to_string(o.workers);
+    out += ",\"repeat\":" + std::to_string(o.repeat);
+    out += ",\"compiler\":";
+    json_string(out, compiler);
+#ifdef __OPTIMIZE__
+    out += ",\"optimized\":true";
+#else
+    out += ",\"optimized\":false";
+#endif
+    out += ",\"sanitizer\":\"" SUITE_SANITIZER "\"";
+#ifdef TINYCORO_IO_URING
+    out += ",\"io_backend\":\"io_uring\"";
+#else
+    out += ",\"io_backend\":\"default\"";
+#endif
+    out += ",\"meta\":{";
+    for (size_t i = 0; i < o.meta.size(); ++i) {
+        if (i) out += ',';
+        json_string(out, o.meta[i].first);
+        out += ':';
+        json_string(out, o.meta[i].second);
+    }
+    out += "},\"cases\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        if (i) out += ',';
+        out += "\n{\"name\":";
+        json_string(out, r.name);
+        out += ",\"unit\":";
+        json_string(out, r.unit);
+        out += r.higher_better ? ",\"better\":\"higher\",\"median\":" : ",\"better\":\"lower\",\"median\":";
+        json_number(out, r.median());
+        out += ",\"min\":";
+        json_number(out, r.samples.empty() ? 0 : *std::min_element(r.samples.begin(), r.samples.end()));
+        out += ",\"max\":";
+        json_number(out, r.samples.empty() ? 0 : *std::max_element(r.samples.begin(), r.samples.end()));
+        out += ",\"samples\":[";
+        for (size_t k = 0; k < r.samples.size(); ++k) {
+            if (k) out += ',';
+            json_number(out, r.samples[k]);
+        }
+        out += "],\"params\":";
+        json_object(out, r.params);
+        out += ",\"extra\":";
+        json_object(out, r.extra);
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view a = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--json") o.json = value();
+        else if (a == "--repeat") o.repeat = std::max(1, std::atoi(value()));
+        else if (a == "--quick") o.quick = true;
+        else if (a == "--workers") o.workers = std::strtoul(value(), nullptr, 10);
+        else if (a == "--client-workers") o.client_workers = std::strtoul(value(), nullptr, 10);
+        else if (a == "--connections") o.connections = std::max(1, std::atoi(value()));
+        else if (a == "--depth") o.depth = std::max(1, std::atoi(value()));
+        else if (a == "--seconds") o.seconds = std::atof(value());
+        else if (a == "--http-target") o.http_target = value();
+        else if (a == "--resp-target") o.resp_target = value();
+        else if (a == "--label") o.label = value();
+        else if (a == "--meta") {
+            std::string kv = value();
+            size_t eq = kv.find('=');
+            o.meta.push_back({kv.substr(0, eq), eq == std::string::npos ? "" : kv.substr(eq + 1)});
+        } else if (a == "--only") {
+            std::string list = value();
+            for (size_t pos = 0; pos <= list.size();) {
+                size_t comma = std::min(list.find(',', pos), list.size());
+                if (comma > pos) o.only.push_back(list.substr(pos, comma - pos));
+                pos = comma + 1;
+            }
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+    if (o.quick && o.repeat == 5) o.repeat = 3;
+    if (o.quick && o.seconds == 2.0) o.seconds = 0.5;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) return 2;
+    // With the JSON on stdout, the table goes to stderr
+    std::FILE* table = o.json == "-" ? stderr : stdout;
+
+    if (std::strcmp(SUITE_SANITIZER, "none") != 0) {
+        std::fprintf(stderr, "warning: built with the %s sanitizer, numbers are not comparable\n", SUITE_SANITIZER);
+    }
+#ifndef __OPTIMIZE__
+    std::fprintf(stderr, "warning: built without optimization, numbers are not comparable\n");
+#endif
+
+    using Case = Result (*)(const Options&);
+    const std::pair<const char*, Case> cases[] = {
+        {"spawn", bench_spawn},         {"yield", bench_yield},   {"ping_pong", bench_ping_pong},
+        {"fan_out", bench_fan_out},     {"channel_mpmc", bench_channel}, {"mutex", bench_mutex},
+        {"timer", bench_timer},         {"http", bench_http},     {"resp", bench_resp},
+    };
+
+    std::fprintf(table, "workers=%zu client_workers=%zu repeat=%d%s (median, min, max)\n", o.workers,
+                 o.client_workers, o.repeat, o.quick ? " quick" : "");
+    std::fprintf(table, "%-14s %10s %14s %14s %14s\n", "case", "unit", "median", "min", "max");
+    std::vector<Result> results;
+    for (const auto& [name, run] : cases) {
+        if (!o.wants(name)) continue;
+        Result r = run(o);
+        if (r.samples.empty()) continue;
+        std::fprintf(table, "%-14s %10s %14.1f %14.1f %14.1f\n", r.name.c_str(), r.unit, r.median(),
+                     *std::min_element(r.samples.begin(), r.samples.end()),
+                     *std::max_element(r.samples.begin(), r.samples.end()));
+        std::fflush(table);
+        results.push_back(std::move(r));
+    }
+
+    if (!o.json.empty()) {
+        std::string doc = to_json(o, results);
+        std::FILE* f = o.json == "-" ? stdout : std::fopen(o.json.c_str(), "w");
+        if (!f) {
+            std::perror(o.json.c_str());
+            return 1;
+        }
+        std::fwrite(doc.data(), 1, doc.size(), f);
+        if (f != stdout) std::fclose(f);
+    }
+    return 0;
+}
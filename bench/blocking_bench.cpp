@@ -0,0 +1,94 @@
+// Blocking calls inside coroutines: tasks that each make a few slow "disk" calls (a 5 ms
+// usleep) share the Workers with a probe that sleeps 1 ms in a loop, as in fairness_bench.
+// Made inline, every call stalls the Worker and whatever is queued on it; through
+// spawn_blocking() it stalls a pool thread instead. Also reports the round-trip cost of an
+// empty spawn_blocking() call.
+// Usage: blocking_bench [workers] [tasks] [calls_per_task] [roundtrips]
+#include "scheduler.h"
+#include "latch.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr useconds_t kDiskCall = 5000;
+
+Task slow_inline(int calls, Join& done) {
+    for (int i = 0; i < calls; ++i) ::usleep(kDiskCall);
+    done.arrive();
+    co_return;
+}
+
+Task slow_offloaded(Scheduler& s, int calls, Join& done) {
+    for (int i = 0; i < calls; ++i) co_await s.spawn_blocking([] { ::usleep(kDiskCall); });
+    done.arrive();
+}
+
+Task probe(Scheduler& s, std::vector<double>& late_us, std::atomic<bool>& stop, Join& done) {
+    while (!stop.load(std::memory_order_relaxed)) {
+        auto due = Clock::now() + std::chrono::milliseconds(1);
+        co_await sleep_for(s, 1);
+        late_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - due).count());
+    }
+    done.arrive();
+}
+
+Task roundtrips(Scheduler& s, long n, Join& done, long& sink) {
+    long v = 0;
+    for (long i = 0; i < n; ++i) v += co_await s.spawn_blocking([i] { return i; });
+    sink = v;
+    done.arrive();
+}
+
+static double pct(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+static void run(const char* name, bool offload, size_t workers, int tasks, int calls) {
+    Scheduler s(workers);
+    std::vector<double> late;
+    std::atomic<bool> stop{false};
+    Join work(tasks), probe_done(1);
+
+    auto t0 = Clock::now();
+    s.spawn(probe(s, late, stop, probe_done));
+    for (int i = 0; i < tasks; ++i) s.spawn(offload ? slow_offloaded(s, calls, work) : slow_inline(calls, work));
+    work.wait();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    auto st = s.stats();
+    stop.store(true);
+    probe_done.wait();
+
+    double p50 = pct(late, 0.5), p99 = pct(late, 0.99), max = pct(late, 1.0);
+    std::printf("%-14s %10.1f %8zu %10.0f %10.0f %10.0f %10zu\n", name, ms, late.size(), p50, p99, max,
+                st.blocking_threads);
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2;
+    int tasks = argc > 2 ? std::atoi(argv[2]) : 64;
+    int calls = argc > 3 ? std::atoi(argv[3]) : 10;
+    long n = argc > 4 ? std::atol(argv[4]) : 100000;
+
+    std::printf("workers=%zu tasks=%d calls_per_task=%d (%u us each)\n", workers, tasks, calls, kDiskCall);
+    std::printf("%-14s %10s %8s %10s %10s %10s %10s\n", "disk calls", "total ms", "probes", "p50 us", "p99 us",
+                "max us", "pool thr");
+    run("inline", false, workers, tasks, calls);
+    run("spawn_blocking", true, workers, tasks, calls);
+
+    Scheduler s(workers);
+    Join done(1);
+    long sink = 0;
+    auto t0 = Clock::now();
+    s.spawn(roundtrips(s, n, done, sink));
+    done.wait();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    std::printf("spawn_blocking round trip: %.0f ns (%ld calls)\n", ns / n, n);
+    return sink == -1; // Keep the result alive
+}
@@ -0,0 +1,265 @@
+// Channel throughput: MPMC producers/consumers through one buffered channel, lock-free ring
+// (single and batched ops) vs the previous mutex + std::queue implementation. Then a two-input
+// fan-in, merged by one forwarding coroutine per input vs a single select().
+// Usage: channel_bench [workers] [producers] [consumers] [msgs_per_producer] [capacity]
+#include "channel.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+// The previous Channel implementation, kept here as the baseline
+template <typename T>
+class MutexChannel {
+public:
+    MutexChannel(Scheduler& sched, size_t capacity = 0)
+        : sched_(sched), capacity_(capacity), closed_(false) {}
+    MutexChannel(const MutexChannel&) = delete;
+    MutexChannel& operator=(const MutexChannel&) = delete;
+    ~MutexChannel() { close(); }
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (closed_) return;
+        closed_ = true;
+        while (!send_waiters_.empty()) {
+            auto& w = send_waiters_.front();
+            sched_.spawn(Task::from_address(w.handle.address()));
+            send_waiters_.pop();
+        }
+        while (!recv_waiters_.empty()) {
+            auto& w = recv_waiters_.front();
+            if (w.result_ptr) *w.result_ptr = std::nullopt;
+            sched_.spawn(Task::from_address(w.handle.address()));
+            recv_waiters_.pop();
+        }
+    }
+    bool is_closed() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return closed_;
+    }
+    struct SendAwaiter {
+        MutexChannel& chan;
+        T value;
+        bool result = true;
+        bool await_ready() { return false; }
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            std::lock_guard<std::mutex> lock(chan.mtx_);
+            if (chan.closed_) {
+                result = false;
+                return false;
+            }
+            if (!chan.recv_waiters_.empty()) {
+                auto& waiter = chan.recv_waiters_.front();
+                *waiter.result_ptr = std::move(value);
+                chan.sched_.spawn(Task::from_address(waiter.handle.address()));
+                chan.recv_waiters_.pop();
+                return false;
+            }
+            if (chan.buffer_.size() < chan.capacity_) {
+                chan.buffer_.push(std::move(value));
+                return false;
+            }
+            Task::retain(h);
+            chan.send_waiters_.push({h, &value});
+            return true;
+        }
+        bool await_resume() { return result; }
+    };
+    struct RecvAwaiter {
+        MutexChannel& chan;
+        std::optional<T> result;
+        bool await_ready() { return false; }
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            std::lock_guard<std::mutex> lock(chan.mtx_);
+            if (!chan.buffer_.empty()) {
+                result = std::move(chan.buffer_.front());
+                chan.buffer_.pop();
+                if (!chan.send_waiters_.empty()) {
+                    auto& sender = chan.send_waiters_.front();
+                    chan.buffer_.push(std::move(*sender.value_ptr));
+                    chan.sched_.spawn(Task::from_address(sender.handle.address()));
+                    chan.send_waiters_.pop();
+                }
+                return false;
+            }
+            if (!chan.send_waiters_.empty()) {
+                auto& sender = chan.send_waiters_.front();
+                result = std::move(*sender.value_ptr);
+                chan.sched_.spawn(Task::from_address(sender.handle.address()));
+                chan.send_waiters_.pop();
+                return false;
+            }
+            if (chan.closed_) {
+                result = std::nullopt;
+                return false;
+            }
+            Task::retain(h);
+            chan.recv_waiters_.push({h, &result});
+            return true;
+        }
+        std::optional<T> await_resume() { return std::move(result); }
+    };
+    SendAwaiter send(T val) { return SendAwaiter{*this, std::move(val)}; }
+    RecvAwaiter recv() { return RecvAwaiter{*this, std::nullopt}; }
+private:
+    struct SenderWaiter {
+        std::coroutine_handle<> handle;
+        T* value_ptr;
+    };
+    struct RecvWaiter {
+        std::coroutine_handle<> handle;
+        std::optional<T>* result_ptr;
+    };
+    Scheduler& sched_;
+    size_t capacity_;
+    bool closed_;
+    mutable std::mutex mtx_;
+    std::queue<T> buffer_;
+    std::queue<SenderWaiter> send_waiters_;
+    std::queue<RecvWaiter> recv_waiters_;
+};
+
+constexpr size_t kBatch = 32;
+
+template <typename Chan>
+Task producer(Chan& ch, Join& join, long n, bool batch) {
+    if constexpr (requires { ch.send_batch(nullptr, 0); }) {
+        if (batch) {
+            long buf[kBatch];
+            for (long i = 0; i < n;) {
+                size_t k = std::min<long>(kBatch, n - i);
+                for (size_t j = 0; j < k; ++j) buf[j] = i + j;
+                for (size_t off = 0; off < k;) off += co_await ch.send_batch(buf + off, k - off);
+                i += k;
+            }
+            join.arrive();
+            co_return;
+        }
+    }
+    for (long i = 0; i < n; ++i) co_await ch.send(i);
+    join.arrive();
+}
+
+template <typename Chan>
+Task consumer(Chan& ch, Join& join, std::atomic<long>& sum, bool batch) {
+    long local = 0;
+    if constexpr (requires { ch.recv_batch(nullptr, 0); }) {
+        if (batch) {
+            long buf[kBatch];
+            while (size_t k = co_await ch.recv_batch(buf, kBatch)) {
+                for (size_t j = 0; j < k; ++j) local += buf[j];
+            }
+            sum.fetch_add(local);
+            join.arrive();
+            co_return;
+        }
+    }
+    while (auto v = co_await ch.recv()) local += *v;
+    sum.fetch_add(local);
+    join.arrive();
+}
+
+template <typename Chan>
+double run(Scheduler& s, int producers, int consumers, long n, size_t cap, bool batch) {
+    Chan ch(s, cap);
+    Join prod(producers), cons(consumers);
+    std::atomic<long> sum{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) s.spawn(consumer(ch, cons, sum, batch));
+    for (int p = 0; p < producers; ++p) s.spawn(producer(ch, prod, n, batch));
+    prod.wait();
+    ch.close();
+    cons.wait();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sum.load() != producers * (n * (n - 1) / 2)) std::printf("checksum mismatch\n");
+    return producers * n / sec / 1e6;
+}
+
+// Fan-in: one producer per input channel, a single consumer merging them
+Task forward(Channel<long>& in, Channel<long>& out, Join& join) {
+    while (auto v = co_await in.recv()) co_await out.send(*v);
+    join.arrive();
+}
+
+Task merge_forwarded(Channel<long>& merged, Join& join, std::atomic<long>& sum) {
+    long local = 0;
+    while (auto v = co_await merged.recv()) local += *v;
+    sum.fetch_add(local);
+    join.arrive();
+}
+
+Task merge_select(Channel<long>& a, Channel<long>& b, Join& join, std::atomic<long>& sum) {
+    long local = 0;
+    Channel<long>* rest = nullptr;
+    while (!rest) {
+        auto r = co_await select(a.recv(), b.recv());
+        auto& v = r.index() == 0 ? std::get<0>(r) : std::get<1>(r);
+        if (v) local += *v;
+        else rest = r.index() == 0 ? &b : &a; // One input closed: drain the other
+    }
+    while (auto v = co_await rest->recv()) local += *v;
+    sum.fetch_add(local);
+    join.arrive();
+}
+
+double run_fan_in(Scheduler& s, long n, size_t cap, bool use_select) {
+    Channel<long> a(s, cap), b(s, cap), merged(s, cap);
+    Join prod(2), fwd(2), cons(1);
+    std::atomic<long> sum{0};
+    auto start = std::chrono::steady_clock::now();
+    if (use_select) {
+        s.spawn(merge_select(a, b, cons, sum));
+    } else {
+        s.spawn(merge_forwarded(merged, cons, sum));
+        s.spawn(forward(a, merged, fwd));
+        s.spawn(forward(b, merged, fwd));
+    }
+    s.spawn(producer(a, prod, n, false));
+    s.spawn(producer(b, prod, n, false));
+    prod.wait();
+    a.close();
+    b.close();
+    if (!use_select) {
+        fwd.wait();
+        merged.close();
+    }
+    cons.wait();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sum.load() != 2 * (n * (n - 1) / 2)) std::printf("checksum mismatch\n");
+    return 2 * n / sec / 1e6;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int producers = argc > 2 ? std::atoi(argv[2]) : 4;
+    int consumers = argc > 3 ? std::atoi(argv[3]) : 4;
+    long n = argc > 4 ? std::atol(argv[4]) : 500000;
+    size_t cap = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 1024;
+    const int rounds = 3;
+
+    Scheduler s(workers);
+    std::printf("workers=%zu producers=%d consumers=%d msgs/producer=%ld capacity=%zu (best of %d)\n",
+                workers, producers, consumers, n, cap, rounds);
+    std::printf("%-22s %10s\n", "channel", "Mmsg/s");
+    double best[3] = {0, 0, 0};
+    for (int r = 0; r < rounds; ++r) {
+        best[0] = std::max(best[0], run<MutexChannel<long>>(s, producers, consumers, n, cap, false));
+        best[1] = std::max(best[1], run<Channel<long>>(s, producers, consumers, n, cap, false));
+        best[2] = std::max(best[2], run<Channel<long>>(s, producers, consumers, n, cap, true));
+    }
+    std::printf("%-22s %10.2f\n", "mutex+std::queue", best[0]);
+    std::printf("%-22s %10.2f\n", "ring", best[1]);
+    std::printf("%-22s %10.2f\n", "ring, batch of 32", best[2]);
+
+    double fan_in[2] = {0, 0};
+    for (int r = 0; r < rounds; ++r) {
+        fan_in[0] = std::max(fan_in[0], run_fan_in(s, n, cap, false));
+        fan_in[1] = std::max(fan_in[1], run_fan_in(s, n, cap, true));
+    }
+    std::printf("%-22s %10s\n", "fan-in of 2", "Mmsg/s");
+    std::printf("%-22s %10.2f\n", "forwarders", fan_in[0]);
+    std::printf("%-22s %10.2f\n", "select", fan_in[1]);
+    return 0;
+}
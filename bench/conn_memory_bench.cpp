@@ -0,0 +1,94 @@
+// Memory of idle keep-alive connections: N handlers wait on their sockets (socketpairs), once
+// with a fixed `char buf[8192]` in the coroutine frame and once with an IoBuffer that only takes
+// a pooled chunk while it has unparsed bytes. Reports the RSS growth per connection while all of
+// them are parked, the chunks held at that point, and the ping/pong rate over every connection.
+// Usage: conn_memory_bench [connections] [rounds] [workers]
+#include "scheduler.h"
+#include "socket.h"
+#include <sys/socket.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static constexpr std::string_view kPong = "+PONG\r\n";
+
+Task fixed_handler(AsyncSocket s) {
+    char buf[8192];
+    while (true) {
+        ssize_t n = co_await s.read(buf, sizeof(buf));
+        if (n <= 0) break;
+        if (co_await s.write_all(kPong.data(), kPong.size()) < 0) break;
+    }
+}
+
+Task pooled_handler(AsyncSocket s) {
+    IoBuffer in;
+    while (true) {
+        ssize_t n = co_await s.read(in);
+        if (n <= 0) break;
+        in.consume(in.size());
+        if (co_await s.write_all(kPong.data(), kPong.size()) < 0) break;
+    }
+}
+
+static long rss_kb() {
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+template <typename Handler>
+static void run(const char* name, Handler handler, int conns, int rounds, size_t workers) {
+    Scheduler s(workers);
+    std::vector<int> clients(conns);
+    long before = rss_kb();
+    for (int i = 0; i < conns; ++i) {
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+            std::perror("socketpair");
+            std::exit(1);
+        }
+        clients[i] = sv[0];
+        s.spawn(handler(AsyncSocket(sv[1], s.reactor())));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // Everyone parked in read()
+    long idle = rss_kb() - before;
+    uint64_t held = BufferPool::stats().in_use;
+
+    char buf[64];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int c : clients) (void)!::write(c, "PING\r\n", 6);
+        for (int c : clients) {
+            size_t got = 0;
+            while (got < kPong.size()) {
+                ssize_t n = ::read(c, buf, sizeof(buf));
+                if (n <= 0) std::exit(1);
+                got += n;
+            }
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("%-14s %12.2f %12llu %12.0f\n", name, idle * 1024.0 / conns, static_cast<unsigned long long>(held),
+                static_cast<double>(conns) * rounds / secs);
+    for (int c : clients) ::close(c);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Handlers see EOF and finish
+}
+
+int main(int argc, char** argv) {
+    int conns = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2;
+
+    std::printf("connections=%d rounds=%d workers=%zu\n", conns, rounds, workers);
+    std::printf("%-14s %12s %12s %12s\n", "buffer", "idle B/conn", "chunks held", "pings/s");
+    // The pooled run goes first: frames of the other size class then cannot reuse its memory
+    run("IoBuffer", pooled_handler, conns, rounds, workers);
+    run("char[8192]", fixed_handler, conns, rounds, workers);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Starvation under busy coroutines: "hog" tasks whose awaits never suspend (send/recv on their
+// own buffered Channel) share the Workers with a probe that sleeps 1 ms in a loop. The probe's
+// wake-up comes back through the global queue; its lateness is the scheduling delay a light
+// connection sees next to heavy ones. Compares coop_budget = 0 (no forced yields) with the
+// default CoopBudget, and reports the hogs' throughput for the cost side.
+// Usage: fairness_bench [workers] [hogs] [ops_per_hog] [probes]
+#include "channel.h"
+#include "latch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+Task hog(Scheduler& s, long ops, Join& done) {
+    Channel<long> ch(s, 1);
+    for (long i = 0; i < ops; ++i) {
+        co_await ch.send(i);
+        co_await ch.recv();
+    }
+    done.arrive();
+}
+
+Task probe(Scheduler& s, int n, std::vector<double>& late_us, std::atomic<bool>& hogs_done, Join& done) {
+    for (int i = 0; i < n && !hogs_done.load(std::memory_order_relaxed); ++i) {
+        auto due = Clock::now() + std::chrono::milliseconds(1);
+        co_await sleep_for(s, 1);
+        late_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - due).count());
+    }
+    done.arrive();
+}
+
+static double pct(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+static void run(const char* name, int budget, size_t workers, int hogs, long ops, int probes) {
+    Scheduler s(SchedulerOptions{.workers = workers, .coop_budget = budget});
+    std::vector<double> late;
+    late.reserve(probes);
+    std::atomic<bool> hogs_done{false};
+    Join hog_done(hogs), probe_done(1);
+
+    auto t0 = Clock::now();
+    s.spawn(probe(s, probes, late, hogs_done, probe_done));
+    for (int i = 0; i < hogs; ++i) s.spawn(hog(s, ops, hog_done));
+    hog_done.wait();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    hogs_done.store(true);
+    probe_done.wait();
+
+    double p50 = pct(late, 0.5), p99 = pct(late, 0.99), max = pct(late, 1.0);
+    std::printf("%-14s %10.2f %8zu %10.0f %10.0f %10.0f %10llu\n", name, hogs * ops * 2 / secs / 1e6, late.size(),
+                p50, p99, max, static_cast<unsigned long long>(s.stats().yields));
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    int hogs = argc > 2 ? std::atoi(argv[2]) : 8;
+    long ops = argc > 3 ? std::atol(argv[3]) : 2000000;
+    int probes = argc > 4 ? std::atoi(argv[4]) : 200;
+
+    std::printf("workers=%zu hogs=%d ops_per_hog=%ld\n", workers, hogs, ops);
+    std::printf("%-14s %10s %8s %10s %10s %10s %10s\n", "budget", "hog Mops/s", "probes", "p50 us", "p99 us",
+                "max us", "yields");
+    run("off", 0, workers, hogs, ops, probes);
+    run("default (128)", CoopBudget::kDefault, workers, hogs, ops, probes);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Coroutine frame allocation: an accept-loop style producer spawns short-lived handlers that finish
+// (and free their frames) on other Workers.
+// Usage: frame_pool_bench [workers] [tasks] [rounds]
+// Build with -DTINYCORO_NO_FRAME_POOL for the plain operator new baseline.
+#include "scheduler.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Frame sizes of a small handler and of one holding a read buffer, like handle_client
+Task small_handler(Join& join) {
+    join.arrive();
+    co_return;
+}
+
+Task buffered_handler(Join& join) {
+    volatile char buf[1024];
+    buf[0] = 1;
+    if (buf[0]) join.arrive();
+    co_return;
+}
+
+Task producer(Scheduler& s, Join& join, long n) {
+    for (long i = 0; i < n; ++i) {
+        if (i & 1) s.spawn(buffered_handler(join));
+        else s.spawn(small_handler(join));
+    }
+    co_return;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    long tasks = argc > 2 ? std::atol(argv[2]) : 1000000;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+
+#ifdef TINYCORO_NO_FRAME_POOL
+    std::printf("frames: global operator new\n");
+#else
+    std::printf("frames: FramePool\n");
+#endif
+    std::printf("workers=%zu tasks=%ld rounds=%d\n", workers, tasks, rounds);
+    Scheduler s(workers);
+    double best = 1e18;
+    FrameStats warm{};
+    for (int r = 0; r < rounds; ++r) {
+        if (r == 1) warm = FramePool::stats(); // The first round fills the pool
+        Join join(tasks);
+        auto t0 = std::chrono::steady_clock::now();
+        s.spawn(producer(s, join, tasks));
+        join.wait();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+    std::printf("best %.2f ms, %.1f ns/task\n", best, best * 1e6 / tasks);
+
+    FrameStats st = FramePool::stats();
+    if (rounds > 1) {
+        st.pool_hits -= warm.pool_hits;
+        st.heap_allocs -= warm.heap_allocs;
+        st.oversize -= warm.oversize;
+        st.depot_puts -= warm.depot_puts;
+        st.depot_gets -= warm.depot_gets;
+    }
+    std::printf("after warm-up:\n");
+    uint64_t pooled = st.pool_hits + st.heap_allocs;
+    std::printf("pool_hits=%llu heap_allocs=%llu oversize=%llu depot_puts=%llu depot_gets=%llu hit_rate=%.4f\n",
+                (unsigned long long)st.pool_hits, (unsigned long long)st.heap_allocs,
+                (unsigned long long)st.oversize, (unsigned long long)st.depot_puts,
+                (unsigned long long)st.depot_gets, pooled ? double(st.pool_hits) / pooled : 0.0);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// GlobalQueue microbenchmark: lock-free ring vs the previous mutex + std::deque queue.
+// Usage: global_queue_bench [producers] [consumers] [ops_per_producer]
+#include "queue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Trivial payload: the queues only move addresses around
+struct Item {
+    void* p = nullptr;
+    static Item from_address(void* a) { return Item{a}; }
+    void* detach() { return p; }
+};
+
+// The previous GlobalQueue implementation, kept here as the baseline
+class MutexDequeQueue {
+    std::deque<void*> queue_;
+    std::mutex mtx_;
+public:
+    void push_batch(void* const* ptrs, size_t n) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (size_t i = 0; i < n; ++i) queue_.push_back(ptrs[i]);
+    }
+    size_t pop_batch(void** out, size_t max) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t k = 0;
+        while (k < max && !queue_.empty()) {
+            out[k++] = queue_.front();
+            queue_.pop_front();
+        }
+        return k;
+    }
+};
+
+template <typename Q>
+double run(Q& q, int producers, int consumers, size_t ops, size_t batch) {
+    std::atomic<size_t> consumed{0};
+    const size_t total = ops * producers;
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<void*> buf(batch);
+            for (size_t i = 0; i < ops; i += batch) {
+                size_t n = std::min(batch, ops - i);
+                for (size_t j = 0; j < n; ++j) buf[j] = reinterpret_cast<void*>((uintptr_t)(p + 1) << 32 | (i + j + 1));
+                q.push_batch(buf.data(), n);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            std::vector<void*> buf(batch);
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                size_t n = q.pop_batch(buf.data(), batch);
+                if (n) consumed.fetch_add(n, std::memory_order_relaxed);
+                else std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double sec = std::chrono::duration<double>(end - start).count();
+    return total / sec / 1e6;
+}
+
+int main(int argc, char** argv) {
+    int producers = argc > 1 ? std::atoi(argv[1]) : 4;
+    int consumers = argc > 2 ? std::atoi(argv[2]) : 4;
+    size_t ops = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000000;
+
+    std::printf("producers=%d consumers=%d ops/producer=%zu\n", producers, consumers, ops);
+    std::printf("%-18s %6s %12s\n", "queue", "batch", "Mops/s");
+    for (size_t batch : {1, 16, 128}) {
+        MutexDequeQueue baseline;
+        GlobalQueue<Item> lockfree;
+        std::printf("%-18s %6zu %12.2f\n", "mutex+deque", batch, run(baseline, producers, consumers, ops, batch));
+        std::printf("%-18s %6zu %12.2f\n", "GlobalQueue", batch, run(lockfree, producers, consumers, ops, batch));
+    }
+    return 0;
+}
@@ -0,0 +1,3 @@
+module tinycoro-bench-go
+
+go 1.21
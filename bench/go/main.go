@@ -0,0 +1,566 @@
+// The Go baseline for bench/bench_suite.cpp: the same cases with the same parameters on the Go
+// runtime (goroutines for tasks, runtime.Gosched for yield_now, chan for Channel, sync.Mutex for
+// AsyncMutex, time.Sleep for sleep_for), printed in the same JSON schema. With --serve-http /
+// --serve-resp it serves the suite's loopback workloads instead, so bench_suite's own load
+// generator (--http-target / --resp-target) measures the Go network path the same way.
+//
+// Usage:
+//
+//	go_suite [--json path|-] [--repeat n] [--quick] [--only case,...] [--workers n]
+//	         [--label s] [--meta key=value]... [--serve-http ip:port] [--serve-resp ip:port]
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"errors"
+	"flag"
+	"fmt"
+	"hash/fnv"
+	"io"
+	"net"
+	"os"
+	"runtime"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+type result struct {
+	Name    string             `json:"name"`
+	Unit    string             `json:"unit"`
+	Better  string             `json:"better"`
+	Median  float64            `json:"median"`
+	Min     float64            `json:"min"`
+	Max     float64            `json:"max"`
+	Samples []float64          `json:"samples"`
+	Params  map[string]float64 `json:"params"`
+	Extra   map[string]float64 `json:"extra"`
+}
+
+type report struct {
+	Schema    int               `json:"schema"`
+	Suite     string            `json:"suite"`
+	Label     string            `json:"label"`
+	Timestamp string            `json:"timestamp"`
+	Host      string            `json:"host"`
+	CPUs      int               `json:"cpus"`
+	Workers   int               `json:"workers"`
+	Repeat    int               `json:"repeat"`
+	Compiler  string            `json:"compiler"`
+	Optimized bool              `json:"optimized"`
+	Sanitizer string            `json:"sanitizer"`
+	Meta      map[string]string `json:"meta"`
+	Cases     []result          `json:"cases"`
+}
+
+type metaFlag map[string]string
+
+func (m metaFlag) String() string { return "" }
+func (m metaFlag) Set(v string) error {
+	k, val, _ := strings.Cut(v, "=")
+	m[k] = val
+	return nil
+}
+
+var (
+	jsonPath  = flag.String("json", "", "write the results as JSON to this path (- for stdout)")
+	repeat    = flag.Int("repeat", 5, "runs per case; the median is reported")
+	quick     = flag.Bool("quick", false, "smaller workloads (and 3 repeats unless --repeat is given)")
+	only      = flag.String("only", "", "comma-separated cases to run")
+	workers   = flag.Int("workers", runtime.NumCPU(), "GOMAXPROCS")
+	label     = flag.String("label", "", "free-form label stored in the JSON")
+	serveHTTP = flag.String("serve-http", "", "serve the http workload on ip:port instead of running cases")
+	serveRESP = flag.String("serve-resp", "", "serve the resp workload on ip:port instead of running cases")
+	meta      = metaFlag{}
+)
+
+func scale(full, quickN int) int {
+	if *quick {
+		return quickN
+	}
+	return full
+}
+
+func newResult(name, unit string, higher bool) *result {
+	better := "lower"
+	if higher {
+		better = "higher"
+	}
+	return &result{Name: name, Unit: unit, Better: better, Samples: []float64{},
+		Params: map[string]float64{}, Extra: map[string]float64{}}
+}
+
+func (r *result) finish() result {
+	s := append([]float64(nil), r.Samples...)
+	sort.Float64s(s)
+	if n := len(s); n > 0 {
+		r.Min, r.Max = s[0], s[n-1]
+		if n%2 == 1 {
+			r.Median = s[n/2]
+		} else {
+			r.Median = (s[n/2-1] + s[n/2]) / 2
+		}
+	}
+	return *r
+}
+
+// ==========================================
+// 1. Scheduler
+// ==========================================
+
+func benchSpawn() result {
+	n := scale(1_000_000, 200_000)
+	r := newResult("spawn", "tasks/s", true)
+	r.Params["tasks"] = float64(n)
+	for i := 0; i < *repeat; i++ {
+		var wg sync.WaitGroup
+		wg.Add(n)
+		t0 := time.Now()
+		go func() {
+			for k := 0; k < n; k++ {
+				go wg.Done()
+			}
+		}()
+		wg.Wait()
+		r.Samples = append(r.Samples, float64(n)/time.Since(t0).Seconds())
+	}
+	return r.finish()
+}
+
+func benchYield() result {
+	n := scale(2_000_000, 500_000)
+	r := newResult("yield", "ns/op", false)
+	r.Params["yields"] = float64(n)
+	for i := 0; i < *repeat; i++ {
+		done := make(chan struct{})
+		t0 := time.Now()
+		go func() {
+			for k := 0; k < n; k++ {
+				runtime.Gosched()
+			}
+			close(done)
+		}()
+		<-done
+		r.Samples = append(r.Samples, float64(time.Since(t0).Nanoseconds())/float64(n))
+	}
+	return r.finish()
+}
+
+func benchPingPong() result {
+	n := scale(500_000, 100_000)
+	r := newResult("ping_pong", "ns/op", false)
+	r.Params["round_trips"] = float64(n)
+	for i := 0; i < *repeat; i++ {
+		a, b := make(chan int64), make(chan int64)
+		var wg sync.WaitGroup
+		wg.Add(2)
+		t0 := time.Now()
+		go func() {
+			defer wg.Done()
+			for k := 0; k < n; k++ {
+				b <- <-a
+			}
+		}()
+		go func() {
+			defer wg.Done()
+			for k := 0; k < n; k++ {
+				a <- int64(k)
+				<-b
+			}
+		}()
+		wg.Wait()
+		r.Samples = append(r.Samples, float64(time.Since(t0).Nanoseconds())/float64(n))
+	}
+	return r.finish()
+}
+
+var sink uint32
+
+// A couple of hundred nanoseconds of pretend work
+func burn(iters int) {
+	x := uint32(0)
+	for i := 0; i < iters; i++ {
+		x = x*31 + uint32(i)
+	}
+	atomic.StoreUint32(&sink, x)
+}
+
+func benchFanOut() result {
+	const fanout, work = 64, 200
+	leaves := scale(2000, 500)
+	total := fanout*leaves + fanout
+	r := newResult("fan_out", "tasks/s", true)
+	r.Params["fanout"], r.Params["leaves"], r.Params["work"] = fanout, float64(leaves), work
+	for i := 0; i < *repeat; i++ {
+		var wg sync.WaitGroup
+		wg.Add(total)
+		t0 := time.Now()
+		go func() {
+			for m := 0; m < fanout; m++ {
+				go func() {
+					for l := 0; l < leaves; l++ {
+						go func() {
+							burn(work)
+							wg.Done()
+						}()
+					}
+					wg.Done()
+				}()
+			}
+		}()
+		wg.Wait()
+		r.Samples = append(r.Samples, float64(total)/time.Since(t0).Seconds())
+	}
+	return r.finish()
+}
+
+// ==========================================
+// 2. Sync Primitives and Timers
+// ==========================================
+
+func benchChannel() result {
+	const producers, consumers, capacity = 4, 4, 1024
+	n := scale(250_000, 50_000)
+	r := newResult("channel_mpmc", "msgs/s", true)
+	r.Params["producers"], r.Params["consumers"], r.Params["capacity"] = producers, consumers, capacity
+	r.Params["msgs_per_producer"] = float64(n)
+	for i := 0; i < *repeat; i++ {
+		ch := make(chan int64, capacity)
+		var prod, cons sync.WaitGroup
+		var sum atomic.Int64
+		prod.Add(producers)
+		cons.Add(consumers)
+		t0 := time.Now()
+		for c := 0; c < consumers; c++ {
+			go func() {
+				defer cons.Done()
+				local := int64(0)
+				for v := range ch {
+					local += v
+				}
+				sum.Add(local)
+			}()
+		}
+		for p := 0; p < producers; p++ {
+			go func() {
+				defer prod.Done()
+				for k := 0; k < n; k++ {
+					ch <- int64(k)
+				}
+			}()
+		}
+		prod.Wait()
+		close(ch)
+		cons.Wait()
+		r.Samples = append(r.Samples, float64(producers*n)/time.Since(t0).Seconds())
+		if sum.Load() != int64(producers)*(int64(n)*int64(n-1)/2) {
+			fmt.Fprintln(os.Stderr, "channel_mpmc: checksum mismatch")
+		}
+	}
+	return r.finish()
+}
+
+func benchMutex() result {
+	const coroutines = 64
+	n := scale(20_000, 5_000)
+	r := newResult("mutex", "ops/s", true)
+	r.Params["coroutines"], r.Params["ops_per_coroutine"] = coroutines, float64(n)
+	for i := 0; i < *repeat; i++ {
+		var mu sync.Mutex
+		counter := 0
+		var wg sync.WaitGroup
+		wg.Add(coroutines)
+		t0 := time.Now()
+		for c := 0; c < coroutines; c++ {
+			go func() {
+				defer wg.Done()
+				for k := 0; k < n; k++ {
+					mu.Lock()
+					counter++
+					mu.Unlock()
+				}
+			}()
+		}
+		wg.Wait()
+		r.Samples = append(r.Samples, float64(coroutines*n)/time.Since(t0).Seconds())
+		if counter != coroutines*n {
+			fmt.Fprintln(os.Stderr, "mutex: lost updates")
+		}
+	}
+	return r.finish()
+}
+
+// Exact percentiles here; bench_suite reports the top of a Histogram bucket (at most 12.5% high)
+func benchTimer() result {
+	n := scale(100_000, 20_000)
+	r := newResult("timer", "timers/s", true)
+	r.Params["timers"], r.Params["min_ms"], r.Params["max_ms"] = float64(n), 1, 10
+	late := make([]int64, 0, n*(*repeat))
+	lateNs := make([]int64, n)
+	for i := 0; i < *repeat; i++ {
+		var wg sync.WaitGroup
+		wg.Add(n)
+		t0 := time.Now()
+		for k := 0; k < n; k++ {
+			go func(k int) {
+				d := time.Duration(1+k%10) * time.Millisecond
+				deadline := time.Now().Add(d)
+				time.Sleep(d)
+				if l := time.Since(deadline); l > 0 {
+					lateNs[k] = int64(l)
+				} else {
+					lateNs[k] = 0
+				}
+				wg.Done()
+			}(k)
+		}
+		wg.Wait()
+		r.Samples = append(r.Samples, float64(n)/time.Since(t0).Seconds())
+		late = append(late, lateNs...)
+	}
+	sort.Slice(late, func(a, b int) bool { return late[a] < late[b] })
+	pct := func(q float64) float64 { return float64(late[int(q*float64(len(late)-1))]) / 1e3 }
+	r.Extra["late_p50_us"], r.Extra["late_p99_us"], r.Extra["late_max_us"] = pct(0.5), pct(0.99), pct(1)
+	r.Extra["timers_fired"] = float64(len(late))
+	return r.finish()
+}
+
+// ==========================================
+// 3. Loopback Servers (driven by bench_suite)
+// ==========================================
+
+var rawResponse = []byte(
+	"HTTP/1.1 200 OK\r\n" +
+		"Content-Type: text/plain\r\n" +
+		"Content-Length: 13\r\n" +
+		"Connection: keep-alive\r\n" +
+		"\r\n" +
+		"Hello, World!")
+
+// One reply per request (a header block ending in a blank line; the load has no bodies), flushed
+// once the pipelined requests of a read are answered, like HttpConnection's batched writev
+func handleHTTP(conn net.Conn) {
+	defer conn.Close()
+	r := bufio.NewReaderSize(conn, 8192)
+	w := bufio.NewWriterSize(conn, 8192)
+	for {
+		for {
+			line, err := r.ReadSlice('\n')
+			if err != nil {
+				return
+			}
+			if len(line) <= 2 {
+				break
+			}
+		}
+		w.Write(rawResponse)
+		if r.Buffered() == 0 && w.Flush() != nil {
+			return
+		}
+	}
+}
+
+// Sharded like ShardedKvStore: one lock per shard
+type shard struct {
+	sync.RWMutex
+	m map[string][]byte
+}
+
+type store struct{ shards []shard }
+
+func newStore(n int) *store {
+	s := &store{shards: make([]shard, n)}
+	for i := range s.shards {
+		s.shards[i].m = map[string][]byte{}
+	}
+	return s
+}
+
+func (s *store) shard(key []byte) *shard {
+	h := fnv.New32a()
+	h.Write(key)
+	return &s.shards[h.Sum32()%uint32(len(s.shards))]
+}
+
+var errProtocol = errors.New("protocol error")
+
+// RESP arrays of bulk strings (what redis clients send); args are fresh slices
+func readCommand(r *bufio.Reader, args [][]byte) ([][]byte, error) {
+	line, err := r.ReadSlice('\n')
+	if err != nil {
+		return nil, err
+	}
+	if len(line) < 4 || line[0] != '*' {
+		return nil, errProtocol
+	}
+	n, err := strconv.Atoi(string(line[1 : len(line)-2]))
+	if err != nil {
+		return nil, errProtocol
+	}
+	args = args[:0]
+	for i := 0; i < n; i++ {
+		line, err = r.ReadSlice('\n')
+		if err != nil {
+			return nil, err
+		}
+		if len(line) < 4 || line[0] != '$' {
+			return nil, errProtocol
+		}
+		size, err := strconv.Atoi(string(line[1 : len(line)-2]))
+		if err != nil || size < 0 {
+			return nil, errProtocol
+		}
+		buf := make([]byte, size+2)
+		if _, err := io.ReadFull(r, buf); err != nil {
+			return nil, err
+		}
+		args = append(args, buf[:size])
+	}
+	return args, nil
+}
+
+func handleRESP(conn net.Conn, db *store) {
+	defer conn.Close()
+	r := bufio.NewReaderSize(conn, 16*1024)
+	w := bufio.NewWriterSize(conn, 16*1024)
+	var args [][]byte
+	for {
+		var err error
+		if args, err = readCommand(r, args); err != nil {
+			return
+		}
+		switch {
+		case len(args) == 2 && string(args[0]) == "GET":
+			s := db.shard(args[1])
+			s.RLock()
+			v, ok := s.m[string(args[1])]
+			if ok {
+				w.WriteString("$" + strconv.Itoa(len(v)) + "\r\n")
+				w.Write(v)
+				w.WriteString("\r\n")
+			} else {
+				w.WriteString("$-1\r\n")
+			}
+			s.RUnlock()
+		case len(args) == 3 && string(args[0]) == "SET":
+			s := db.shard(args[1])
+			s.Lock()
+			s.m[string(args[1])] = args[2]
+			s.Unlock()
+			w.WriteString("+OK\r\n")
+		case len(args) > 0 && string(args[0]) == "PING":
+			w.WriteString("+PONG\r\n")
+		default:
+			w.WriteString("-ERR unknown command\r\n")
+		}
+		if r.Buffered() == 0 && w.Flush() != nil {
+			return
+		}
+	}
+}
+
+func listen(addr string, handle func(net.Conn)) {
+	ln, err := net.Listen("tcp", addr)
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "listen %s: %v\n", addr, err)
+		os.Exit(1)
+	}
+	go func() {
+		for {
+			conn, err := ln.Accept()
+			if err != nil {
+				continue
+			}
+			go handle(conn)
+		}
+	}()
+}
+
+// ==========================================
+// 4. Main
+// ==========================================
+
+func main() {
+	flag.Var(meta, "meta", "key=value stored in the JSON (repeatable)")
+	flag.Parse()
+	runtime.GOMAXPROCS(*workers)
+
+	if *serveHTTP != "" || *serveRESP != "" {
+		if *serveHTTP != "" {
+			listen(*serveHTTP, handleHTTP)
+		}
+		if *serveRESP != "" {
+			db := newStore(*workers * 16)
+			listen(*serveRESP, func(c net.Conn) { handleRESP(c, db) })
+		}
+		select {}
+	}
+
+	repeatSet := false
+	flag.Visit(func(f *flag.Flag) { repeatSet = repeatSet || f.Name == "repeat" })
+	if *quick && !repeatSet {
+		*repeat = 3
+	}
+	if *repeat < 1 {
+		*repeat = 1
+	}
+	wanted := map[string]bool{}
+	for _, name := range strings.Split(*only, ",") {
+		if name != "" {
+			wanted[name] = true
+		}
+	}
+
+	table := os.Stdout
+	if *jsonPath == "-" {
+		table = os.Stderr
+	}
+	cases := []struct {
+		name string
+		run  func() result
+	}{
+		{"spawn", benchSpawn}, {"yield", benchYield}, {"ping_pong", benchPingPong},
+		{"fan_out", benchFanOut}, {"channel_mpmc", benchChannel}, {"mutex", benchMutex},
+		{"timer", benchTimer},
+	}
+	quickNote := ""
+	if *quick {
+		quickNote = " quick"
+	}
+	fmt.Fprintf(table, "workers=%d repeat=%d%s (median, min, max)\n", *workers, *repeat, quickNote)
+	fmt.Fprintf(table, "%-14s %10s %14s %14s %14s\n", "case", "unit", "median", "min", "max")
+	var results []result
+	for _, c := range cases {
+		if len(wanted) > 0 && !wanted[c.name] {
+			continue
+		}
+		r := c.run()
+		fmt.Fprintf(table, "%-14s %10s %14.1f %14.1f %14.1f\n", r.Name, r.Unit, r.Median, r.Min, r.Max)
+		results = append(results, r)
+	}
+
+	if *jsonPath == "" {
+		return
+	}
+	host, _ := os.Hostname()
+	doc, err := json.Marshal(report{
+		Schema: 1, Suite: "go", Label: *label, Timestamp: time.Now().UTC().Format(time.RFC3339),
+		Host: host, CPUs: runtime.NumCPU(), Workers: *workers, Repeat: *repeat,
+		Compiler: runtime.Version(), Optimized: true, Sanitizer: "none", Meta: meta, Cases: results,
+	})
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	doc = append(doc, '\n')
+	if *jsonPath == "-" {
+		os.Stdout.Write(doc)
+	} else if err := os.WriteFile(*jsonPath, doc, 0o644); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
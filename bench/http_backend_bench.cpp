@@ -0,0 +1,102 @@
+// Reactor backend head-to-head: the simple_http_web keep-alive workload on epoll vs io_uring,
+// and single Reactor vs one Poller per Worker (SchedulerOptions::poller_per_worker).
+// Usage: http_backend_bench [workers] [connections] [seconds]
+// Build with -DTINYCORO_IO_URING (CMake: ENABLE_IO_URING=ON) for the io_uring row.
+#include "scheduler.h"
+#include "socket.h"
+#include "loopback.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static constexpr std::string_view RAW_RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 13\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "Hello, World!";
+
+static constexpr std::string_view RAW_REQUEST =
+    "GET / HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "\r\n";
+
+// Same handler as src/simple_http_web.cpp
+Task handle_client(AsyncSocket socket) {
+    char buf[1024];
+    while (true) {
+        ssize_t n = co_await socket.read(buf, sizeof(buf));
+        if (n <= 0) break;
+        ssize_t ret = co_await socket.write(RAW_RESPONSE.data(), RAW_RESPONSE.size());
+        if (ret <= 0) break;
+    }
+}
+
+// Blocking keep-alive client: one request in flight per connection
+static void client(int port, std::atomic<bool>& stop, std::atomic<size_t>& requests) {
+    int fd = connect_to(port);
+    if (fd < 0) return;
+    char buf[1024];
+    size_t local = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (::write(fd, RAW_REQUEST.data(), RAW_REQUEST.size()) <= 0) break;
+        size_t got = 0;
+        while (got < RAW_RESPONSE.size()) {
+            ssize_t n = ::read(fd, buf, sizeof(buf));
+            if (n <= 0) goto done;
+            got += static_cast<size_t>(n);
+        }
+        ++local;
+    }
+done:
+    requests.fetch_add(local, std::memory_order_relaxed);
+    ::close(fd);
+}
+
+static double run(IoBackend backend, bool per_worker, size_t workers, int connections, int seconds, int port) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> requests{0};
+    double rps = 0;
+    {
+        Scheduler sched(SchedulerOptions{.workers = workers, .io_backend = backend, .poller_per_worker = per_worker});
+        LoopbackServer server(sched, port);
+        if (!server.bound()) {
+            std::perror("bind");
+            return 0;
+        }
+        server.start(handle_client);
+
+        std::vector<std::thread> clients;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < connections; ++i) clients.emplace_back(client, port, std::ref(stop), std::ref(requests));
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        stop.store(true);
+        for (auto& t : clients) t.join();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rps = requests.load() / elapsed;
+        server.shutdown();
+    }
+    return rps;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int connections = argc > 2 ? std::atoi(argv[2]) : 64;
+    int seconds = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    std::printf("workers=%zu connections=%d duration=%ds\n", workers, connections, seconds);
+    std::printf("%-20s %14s\n", "backend", "req/s");
+    std::printf("%-20s %14.0f\n", "epoll", run(IoBackend::Epoll, false, workers, connections, seconds, 18080));
+#ifdef TINYCORO_IO_URING
+    std::printf("%-20s %14.0f\n", "io_uring", run(IoBackend::IoUring, false, workers, connections, seconds, 18081));
+#else
+    std::printf("%-20s %14s\n", "io_uring", "(built without TINYCORO_IO_URING)");
+#endif
+    std::printf("%-20s %14.0f\n", "epoll per-worker", run(IoBackend::Epoll, true, workers, connections, seconds, 18082));
+    return 0;
+}
@@ -0,0 +1,134 @@
+// HTTP/1.1 pipelining through HttpConnection: blocking clients keep `depth` requests in flight per
+// connection (wrk --pipeline style) against a routed "/" handler. "batched" answers every request
+// parsed from one read with a single writev(); "per-reply" (flush_bytes = 0) writes each reply on
+// its own. The canned row is the old simple_http_web / src/main.go loop, one fixed reply per read(),
+// which only gives right answers at depth 1.
+// Usage: http_pipeline_bench [workers] [connections] [depth] [seconds]
+#include "scheduler.h"
+#include "socket.h"
+#include "http/http_connection.h"
+#include "loopback.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr std::string_view RAW_RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 13\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "Hello, World!";
+
+static constexpr std::string_view RAW_REQUEST =
+    "GET / HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "\r\n";
+
+Task canned_client(AsyncSocket socket) {
+    char buf[1024];
+    while (true) {
+        ssize_t n = co_await socket.read(buf, sizeof(buf));
+        if (n <= 0) break;
+        if (co_await socket.write_all(RAW_RESPONSE.data(), RAW_RESPONSE.size()) <= 0) break;
+    }
+}
+
+// Replies are all the same length: read until `depth` of them are in
+static void client(int port, int depth, size_t reply_len, std::atomic<bool>& stop, std::atomic<size_t>& requests) {
+    int fd = connect_to(port);
+    if (fd < 0) return;
+    std::string batch;
+    for (int i = 0; i < depth; ++i) batch += RAW_REQUEST;
+    std::vector<char> buf(64 * 1024);
+    size_t local = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (::write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size())) break;
+        size_t want = reply_len * depth, got = 0;
+        while (got < want) {
+            ssize_t n = ::read(fd, buf.data(), buf.size());
+            if (n <= 0) goto done;
+            got += static_cast<size_t>(n);
+        }
+        local += depth;
+    }
+done:
+    requests.fetch_add(local, std::memory_order_relaxed);
+    ::close(fd);
+}
+
+// One request, to learn the reply length
+static size_t probe(int port) {
+    int fd = connect_to(port);
+    if (fd < 0) return 0;
+    (void)!::write(fd, RAW_REQUEST.data(), RAW_REQUEST.size());
+    std::string got;
+    char buf[1024];
+    while (got.find("Hello, World!") == std::string::npos) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        got.append(buf, n);
+    }
+    ::close(fd);
+    return got.size();
+}
+
+template <typename F>
+static double run(F on_accept, size_t workers, int connections, int depth, int seconds, int port) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> requests{0};
+    double rps = 0;
+    {
+        Scheduler sched(workers);
+        LoopbackServer server(sched, port);
+        if (!server.bound()) {
+            std::perror("bind");
+            return 0;
+        }
+        server.start(on_accept);
+        size_t reply_len = probe(port);
+
+        std::vector<std::thread> clients;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < connections; ++i) {
+            clients.emplace_back(client, port, depth, reply_len, std::ref(stop), std::ref(requests));
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        stop.store(true);
+        for (auto& t : clients) t.join();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rps = requests.load() / elapsed;
+        server.shutdown();
+    }
+    return rps;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int connections = argc > 2 ? std::atoi(argv[2]) : 32;
+    int depth = argc > 3 ? std::atoi(argv[3]) : 16;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 3;
+
+    HttpRouter router;
+    router.get("/", [](const HttpRequest&, HttpResponse& res) { res.body_ref = "Hello, World!"; });
+    HttpConnectionOptions per_reply;
+    per_reply.flush_bytes = 0;
+
+    auto batched = [&](AsyncSocket s) { return HttpConnection::serve(std::move(s), router); };
+    auto unbatched = [&](AsyncSocket s) { return HttpConnection::serve(std::move(s), router, per_reply); };
+
+    std::printf("workers=%zu connections=%d duration=%ds\n", workers, connections, seconds);
+    std::printf("%-28s %14s\n", "server", "req/s");
+    std::printf("%-28s %14.0f\n", "canned, depth 1", run(canned_client, workers, connections, 1, seconds, 18090));
+    std::printf("%-28s %14.0f\n", "HttpConnection, depth 1", run(batched, workers, connections, 1, seconds, 18091));
+    char name[64];
+    std::snprintf(name, sizeof(name), "per-reply, depth %d", depth);
+    std::printf("%-28s %14.0f\n", name, run(unbatched, workers, connections, depth, seconds, 18092));
+    std::snprintf(name, sizeof(name), "batched, depth %d", depth);
+    std::printf("%-28s %14.0f\n", name, run(batched, workers, connections, depth, seconds, 18093));
+    return 0;
+}
@@ -0,0 +1,17 @@
+// Completion latch shared by the benches: wait() returns once arrive() has been called n times.
+#pragma once
+#include <atomic>
+
+struct Join {
+    std::atomic<long> remaining;
+
+    explicit Join(long n) : remaining(n) {}
+    void arrive() {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) remaining.notify_all();
+    }
+    void wait() {
+        for (long v = remaining.load(std::memory_order_acquire); v != 0; v = remaining.load(std::memory_order_acquire)) {
+            remaining.wait(v);
+        }
+    }
+};
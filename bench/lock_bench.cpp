@@ -0,0 +1,137 @@
+// Lock throughput: coroutines hammering one short critical section, the previous std::mutex-guarded
+// AsyncMutex vs the CAS-based one; then a read-mostly mix through AsyncMutex vs AsyncRwLock.
+// Usage: lock_bench [workers] [coroutines] [ops_per_coroutine] [write_percent]
+#include "async_mutex.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+
+// The previous AsyncMutex implementation, kept here as the baseline
+class OldAsyncMutex {
+public:
+    explicit OldAsyncMutex(Scheduler& sched) : sched_(sched), locked_(false) {}
+    struct ScopedLock {
+        OldAsyncMutex& m;
+        bool owns = true;
+        ScopedLock(OldAsyncMutex& mm) : m(mm) {}
+        ScopedLock(ScopedLock&& o) noexcept : m(o.m), owns(o.owns) { o.owns = false; }
+        ~ScopedLock() { if (owns) m.unlock(); }
+    };
+    struct LockAwaiter {
+        OldAsyncMutex& mutex;
+        bool await_ready() {
+            std::lock_guard<std::mutex> lock(mutex.wait_mtx_);
+            if (!mutex.locked_) {
+                mutex.locked_ = true;
+                return true;
+            }
+            return false;
+        }
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            std::lock_guard<std::mutex> lock(mutex.wait_mtx_);
+            if (!mutex.locked_) {
+                mutex.locked_ = true;
+                return false;
+            }
+            Task::retain(h);
+            mutex.waiters_.push(h);
+            return true;
+        }
+        ScopedLock await_resume() { return ScopedLock{mutex}; }
+    };
+    LockAwaiter lock() { return LockAwaiter{*this}; }
+    void unlock() {
+        std::lock_guard<std::mutex> lock(wait_mtx_);
+        if (waiters_.empty()) {
+            locked_ = false;
+        } else {
+            auto h = waiters_.front();
+            waiters_.pop();
+            sched_.spawn(Task::from_address(h.address()));
+        }
+    }
+private:
+    Scheduler& sched_;
+    bool locked_;
+    std::mutex wait_mtx_;
+    std::queue<std::coroutine_handle<>> waiters_;
+};
+
+// A small table: writers bump one slot, readers sum all of them
+struct Table {
+    long slots[16] = {};
+    long read() const {
+        long sum = 0;
+        for (long v : slots) sum += v;
+        return sum;
+    }
+};
+
+template <typename Mutex>
+Task exclusive_worker(Mutex& m, Table& t, Join& join, long ops, int write_pct, std::atomic<long>& sink) {
+    long local = 0;
+    for (long i = 0; i < ops; ++i) {
+        auto guard = co_await m.lock();
+        if (i % 100 < write_pct) ++t.slots[i % 16];
+        else local += t.read();
+    }
+    sink.fetch_add(local);
+    join.arrive();
+}
+
+Task rw_worker(AsyncRwLock& rw, Table& t, Join& join, long ops, int write_pct, std::atomic<long>& sink) {
+    long local = 0;
+    for (long i = 0; i < ops; ++i) {
+        if (i % 100 < write_pct) {
+            auto guard = co_await rw.lock();
+            ++t.slots[i % 16];
+        } else {
+            auto guard = co_await rw.lock_shared();
+            local += t.read();
+        }
+    }
+    sink.fetch_add(local);
+    join.arrive();
+}
+
+template <typename Spawn>
+double run(Scheduler& s, int coros, long ops, Spawn&& spawn) {
+    Join join(coros);
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < coros; ++c) s.spawn(spawn(join));
+    join.wait();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return coros * ops / sec / 1e6;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int coros = argc > 2 ? std::atoi(argv[2]) : 64;
+    long ops = argc > 3 ? std::atol(argv[3]) : 100000;
+    int write_pct = argc > 4 ? std::atoi(argv[4]) : 5;
+    const int rounds = 3;
+
+    Scheduler s(workers);
+    std::atomic<long> sink{0};
+    std::printf("workers=%zu coroutines=%d ops/coroutine=%ld writes=%d%% (best of %d)\n",
+                workers, coros, ops, write_pct, rounds);
+    std::printf("%-26s %10s\n", "lock", "Mops/s");
+    double best[4] = {0, 0, 0, 0};
+    for (int r = 0; r < rounds; ++r) {
+        Table t;
+        OldAsyncMutex old_mutex(s);
+        AsyncMutex mutex(s);
+        AsyncRwLock rw(s);
+        best[0] = std::max(best[0], run(s, coros, ops, [&](Join& j) { return exclusive_worker(old_mutex, t, j, ops, 100, sink); }));
+        best[1] = std::max(best[1], run(s, coros, ops, [&](Join& j) { return exclusive_worker(mutex, t, j, ops, 100, sink); }));
+        best[2] = std::max(best[2], run(s, coros, ops, [&](Join& j) { return exclusive_worker(mutex, t, j, ops, write_pct, sink); }));
+        best[3] = std::max(best[3], run(s, coros, ops, [&](Join& j) { return rw_worker(rw, t, j, ops, write_pct, sink); }));
+    }
+    std::printf("%-26s %10.2f\n", "std::mutex AsyncMutex", best[0]);
+    std::printf("%-26s %10.2f\n", "AsyncMutex", best[1]);
+    std::printf("%-26s %10.2f\n", "read-mostly, AsyncMutex", best[2]);
+    std::printf("%-26s %10.2f\n", "read-mostly, AsyncRwLock", best[3]);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Loopback plumbing shared by the network benches: a blocking client connect, and an in-process
+// server on 127.0.0.1 that can be shut down cleanly. shutdown() returns once the accept loop and
+// every connection handler have returned, so the listener and Scheduler can go away right after.
+#pragma once
+#include "scheduler.h"
+#include "socket.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+
+inline int connect_to(const std::string& ip, int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline int connect_to(int port) { return connect_to("127.0.0.1", port); }
+
+// Spawns on_accept(AsyncSocket) -> Task for every accepted connection, and counts the handlers
+// still running. Clients must have closed their connections before shutdown(), or it waits for
+// them to.
+class LoopbackServer {
+public:
+    LoopbackServer(Scheduler& sched, int port) : sched_(sched), listener_(sched.reactor()), port_(port) {
+        bound_ = listener_.bind("127.0.0.1", port) >= 0;
+    }
+    ~LoopbackServer() { shutdown(); }
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    bool bound() const { return bound_; }
+
+    template <typename F>
+    void start(F on_accept) {
+        started_ = true;
+        sched_.spawn(accept_loop(std::move(on_accept)));
+    }
+
+    void shutdown() {
+        if (!started_) return;
+        started_ = false;
+        stop_.store(true);
+        // One more connection wakes the accept loop so it sees stop_ before the listener goes away.
+        // It is accepted like any other, so it is closed only once nothing else can be.
+        int poke = connect_to(port_);
+        while (!accept_done_.load(std::memory_order_acquire)) accept_done_.wait(false);
+        if (poke >= 0) ::close(poke);
+        for (size_t n = live_.load(); n != 0; n = live_.load()) live_.wait(n);
+    }
+
+private:
+    template <typename F>
+    Task accept_loop(F on_accept) {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            AsyncSocket client = co_await listener_.accept();
+            if (client.fd() < 0) continue;
+            int one = 1; // Otherwise Nagle holds back every per-reply write after the first until an ACK
+            setsockopt(client.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            live_.fetch_add(1);
+            sched_.spawn(track(on_accept(std::move(client))));
+        }
+        accept_done_.store(true, std::memory_order_release);
+        accept_done_.notify_all();
+    }
+
+    Task track(Task handler) {
+        co_await handler;
+        if (live_.fetch_sub(1) == 1) live_.notify_all();
+    }
+
+    Scheduler& sched_;
+    TcpListener listener_;
+    int port_;
+    bool bound_ = false;
+    bool started_ = false;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> accept_done_{false};
+    std::atomic<size_t> live_{0}; // Handlers spawned and not yet returned
+};
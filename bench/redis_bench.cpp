@@ -0,0 +1,202 @@
+// mini_redis load harness.
+//   redis_bench store [threads] [keys] [ops_per_thread] [get_percent]
+//     In-process engine comparison: std::map behind one lock (the old RedisDB) vs ShardedKvStore.
+//   redis_bench net [port] [clients] [seconds] [get_percent] [keys] [value_size] [pipeline]
+//     redis-benchmark style: blocking clients against a running mini_redis, `pipeline` commands in
+//     flight per connection (like -P), reporting ops/s and p50 / p99 / max round-trip latency.
+#include "redis/kv_store.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// The previous storage, kept here as the baseline
+struct MapStore {
+    std::mutex mtx;
+    std::map<std::string, std::string> kv;
+    void set(std::string_view k, std::string_view v) {
+        std::lock_guard<std::mutex> lock(mtx);
+        kv[std::string(k)] = v;
+    }
+    template <typename F>
+    bool get(std::string_view k, F&& f) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = kv.find(std::string(k));
+        if (it == kv.end()) return false;
+        f(std::string_view(it->second));
+        return true;
+    }
+};
+
+static std::vector<std::string> make_keys(size_t n) {
+    std::vector<std::string> keys(n);
+    for (size_t i = 0; i < n; ++i) keys[i] = "session:" + std::to_string(i);
+    return keys;
+}
+
+template <typename Store>
+static double run_store(Store& store, int threads, const std::vector<std::string>& keys, long ops, int get_pct) {
+    std::string value(32, 'v');
+    for (auto& k : keys) store.set(k, value);
+    std::atomic<long> sink{0};
+    std::vector<std::thread> pool;
+    auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            long local = 0;
+            for (long i = 0; i < ops; ++i) {
+                const std::string& k = keys[rng() % keys.size()];
+                if (static_cast<int>(rng() % 100) < get_pct) store.get(k, [&](std::string_view v) { local += v.size(); });
+                else store.set(k, value);
+            }
+            sink.fetch_add(local);
+        });
+    }
+    for (auto& th : pool) th.join();
+    double sec = std::chrono::duration<double>(Clock::now() - start).count();
+    return threads * ops / sec / 1e6;
+}
+
+static int connect_to(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static std::string resp_command(std::initializer_list<std::string_view> args) {
+    std::string out = "*" + std::to_string(args.size()) + "\r\n";
+    for (auto a : args) out.append("$").append(std::to_string(a.size())).append("\r\n").append(a).append("\r\n");
+    return out;
+}
+
+// End of the reply starting at `from`: a status / integer / error line, or a bulk string
+static size_t reply_end(const std::string& buf, size_t from) {
+    size_t eol = buf.find("\r\n", from);
+    if (eol == std::string::npos) return std::string::npos;
+    if (buf[from] != '$') return eol + 2;
+    long len = std::atol(buf.c_str() + from + 1);
+    if (len < 0) return eol + 2;
+    size_t end = eol + 2 + len + 2;
+    return buf.size() >= end ? end : std::string::npos;
+}
+
+// Read until `count` complete replies are in
+static bool read_replies(int fd, std::string& buf, int count) {
+    buf.clear();
+    char tmp[16384];
+    size_t pos = 0;
+    while (count > 0) {
+        size_t end = pos < buf.size() ? reply_end(buf, pos) : std::string::npos;
+        if (end != std::string::npos) {
+            pos = end;
+            --count;
+            continue;
+        }
+        ssize_t n = ::read(fd, tmp, sizeof(tmp));
+        if (n <= 0) return false;
+        buf.append(tmp, n);
+    }
+    return true;
+}
+
+static void net_client(int port, int id, std::atomic<bool>& stop, const std::vector<std::string>& keys,
+                       int get_pct, size_t value_size, int pipeline, std::vector<uint32_t>& latencies_us) {
+    int fd = connect_to(port);
+    if (fd < 0) return;
+    std::mt19937 rng(id);
+    std::string value(value_size, 'v'), batch, reply;
+    while (!stop.load(std::memory_order_relaxed)) {
+        batch.clear();
+        for (int i = 0; i < pipeline; ++i) {
+            const std::string& k = keys[rng() % keys.size()];
+            batch += static_cast<int>(rng() % 100) < get_pct ? resp_command({"GET", k}) : resp_command({"SET", k, value});
+        }
+        auto t0 = Clock::now();
+        if (::write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size())) break;
+        if (!read_replies(fd, reply, pipeline)) break;
+        uint32_t us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count());
+        latencies_us.insert(latencies_us.end(), pipeline, us);
+    }
+    ::close(fd);
+}
+
+static int run_net(int argc, char** argv) {
+    int port = argc > 2 ? std::atoi(argv[2]) : 6379;
+    int clients = argc > 3 ? std::atoi(argv[3]) : 50;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 5;
+    int get_pct = argc > 5 ? std::atoi(argv[5]) : 90;
+    size_t nkeys = argc > 6 ? std::strtoul(argv[6], nullptr, 10) : 100000;
+    size_t value_size = argc > 7 ? std::strtoul(argv[7], nullptr, 10) : 32;
+    int pipeline = argc > 8 ? std::max(1, std::atoi(argv[8])) : 1;
+
+    auto keys = make_keys(nkeys);
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<uint32_t>> latencies(clients);
+    std::vector<std::thread> pool;
+    auto start = Clock::now();
+    for (int i = 0; i < clients; ++i) {
+        pool.emplace_back(net_client, port, i, std::ref(stop), std::cref(keys), get_pct, value_size, pipeline, std::ref(latencies[i]));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true);
+    for (auto& t : pool) t.join();
+    double sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    if (all.empty()) {
+        std::printf("no replies (is mini_redis listening on %d?)\n", port);
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+    std::printf("clients=%d duration=%ds gets=%d%% keys=%zu value=%zuB pipeline=%d\n", clients, seconds, get_pct, nkeys,
+                value_size, pipeline);
+    std::printf("%12s %10s %10s %10s\n", "ops/s", "p50(us)", "p99(us)", "max(us)");
+    std::printf("%12.0f %10u %10u %10u\n", all.size() / sec, pct(0.50), pct(0.99), all.back());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "store";
+    if (mode == "net") return run_net(argc, argv);
+
+    int threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    size_t nkeys = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100000;
+    long ops = argc > 4 ? std::atol(argv[4]) : 1000000;
+    int get_pct = argc > 5 ? std::atoi(argv[5]) : 90;
+    auto keys = make_keys(nkeys);
+
+    std::printf("threads=%d keys=%zu ops/thread=%ld gets=%d%%\n", threads, nkeys, ops, get_pct);
+    std::printf("%-26s %10s\n", "engine", "Mops/s");
+    MapStore map;
+    std::printf("%-26s %10.2f\n", "std::map + one mutex", run_store(map, threads, keys, ops, get_pct));
+    ShardedKvStore sharded(threads * 16);
+    std::printf("%-26s %10.2f\n", "ShardedKvStore", run_store(sharded, threads, keys, ops, get_pct));
+    return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Runs bench_suite from a Release build without sanitizers, then (with `go` on PATH) the Go baseline
+# in bench/go through the same harness: its in-process cases, then its HTTP / RESP servers loaded by
+# bench_suite's own load generator. Writes one JSON file per run, named <UTC time>-<commit>-<suite>.
+# Usage: bench/run_suite.sh [out_dir] [--quick] [--repeat n] [--workers n]
+# Extra arguments go to both suites, so only the options they share belong here.
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=${BUILD_DIR:-$ROOT/_bench_build}
+OUT=$ROOT/bench/results
+case "${1:-}" in
+    ""|-*) ;;
+    *) OUT=$1; shift ;;
+esac
+COMMIT=$(git -C "$ROOT" rev-parse --short HEAD 2>/dev/null || echo unknown)
+if [ -n "$(git -C "$ROOT" status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+    COMMIT=$COMMIT-dirty
+fi
+RUN=$OUT/$(date -u +%Y%m%dT%H%M%SZ)-$COMMIT
+
+cmake -S "$ROOT" -B "$BUILD" -DCMAKE_BUILD_TYPE=Release -DENABLE_ASAN=OFF -DENABLE_TSAN=OFF -DENABLE_TRACE=OFF >/dev/null
+cmake --build "$BUILD" --target bench_suite -j
+mkdir -p "$OUT"
+
+"$BUILD/bench_suite" --json "$RUN-tinycoro.json" --meta commit="$COMMIT" "$@"
+
+if ! command -v go >/dev/null 2>&1; then
+    echo "go not found: skipping the Go baseline" >&2
+    exit 0
+fi
+(cd "$ROOT/bench/go" && go build -o "$BUILD/go_suite" .)
+"$BUILD/go_suite" --json "$RUN-go.json" --meta commit="$COMMIT" "$@"
+
+"$BUILD/go_suite" --serve-http 127.0.0.1:18280 --serve-resp 127.0.0.1:18281 "$@" &
+SERVER=$!
+trap 'kill $SERVER 2>/dev/null' EXIT
+sleep 1
+"$BUILD/bench_suite" --only http,resp --http-target 127.0.0.1:18280 --resp-target 127.0.0.1:18281 \
+    --label go --json "$RUN-go-net.json" --meta commit="$COMMIT" "$@"
@@ -0,0 +1,86 @@
+// Work-stealing benchmark: fan-out/fan-in workloads under different steal strategies.
+// Usage: steal_bench [workers] [rounds]
+#include "scheduler.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// A few hundred nanoseconds of pretend work
+static void burn(int iters) {
+    volatile unsigned x = 0;
+    for (int i = 0; i < iters; ++i) x = x * 31 + i;
+}
+
+Task leaf(Join& join, int work) {
+    burn(work);
+    join.arrive();
+    co_return;
+}
+
+// Fan-out tree: one root spawns `fanout` mids, each mid spawns `leaves` leaves
+Task mid(Scheduler& s, Join& join, int leaves, int work) {
+    for (int i = 0; i < leaves; ++i) s.spawn(leaf(join, work));
+    join.arrive();
+    co_return;
+}
+
+Task root(Scheduler& s, Join& join, int fanout, int leaves, int work) {
+    for (int i = 0; i < fanout; ++i) s.spawn(mid(s, join, leaves, work));
+    co_return;
+}
+
+// Burst: a single producer floods its own queue, like an accept loop during a connection storm
+Task burst(Scheduler& s, Join& join, int n, int work) {
+    for (int i = 0; i < n; ++i) s.spawn(leaf(join, work));
+    co_return;
+}
+
+template <typename Start>
+double run_ms(Scheduler& s, long expected, Start start) {
+    Join join(expected);
+    auto t0 = std::chrono::steady_clock::now();
+    s.spawn(start(join));
+    join.wait();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    struct Config { const char* name; size_t steal_batch; bool locality; };
+    const Config configs[] = {
+        {"single-steal", 1, false},
+        {"batch-steal", 32, false},
+        {"batch+locality", 32, true},
+    };
+
+    const int fanout = 64, leaves = 2000, work = 200, burst_n = 128000;
+    std::printf("workers=%zu rounds=%d (best of rounds, ms)\n", workers, rounds);
+    std::printf("%-16s %12s %12s\n", "config", "fan-out/in", "burst");
+    for (const Config& c : configs) {
+        Scheduler s(SchedulerOptions{.workers = workers, .steal_batch = c.steal_batch, .locality_aware_steal = c.locality});
+        double best_tree = 1e18, best_burst = 1e18;
+        for (int r = 0; r < rounds; ++r) {
+            best_tree = std::min(best_tree, run_ms(s, (long)fanout * leaves + fanout, [&](Join& j) {
+                return root(s, j, fanout, leaves, work);
+            }));
+            best_burst = std::min(best_burst, run_ms(s, burst_n, [&](Join& j) {
+                return burst(s, j, burst_n, work);
+            }));
+        }
+        SchedulerStats st = s.stats();
+        std::printf("%-16s %12.2f %12.2f   parks=%llu wakeups=%llu spurious=%llu spin hit/miss=%llu/%llu"
+                    " steal hit/miss=%llu/%llu wait p50/p99=%.1f/%.1fus\n",
+                    c.name, best_tree, best_burst, (unsigned long long)st.parks, (unsigned long long)st.wakeups,
+                    (unsigned long long)st.spurious_wakeups, (unsigned long long)st.spin_hits,
+                    (unsigned long long)st.spin_misses, (unsigned long long)st.steals,
+                    (unsigned long long)st.steal_failures, st.schedule_latency.percentile(0.5) / 1e3,
+                    st.schedule_latency.percentile(0.99) / 1e3);
+    }
+    // Bursts resize the producer's StealQueue; every retired array must come back
+    EbrStats ebr = EbrManager::get().stats();
+    std::printf("ebr: retired=%zu freed=%zu pending=%zu epoch=%zu\n", ebr.retired, ebr.freed, ebr.pending, ebr.advances);
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Context-switch cost: a task yielding to the scheduler, and two tasks handing control back and
+// forth through a one-slot event. Reports ns per switch (suspend + requeue + resume).
+// Usage: switch_bench [workers] [switches] [rounds]
+#include "scheduler.h"
+#include "latch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Requeue the current task: same path as any wake-up on a Worker (run_next_ slot)
+struct Yield {
+    Scheduler& sched;
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<Task::Promise> h) {
+        // Ref +1 (for the queue), adopted by spawn()
+        Task::retain(h);
+        sched.spawn(Task::from_address(h.address()));
+    }
+    void await_resume() {}
+};
+
+// One waiter, one signal: 0 = idle, 1 = signalled, otherwise the parked coroutine
+class Event {
+    Scheduler& sched_;
+    std::atomic<uintptr_t> state_{0};
+
+public:
+    explicit Event(Scheduler& s) : sched_(s) {}
+
+    void set() {
+        uintptr_t s = state_.load(std::memory_order_acquire);
+        while (true) {
+            if (s == 1) return;
+            uintptr_t next = s == 0 ? 1 : 0;
+            if (state_.compare_exchange_weak(s, next, std::memory_order_acq_rel)) break;
+        }
+        if (s > 1) sched_.spawn(Task::from_address(reinterpret_cast<void*>(s)));
+    }
+
+    struct Awaiter {
+        Event& ev;
+        bool await_ready() {
+            uintptr_t one = 1;
+            return ev.state_.compare_exchange_strong(one, 0, std::memory_order_acq_rel);
+        }
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            // Ref +1 (for the event), adopted by spawn() in set()
+            bool token = Task::retain(h);
+            uintptr_t expected = 0;
+            if (ev.state_.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(h.address()),
+                                                  std::memory_order_acq_rel)) {
+                return true;
+            }
+            Task::unretain(h, token); // Signalled meanwhile
+            ev.state_.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        void await_resume() {}
+    };
+    Awaiter wait() { return Awaiter{*this}; }
+};
+
+Task yielder(Scheduler& s, long n, Join& done) {
+    for (long i = 0; i < n; ++i) co_await Yield{s};
+    done.arrive();
+}
+
+Task ping(Event& mine, Event& theirs, long n, Join& done) {
+    for (long i = 0; i < n; ++i) {
+        theirs.set();
+        co_await mine.wait();
+    }
+    done.arrive();
+}
+
+Task pong(Event& mine, Event& theirs, long n, Join& done) {
+    for (long i = 0; i < n; ++i) {
+        co_await mine.wait();
+        theirs.set();
+    }
+    done.arrive();
+}
+
+template <typename Start>
+double best_ns(int rounds, long switches, Start start) {
+    double best = 1e18;
+    for (int r = 0; r < rounds; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        start();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best / switches;
+}
+
+int main(int argc, char** argv) {
+    size_t workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    long n = argc > 2 ? std::atol(argv[2]) : 2000000;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    Scheduler s(workers);
+    std::printf("workers=%zu switches=%ld rounds=%d (best, ns per switch)\n", workers, n, rounds);
+    std::printf("%-12s %10.1f\n", "yield", best_ns(rounds, n, [&] {
+        Join done(1);
+        s.spawn(yielder(s, n, done));
+        done.wait();
+    }));
+    std::printf("%-12s %10.1f\n", "ping-pong", best_ns(rounds, n, [&] {
+        Join done(2);
+        Event a(s), b(s);
+        s.spawn(pong(b, a, n / 2, done));
+        s.spawn(ping(a, b, n / 2, done));
+        done.wait();
+    }));
+    return 0;
+}
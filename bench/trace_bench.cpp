@@ -0,0 +1,94 @@
+// Cost of the tracing probes (include/trace.h). This file always builds them in, so it measures:
+// a probe while tracing is off (one relaxed load), a probe recording into the ring, a probe
+// dropping on a full ring, a yield loop (resume / suspend / global probes per switch) with the
+// tracer stopped and running, and the drainer's cost per JSONL line. A build without
+// TINYCORO_TRACE compiles every probe to nothing.
+// Usage: trace_bench [events] [yields] [output]
+#ifndef TINYCORO_TRACE
+#define TINYCORO_TRACE
+#endif
+#include "scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_since(Clock::time_point start, long n) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / n;
+}
+
+// Bursts the ring can hold, with pauses for the drainer; the median burst, so that a drain
+// preempting the loop (on a machine with few cores) does not count
+static double recording_ns(long events) {
+    long burst = long(TraceRing::kCapacity / 2);
+    std::vector<double> per_burst;
+    for (long done = 0; done < events; done += burst) {
+        auto start = Clock::now();
+        for (long i = 0; i < burst; ++i) {
+            TINYCORO_TRACE_EVENT(TraceEvent::kPop, reinterpret_cast<void*>(i), nullptr);
+        }
+        per_burst.push_back(ns_since(start, burst));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::sort(per_burst.begin(), per_burst.end());
+    return per_burst[per_burst.size() / 2];
+}
+
+static double probe_ns(long events) {
+    auto start = Clock::now();
+    for (long i = 0; i < events; ++i) {
+        TINYCORO_TRACE_EVENT(TraceEvent::kPop, reinterpret_cast<void*>(i), nullptr);
+    }
+    return ns_since(start, events);
+}
+
+// What the drainer spends per record: one full ring, formatted by stop() into /dev/null
+static double drain_ns() {
+    Tracer::start("/dev/null", std::chrono::hours(1));
+    long n = long(TraceRing::kCapacity);
+    probe_ns(n);
+    auto start = Clock::now();
+    Tracer::stop();
+    return ns_since(start, n);
+}
+
+Task yielder(long n, std::atomic<bool>& done) {
+    for (long i = 0; i < n; ++i) co_await yield_now();
+    done.store(true);
+    done.notify_all();
+}
+
+static double yield_ns(long n) {
+    Scheduler sched(1);
+    std::atomic<bool> done{false};
+    auto start = Clock::now();
+    sched.spawn(yielder(n, done));
+    done.wait(false);
+    return ns_since(start, n);
+}
+
+int main(int argc, char** argv) {
+    long events = argc > 1 ? std::atol(argv[1]) : 10'000'000;
+    long yields = argc > 2 ? std::atol(argv[2]) : 2'000'000;
+    const char* path = argc > 3 ? argv[3] : "/dev/null";
+
+    std::printf("%-34s %10s\n", "case", "ns/op");
+    std::printf("%-34s %10.2f\n", "probe, tracer stopped", probe_ns(events));
+    double yield_off = yield_ns(yields);
+
+    if (!Tracer::start(path, std::chrono::milliseconds(1))) {
+        std::perror(path);
+        return 1;
+    }
+    std::printf("%-34s %10.2f\n", "probe, recording", recording_ns(events));
+    std::printf("%-34s %10.2f\n", "probe, ring full (dropped)", probe_ns(events));
+    std::printf("%-34s %10.2f\n", "yield_now, tracer stopped", yield_off);
+    std::printf("%-34s %10.2f\n", "yield_now, tracing", yield_ns(yields));
+    Tracer::stop();
+    std::printf("%-34s %10.2f\n", "drainer, per record", drain_ns());
+    std::printf("dropped records: %llu\n", (unsigned long long)Tracer::dropped());
+    return 0;
+}
@@ -2,14 +2,47 @@
 #pragma once
 
 #include "scheduler.h"
-#include <queue>
-#include <mutex>
+#include "spinlock.h"
 #include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// FIFO of parked lock awaiters (guarded by the owning lock's SpinLock). The nodes live in the
+// awaiters, i.e. in the suspended coroutine frames, so parking allocates nothing.
+struct LockWaiter {
+    std::coroutine_handle<> handle;
+    bool write = false; // AsyncRwLock only
+    LockWaiter* next = nullptr;
+};
+
+struct LockWaitList {
+    LockWaiter* head = nullptr;
+    LockWaiter* tail = nullptr;
+
+    bool empty() const { return head == nullptr; }
+    LockWaiter* front() const { return head; }
+    void push_back(LockWaiter* w) {
+        w->next = nullptr;
+        (tail ? tail->next : head) = w;
+        tail = w;
+    }
+    LockWaiter* pop_front() {
+        LockWaiter* w = head;
+        head = w->next;
+        if (!head) tail = nullptr;
+        return w;
+    }
+};
 
+// Whole state in one word: bit 0 = locked, the rest counts parked waiters. Uncontended lock and
+// unlock are a single CAS each; the SpinLock is only taken to park or to pass the lock on.
 class AsyncMutex {
 public:
+    // cpu_relax() rounds a locker spins on a held lock (with nobody queued) before parking
+    static constexpr int kSpinLimit = 64;
+
     // Constructor: requires a Scheduler to wake up the waiter
-    explicit AsyncMutex(Scheduler& sched) : sched_(sched), locked_(false) {}
+    explicit AsyncMutex(Scheduler& sched) : sched_(sched) {}
 
     // Disable copy and assignment
     AsyncMutex(const AsyncMutex&) = delete;
@@ -41,33 +74,46 @@ public:
     // --- Lock operation Awaiter ---
     struct LockAwaiter {
         AsyncMutex& mutex;
+        LockWaiter node;
 
         // 1. Fast Path (Quick Path)
-        // Try to acquire the lock directly without suspension
+        // One CAS; while the lock is held and nobody is queued, spin a little: critical sections
+        // are usually shorter than a suspend / wake-up round trip
         bool await_ready() {
-            std::lock_guard<std::mutex> lock(mutex.wait_mtx_);
-            if (!mutex.locked_) {
-                mutex.locked_ = true;
-                return true; // Lock acquired successfully, no suspension
+            if (mutex.try_lock()) return true;
+            for (int i = 0; i < kSpinLimit; ++i) {
+                cpu_relax();
+                uintptr_t s = mutex.state_.load(std::memory_order_relaxed);
+                if (s != kLocked && s != 0) break; // Waiters queued: FIFO, join them
+                if (s == 0 && mutex.try_lock()) return true;
             }
             return false; // Lock is occupied, enter await_suspend
         }
 
         // 2. Slow Path (Slow Path)
         // Return bool instead of void to handle race conditions
-        bool await_suspend(std::coroutine_handle<> h) {
-            std::lock_guard<std::mutex> lock(mutex.wait_mtx_);
-
-            // ✅ Double-Check
-            // At the very moment before we prepare to suspend, the coroutine holding the lock may have called unlock().
-            // If the lock becomes free at this moment, we must seize it immediately and must not suspend!
-            if (!mutex.locked_) {
-                mutex.locked_ = true;
-                return false; // Return false to cancel suspension and resume execution immediately
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            std::lock_guard<SpinLock> lock(mutex.lock_);
+            uintptr_t s = mutex.state_.load(std::memory_order_relaxed);
+            while (true) {
+                // ✅ Double-Check
+                // The holder may have called unlock() since await_ready: take the lock instead of
+                // sleeping on an idle one
+                if (!(s & kLocked)) {
+                    if (mutex.state_.compare_exchange_weak(s, s | kLocked, std::memory_order_acquire)) {
+                        return false; // Return false to cancel suspension and resume execution immediately
+                    }
+                    continue;
+                }
+                // Still held: count ourselves in, so the holder's unlock CAS fails and it passes the
+                // lock on under lock_ (which we hold until we are queued)
+                if (mutex.state_.compare_exchange_weak(s, s + kWaiter, std::memory_order_relaxed)) break;
             }
-
-            // The lock is indeed still occupied, queue up and suspend
-            mutex.waiters_.push(h);
+            node.handle = h;
+            mutex.waiters_.push_back(&node);
+            // Ref +1 (for the wait queue), adopted again by spawn() in unlock()
+            Task::retain(h);
+            TINYCORO_TRACE_EVENT(TraceEvent::kMutexWait, h.address(), &mutex);
             return true; // Return true to confirm suspension
         }
 
@@ -80,32 +126,177 @@ public:
 
     // Acquire lock (coroutine version)
     LockAwaiter lock() {
-        return LockAwaiter{*this};
+        return LockAwaiter{*this, {}};
+    }
+
+    // Non-suspending attempt; fails if the lock is held or anyone is queued for it
+    bool try_lock() {
+        uintptr_t expected = 0;
+        return state_.compare_exchange_strong(expected, kLocked, std::memory_order_acquire);
     }
 
     // Release lock
     void unlock() {
-        std::lock_guard<std::mutex> lock(wait_mtx_);
-
-        if (waiters_.empty()) {
-            // No one is waiting, release the state directly
-            locked_ = false;
-        } else {
-            // ⚠️ Baton Passing (Relay Baton Mechanism)
-            // Someone is waiting, we **do not** set locked_ to false.
-            // Instead, keep locked_ = true and wake up the next waiter directly.
-            // When the next waiter wakes up (in await_resume), it naturally owns the lock.
-            auto h = waiters_.front();
-            waiters_.pop();
-
-            // Throw the awakened task back to the scheduler
-            sched_.spawn(Task::from_address(h.address()));
+        // No one is waiting, release the state directly
+        uintptr_t expected = kLocked;
+        if (state_.compare_exchange_strong(expected, 0, std::memory_order_release)) return;
+
+        // ⚠️ Baton Passing (Relay Baton Mechanism)
+        // Someone is waiting, we **do not** clear the locked bit.
+        // Instead, keep it set and wake up the next waiter directly.
+        // When the next waiter wakes up (in await_resume), it naturally owns the lock.
+        LockWaiter* w;
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            w = waiters_.pop_front();
+            state_.fetch_sub(kWaiter, std::memory_order_release);
         }
+        // Throw the awakened task back to the scheduler
+        sched_.spawn(Task::from_address(w->handle.address()));
     }
 
 private:
+    static constexpr uintptr_t kLocked = 1;
+    static constexpr uintptr_t kWaiter = 2;
+
+    Scheduler& sched_;
+    std::atomic<uintptr_t> state_{0}; // Logical lock state + waiter count
+    SpinLock lock_;                   // Guards waiters_ (nanosecond critical sections)
+    LockWaitList waiters_;            // Wait queue
+};
+
+// Readers-writer lock: any number of readers or one writer. State word: bit 0 = writer, bit 1 =
+// somebody is queued, the rest counts readers. A queued waiter stops new readers from barging in
+// (so a writer cannot starve), and whoever releases the lock last hands it to the queue under the
+// SpinLock: one writer, or the run of readers at the front, all at once.
+class AsyncRwLock {
+public:
+    explicit AsyncRwLock(Scheduler& sched) : sched_(sched) {}
+
+    AsyncRwLock(const AsyncRwLock&) = delete;
+    AsyncRwLock& operator=(const AsyncRwLock&) = delete;
+
+    template <bool Write>
+    class Guard {
+        AsyncRwLock& lock_;
+        bool owns_lock_;
+
+    public:
+        Guard(AsyncRwLock& l) : lock_(l), owns_lock_(true) {}
+        Guard(Guard&& other) noexcept : lock_(other.lock_), owns_lock_(other.owns_lock_) {
+            other.owns_lock_ = false;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            if (!owns_lock_) return;
+            if constexpr (Write) lock_.unlock();
+            else lock_.unlock_shared();
+        }
+    };
+    using ScopedReadLock = Guard<false>;
+    using ScopedWriteLock = Guard<true>;
+
+    template <bool Write>
+    struct LockAwaiter {
+        AsyncRwLock& rw;
+        LockWaiter node;
+
+        bool await_ready() { return Write ? rw.try_lock() : rw.try_lock_shared(); }
+
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            std::lock_guard<SpinLock> lock(rw.lock_);
+            uintptr_t s = rw.state_.load(std::memory_order_relaxed);
+            while (true) {
+                // Double-Check: the holders may have left since await_ready
+                bool free = Write ? s == 0 : !(s & (kWriter | kQueued));
+                if (free) {
+                    if (rw.state_.compare_exchange_weak(s, Write ? kWriter : s + kReader, std::memory_order_acquire)) {
+                        return false;
+                    }
+                    continue;
+                }
+                // Mark the queue busy: from now on the last holder to leave hands off under lock_
+                if (rw.state_.compare_exchange_weak(s, s | kQueued, std::memory_order_relaxed)) break;
+            }
+            node.handle = h;
+            node.write = Write;
+            rw.waiters_.push_back(&node);
+            // Ref +1 (for the wait queue), adopted again by spawn() in hand_off()
+            Task::retain(h);
+            TINYCORO_TRACE_EVENT(TraceEvent::kMutexWait, h.address(), &rw);
+            return true;
+        }
+
+        // Woken by hand_off() or not suspended at all: we hold the lock either way
+        Guard<Write> await_resume() { return Guard<Write>{rw}; }
+    };
+
+    // co_await rw.lock_shared() / rw.lock(): RAII guard, released when it goes out of scope
+    LockAwaiter<false> lock_shared() { return LockAwaiter<false>{*this, {}}; }
+    LockAwaiter<true> lock() { return LockAwaiter<true>{*this, {}}; }
+
+    bool try_lock_shared() {
+        uintptr_t s = state_.load(std::memory_order_relaxed);
+        while (!(s & (kWriter | kQueued))) {
+            if (state_.compare_exchange_weak(s, s + kReader, std::memory_order_acquire)) return true;
+        }
+        return false;
+    }
+
+    bool try_lock() {
+        uintptr_t expected = 0;
+        return state_.compare_exchange_strong(expected, kWriter, std::memory_order_acquire);
+    }
+
+    void unlock_shared() {
+        // The last reader out with a queue behind it passes the lock on
+        if (state_.fetch_sub(kReader, std::memory_order_release) == (kReader | kQueued)) hand_off();
+    }
+
+    void unlock() {
+        uintptr_t expected = kWriter;
+        if (state_.compare_exchange_strong(expected, 0, std::memory_order_release)) return;
+        hand_off();
+    }
+
+private:
+    static constexpr uintptr_t kWriter = 1;
+    static constexpr uintptr_t kQueued = 2;
+    static constexpr uintptr_t kReader = 4;
+
+    // No holder is left and kQueued keeps newcomers out, so the state is ours to rewrite
+    void hand_off() {
+        LockWaiter* batch = nullptr;
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            uintptr_t granted;
+            LockWaiter** link = &batch;
+            if (waiters_.front()->write) {
+                granted = kWriter;
+                *link = waiters_.pop_front();
+                link = &(*link)->next;
+            } else {
+                granted = 0;
+                while (!waiters_.empty() && !waiters_.front()->write) {
+                    granted += kReader;
+                    *link = waiters_.pop_front();
+                    link = &(*link)->next;
+                }
+            }
+            *link = nullptr;
+            state_.store(granted | (waiters_.empty() ? 0 : kQueued), std::memory_order_release);
+        }
+        while (batch) {
+            LockWaiter* next = batch->next; // The frame may be gone once it runs
+            sched_.spawn(Task::from_address(batch->handle.address()));
+            batch = next;
+        }
+    }
+
     Scheduler& sched_;
-    bool locked_;                 // Logical lock state
-    std::mutex wait_mtx_;         // Mutex for protecting internal state (spinlock granularity)
-    std::queue<std::coroutine_handle<>> waiters_; // Wait queue
-};
\ No newline at end of file
+    std::atomic<uintptr_t> state_{0};
+    SpinLock lock_;
+    LockWaitList waiters_;
+};
@@ -0,0 +1,141 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+// Elastic pool of plain threads for calls that block: disk IO, getaddrinfo, heavy CPU work.
+// Threads are started on demand, up to max_threads, and give themselves back after idle_timeout
+// without work. A job that finds every thread busy at the cap waits in a FIFO.
+// Scheduler::spawn_blocking() is the coroutine front end.
+class BlockingPool {
+public:
+    // Intrusive job: lives in whatever submits it (e.g. an awaiter in a coroutine frame)
+    struct Job {
+        void (*run)(Job*);
+        Job* next = nullptr;
+    };
+
+    struct Stats {
+        size_t threads = 0; // Alive right now, idle or not
+        size_t idle = 0;    // Waiting for a job
+        size_t queued = 0;  // Submitted, not yet picked up
+        uint64_t started = 0;   // Threads ever started
+        uint64_t completed = 0; // Jobs run
+    };
+
+    BlockingPool(size_t max_threads, std::chrono::milliseconds idle_timeout)
+        : max_threads_(max_threads ? max_threads : 1), idle_timeout_(idle_timeout) {}
+    BlockingPool(const BlockingPool&) = delete;
+    BlockingPool& operator=(const BlockingPool&) = delete;
+    ~BlockingPool() { shutdown(); }
+
+    // Any thread. job->run(job) is called on a pool thread; after shutdown(), on the caller's.
+    void submit(Job* job) {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (stop_) {
+            lock.unlock();
+            job->run(job);
+            return;
+        }
+        if (tail_) tail_->next = job;
+        else head_ = job;
+        tail_ = job;
+        job->next = nullptr;
+        ++queued_;
+
+        // Wake a sleeper nobody else has claimed, else start a thread while under the cap
+        if (idle_ > notified_) {
+            ++notified_;
+            cv_.notify_one();
+        } else if (threads_ < max_threads_) {
+            ++threads_;
+            ++started_;
+            try {
+                std::thread([this] { thread_main(); }).detach();
+            } catch (const std::system_error&) {
+                // Out of threads: the job waits for a busy one, or runs here if there is none
+                --threads_;
+                if (threads_ == 0) {
+                    Job* j = pop();
+                    lock.unlock();
+                    j->run(j);
+                    lock.lock();
+                    ++completed_;
+                }
+            }
+        }
+    }
+
+    // Runs whatever is still queued, then waits for every thread to exit. Idempotent.
+    void shutdown() {
+        std::unique_lock<std::mutex> lock(mu_);
+        stop_ = true;
+        cv_.notify_all();
+        exited_.wait(lock, [&] { return threads_ == 0; });
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return {threads_, idle_, queued_, started_, completed_};
+    }
+
+    size_t max_threads() const { return max_threads_; }
+
+private:
+    const size_t max_threads_;
+    const std::chrono::milliseconds idle_timeout_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;     // Idle threads wait here for a job
+    std::condition_variable exited_; // shutdown() waits here for threads_ == 0
+    Job* head_ = nullptr;
+    Job* tail_ = nullptr;
+    size_t queued_ = 0;
+    size_t threads_ = 0;
+    size_t idle_ = 0;
+    // Wake-ups sent but not yet taken by an idle thread: two quick submits must not both count
+    // on the same sleeper
+    size_t notified_ = 0;
+    bool stop_ = false;
+    uint64_t started_ = 0;
+    uint64_t completed_ = 0;
+
+    // mu_ held, queue not empty
+    Job* pop() {
+        Job* j = head_;
+        head_ = j->next;
+        if (!head_) tail_ = nullptr;
+        --queued_;
+        return j;
+    }
+
+    void thread_main() {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (true) {
+            if (head_) {
+                Job* j = pop();
+                lock.unlock();
+                j->run(j);
+                lock.lock();
+                ++completed_;
+                continue;
+            }
+            if (stop_) break;
+            ++idle_;
+            bool woken = cv_.wait_for(lock, idle_timeout_, [&] { return notified_ > 0 || stop_; });
+            --idle_;
+            if (notified_ > 0) {
+                --notified_;
+                continue;
+            }
+            if (!woken) break; // Idle for idle_timeout_: give the thread back
+        }
+        // Nothing touches *this once mu_ is released: shutdown() may destroy it right away
+        if (--threads_ == 0) exited_.notify_all();
+    }
+};
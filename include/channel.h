@@ -2,16 +2,59 @@
 #pragma once
 
 #include "scheduler.h"
-#include <queue>
+#include "spinlock.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <new>
 #include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+template <typename... Cases>
+class SelectAwaiter;
+
+// Shared by the cases of one select(): the first channel (or the deadline) to claim it completes
+// its case, and the other cases' parked nodes are stale from then on. A claim that can still fail
+// (a ring op racing the lock-free paths) holds kClaiming for a few instructions; others wait it out.
+struct SelectState {
+    static constexpr int kOpen = -1, kClaiming = -2;
+    std::atomic<int> winner{kOpen};
+
+    bool begin_claim() {
+        int s = winner.load(std::memory_order_acquire);
+        while (true) {
+            if (s == kClaiming) {
+                cpu_relax();
+                s = winner.load(std::memory_order_acquire);
+                continue;
+            }
+            if (s != kOpen) return false;
+            if (winner.compare_exchange_weak(s, kClaiming, std::memory_order_acquire)) return true;
+        }
+    }
+    void commit(int index) { winner.store(index, std::memory_order_release); }
+    void abort() { winner.store(kOpen, std::memory_order_release); }
+    bool try_claim(int index) {
+        if (!begin_claim()) return false;
+        commit(index);
+        return true;
+    }
+};
 
 template <typename T>
 class Channel {
+    struct SendNode;
+    struct RecvNode;
+    template <typename...> friend class SelectAwaiter;
+
 public:
     // Constructor: Need to pass in Scheduler to reschedule when waking up coroutines
-    Channel(Scheduler& sched, size_t capacity = 0) 
-        : sched_(sched), capacity_(capacity), closed_(false) {}
+    Channel(Scheduler& sched, size_t capacity = 0)
+        : sched_(sched), capacity_(capacity), ring_(capacity) {}
 
     // Disable copy and move (for simplicity, Channel is usually shared via pointers or references)
     Channel(const Channel&) = delete;
@@ -20,161 +63,735 @@ public:
     ~Channel() { close(); }
 
     void close() {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (closed_) return;
-        closed_ = true;
-        
-        // Wake up all waiting senders and receivers
-        while (!send_waiters_.empty()) {
-            auto& w = send_waiters_.front();
-            sched_.spawn(Task::from_address(w.handle.address()));
-            send_waiters_.pop();
+        std::lock_guard<SpinLock> lock(lock_);
+        if (closed_.load(std::memory_order_relaxed)) return;
+        closed_.store(true, std::memory_order_seq_cst);
+
+        // Waiting receivers still get what a lock-free send left in the ring, then nullopt
+        while (RecvNode* r = recv_waiters_.pop_front()) {
+            if (!claim(r)) continue; // Its select already completed elsewhere
+            take(*r);
+            wake(r->handle);
         }
-        while (!recv_waiters_.empty()) {
-            auto& w = recv_waiters_.front();
-            // Set a null value or error flag to let receivers know it's closed
-            if (w.result_ptr) *w.result_ptr = std::nullopt;
-            sched_.spawn(Task::from_address(w.handle.address()));
-            recv_waiters_.pop();
+        // Waiting senders have handed nothing over (they would have been woken): result false
+        while (SendNode* s = send_waiters_.pop_front()) {
+            if (claim(s)) wake(s->handle);
         }
+        nrecv_.store(0, std::memory_order_relaxed);
+        nsend_.store(0, std::memory_order_relaxed);
     }
 
-    bool is_closed() const {
-        std::lock_guard<std::mutex> lock(mtx_);
-        return closed_;
-    }
+    bool is_closed() const { return closed_.load(std::memory_order_acquire); }
 
-    // --- Send Awaitable ---
-    struct SendAwaiter {
+    // --- Send Awaitables ---
+    // Common part of send() and send_batch(): `node.items[0, n)` are moved into the channel,
+    // at least one unless it is closed. `node.done` says how many.
+    struct SendBase {
         Channel& chan;
-        T value;
-        bool result = true; // Whether the send operation succeeded
-
-        // Always let the control flow enter await_suspend and make safe judgments within the lock
-        bool await_ready() { return false; }
+        SendNode node;
+
+        bool yield = false; // Completed in await_ready, but the CoopBudget is spent
+
+        // Fast path (buffered, nobody parked): lock-free ring push, no suspension
+        bool try_fast() { return chan.try_send_fast(node); }
+        // An operation that completed without suspending spends budget; once it is out, the
+        // task still completes the operation but yields in await_suspend
+        bool charge() {
+            if (CoopBudget::consume()) return true;
+            yield = true;
+            return false;
+        }
+        bool await_ready() { return try_fast() && charge(); }
 
         // Return value (bool):
-        // false -> Do not suspend, resume the current coroutine immediately (high-performance path)
-        // true  -> Suspend, transfer control of the current coroutine to the scheduler (blocking path)
-        bool await_suspend(std::coroutine_handle<> h) {
-            std::lock_guard<std::mutex> lock(chan.mtx_);
-
-            // 0. Channel is closed
-            if (chan.closed_) {
-                result = false;
-                return false; // Do not suspend, return failure directly
-            }
+        // false -> Do not suspend, resume the current coroutine immediately (handed off under the lock)
+        // true  -> Suspend, transfer control of the current coroutine to the scheduler (blocking path,
+        //          or a yield: the send is done, but the task's budget is spent)
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            if (!yield && chan.send_slow(node, h)) return true; // Parked
+            // Done without parking: under the lock, or in await_ready with the budget spent
+            if (!yield && charge()) return false;
+            return coop_yield(h);
+        }
+    };
 
-            // 1. Direct Handoff (Directly to waiting receivers)
-            // Whether the buffer is full or empty, if there are receivers waiting, send directly to them and skip the buffer
-            if (!chan.recv_waiters_.empty()) {
-                auto& waiter = chan.recv_waiters_.front();
-                // Write data directly across stacks
-                *waiter.result_ptr = std::move(value);
+    struct SendAwaiter : SendBase {
+        T value;
+        SendAwaiter(Channel& c, T v) : SendBase{c, {}}, value(std::move(v)) {}
+        bool try_fast() {
+            this->node.items = &value;
+            this->node.n = 1;
+            return SendBase::try_fast();
+        }
+        bool await_ready() { return try_fast() && this->charge(); }
+        // Whether the send operation succeeded (false: the channel is closed)
+        bool await_resume() { return this->node.done == 1; }
+    };
 
-                // Wake up the receiver (via the scheduler)
-                chan.sched_.spawn(Task::from_address(waiter.handle.address()));
-                chan.recv_waiters_.pop();
+    struct SendBatchAwaiter : SendBase {
+        // Number of items sent from the front of the batch; 0 only if the channel is closed
+        size_t await_resume() { return this->node.done; }
+    };
 
-                // ✅ The current sender does not suspend and continues execution directly
-                return false;
-            }
+    // --- Recv Awaitables ---
+    struct RecvBase {
+        Channel& chan;
+        RecvNode node;
 
-            // 2. The buffer is not full
-            if (chan.buffer_.size() < chan.capacity_) {
-                chan.buffer_.push(std::move(value));
-                // ✅ Write succeeded, no suspension, continue execution directly
-                return false;
-            }
+        bool yield = false;
 
-            // 3. Blocking suspension
-            // The buffer is full and there are no receivers, so suspension is mandatory
-            chan.send_waiters_.push({h, &value});
-            return true;
+        bool try_fast() { return chan.try_recv_fast(node); }
+        bool charge() {
+            if (CoopBudget::consume()) return true;
+            yield = true;
+            return false;
         }
+        bool await_ready() { return try_fast() && charge(); }
 
-        bool await_resume() { return result; }
+        // Return bool: Optimization logic is the same as above
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            if (!yield && chan.recv_slow(node, h)) return true; // Parked
+            if (!yield && charge()) return false;
+            return coop_yield(h);
+        }
     };
 
-    // --- Recv Awaitable ---
-    struct RecvAwaiter {
-        Channel& chan;
+    struct RecvAwaiter : RecvBase {
         std::optional<T> result;
+        explicit RecvAwaiter(Channel& c) : RecvBase{c, {}} {}
+        bool try_fast() {
+            this->node.one = &result;
+            this->node.max = 1;
+            return RecvBase::try_fast();
+        }
+        bool await_ready() { return try_fast() && this->charge(); }
+        std::optional<T> await_resume() { return std::move(result); }
+    };
 
-        bool await_ready() { return false; }
+    struct RecvBatchAwaiter : RecvBase {
+        // Number of items written to the front of `out`; 0 once the channel is closed and drained
+        size_t await_resume() { return this->node.got; }
+    };
 
-        // Return bool: Optimization logic is the same as above
-        bool await_suspend(std::coroutine_handle<> h) {
-            std::lock_guard<std::mutex> lock(chan.mtx_);
-
-            // 1. Prioritize reading from the buffer
-            if (!chan.buffer_.empty()) {
-                result = std::move(chan.buffer_.front());
-                chan.buffer_.pop();
-
-                // The buffer has free space; check if there are any senders waiting
-                if (!chan.send_waiters_.empty()) {
-                    auto& sender = chan.send_waiters_.front();
-                    // Chain operation: Move the sender's data into the newly freed slot
-                    chan.buffer_.push(std::move(*sender.value_ptr));
-                    // Wake up the sender
-                    chan.sched_.spawn(Task::from_address(sender.handle.address()));
-                    chan.send_waiters_.pop();
+    // User interface
+    SendAwaiter send(T val) { return SendAwaiter(*this, std::move(val)); }
+    RecvAwaiter recv() { return RecvAwaiter(*this); }
+    // Move up to n items per await, suspending only until the first one is accepted. The array
+    // must stay alive until the await completes. Returns the number sent.
+    SendBatchAwaiter send_batch(T* items, size_t n) {
+        SendBatchAwaiter a{{*this, {}}};
+        a.node.items = items;
+        a.node.n = n;
+        return a;
+    }
+    // Receive up to max items into out (assigned, so T must be default-constructible), suspending
+    // only until the first one arrives. Returns the number received.
+    RecvBatchAwaiter recv_batch(T* out, size_t max) {
+        RecvBatchAwaiter a{{*this, {}}};
+        a.node.many = out;
+        a.node.max = max;
+        return a;
+    }
+
+private:
+    // Intrusive waiter nodes: they live in the awaiters, so parking allocates nothing
+    struct SendNode {
+        std::coroutine_handle<> handle;
+        T* items = nullptr; // Points into the SendAwaiter / the caller's batch
+        size_t n = 0;
+        size_t done = 0;
+        SelectState* sel = nullptr; // Case `index` of a select(), which must be claimed first
+        int index = 0;
+        bool linked = false;
+        SendNode* prev = nullptr;
+        SendNode* next = nullptr;
+    };
+
+    struct RecvNode {
+        std::coroutine_handle<> handle;
+        std::optional<T>* one = nullptr; // recv(): the RecvAwaiter's result
+        T* many = nullptr;               // recv_batch(): the caller's array
+        size_t max = 0;
+        size_t got = 0;
+        SelectState* sel = nullptr;
+        int index = 0;
+        bool linked = false;
+        RecvNode* prev = nullptr;
+        RecvNode* next = nullptr;
+
+        void put(T&& v) {
+            if (one) one->emplace(std::move(v));
+            else many[got] = std::move(v);
+            ++got;
+        }
+    };
+
+    // FIFO of parked awaiters (guarded by lock_)
+    template <typename Node>
+    struct WaitList {
+        Node* head = nullptr;
+        Node* tail = nullptr;
+
+        Node* front() const { return head; }
+        void push_back(Node* n) {
+            n->prev = tail;
+            n->next = nullptr;
+            (tail ? tail->next : head) = n;
+            tail = n;
+            n->linked = true;
+        }
+        void remove(Node* n) {
+            (n->prev ? n->prev->next : head) = n->next;
+            (n->next ? n->next->prev : tail) = n->prev;
+            n->linked = false;
+        }
+        Node* pop_front() {
+            Node* n = head;
+            if (n) remove(n);
+            return n;
+        }
+    };
+
+    // Bounded MPMC ring (Vyukov's, as GlobalQueue), preallocated for the channel's capacity.
+    // Sequence numbers count in halves so any capacity works, 1 included: slot seq == 2*pos means
+    // free for pos, 2*pos + 1 published, and a receiver frees it for the next lap with 2*(pos + cap).
+    class Ring {
+        struct Slot {
+            std::atomic<size_t> seq;
+            alignas(T) unsigned char storage[sizeof(T)];
+            T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+        };
+
+        Slot* slots_;
+        size_t cap_;
+        bool pow2_;
+        alignas(64) std::atomic<size_t> head_{0}; // Receivers claim from here
+        alignas(64) std::atomic<size_t> tail_{0}; // Senders claim from here
+
+        size_t index(size_t pos) const { return pow2_ ? pos & (cap_ - 1) : pos % cap_; }
+
+    public:
+        explicit Ring(size_t cap) : slots_(cap ? new Slot[cap] : nullptr), cap_(cap), pow2_((cap & (cap - 1)) == 0) {
+            for (size_t i = 0; i < cap; ++i) slots_[i].seq.store(2 * i, std::memory_order_relaxed);
+        }
+        ~Ring() {
+            while (pop_n(cap_, [](T&&) {})) {}
+            delete[] slots_;
+        }
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        // Claim the longest run of free slots (up to n) with a single CAS on tail_, then move
+        // items[0, k) in. Returns k (0: full).
+        size_t push_n(T* items, size_t n) {
+            if (cap_ == 0 || n == 0) return 0;
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            while (true) {
+                size_t k = 0;
+                while (k < n && k < cap_) {
+                    size_t seq = slots_[index(pos + k)].seq.load(std::memory_order_acquire);
+                    if (seq != 2 * (pos + k)) break;
+                    ++k;
+                }
+                if (k == 0) {
+                    size_t seq = slots_[index(pos)].seq.load(std::memory_order_acquire);
+                    if ((intptr_t)(seq - 2 * pos) < 0) return 0; // Slot still holds last lap's item: full
+                    pos = tail_.load(std::memory_order_relaxed); // Another sender moved tail_
+                    continue;
                 }
+                if (tail_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    for (size_t i = 0; i < k; ++i) {
+                        Slot& s = slots_[index(pos + i)];
+                        ::new (s.storage) T(std::move(items[i]));
+                        s.seq.store(2 * (pos + i) + 1, std::memory_order_release);
+                    }
+                    return k;
+                }
+            }
+        }
 
-                // ✅ Data received, no suspension, return directly
-                return false;
+        // Claim the longest run of published slots (up to n) with a single CAS on head_ and hand
+        // each value to sink(T&&). Returns k (0: empty).
+        template <typename Sink>
+        size_t pop_n(size_t n, Sink&& sink) {
+            if (cap_ == 0 || n == 0) return 0;
+            size_t pos = head_.load(std::memory_order_relaxed);
+            while (true) {
+                size_t k = 0;
+                while (k < n && k < cap_) {
+                    size_t seq = slots_[index(pos + k)].seq.load(std::memory_order_acquire);
+                    if (seq != 2 * (pos + k) + 1) break;
+                    ++k;
+                }
+                if (k == 0) {
+                    size_t seq = slots_[index(pos)].seq.load(std::memory_order_acquire);
+                    if ((intptr_t)(seq - (2 * pos + 1)) < 0) return 0; // Not yet published: empty
+                    pos = head_.load(std::memory_order_relaxed); // Another receiver moved head_
+                    continue;
+                }
+                if (head_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    for (size_t i = 0; i < k; ++i) {
+                        Slot& s = slots_[index(pos + i)];
+                        T* v = s.value();
+                        sink(std::move(*v));
+                        v->~T();
+                        s.seq.store(2 * (pos + i + cap_), std::memory_order_release);
+                    }
+                    return k;
+                }
             }
+        }
+    };
 
-            // 2. The buffer is empty but there are senders waiting (for capacity=0 cases)
-            // Direct Handoff: Grab data directly from the sender
-            if (!chan.send_waiters_.empty()) {
-                auto& sender = chan.send_waiters_.front();
-                result = std::move(*sender.value_ptr);
+    void wake(std::coroutine_handle<> h) {
+        // Adopt the reference taken in await_suspend
+        sched_.spawn(Task::from_address(h.address()));
+    }
 
-                // Wake up the sender
-                chan.sched_.spawn(Task::from_address(sender.handle.address()));
-                chan.send_waiters_.pop();
+    // --- Lock-free fast paths ---
 
-                // ✅ Data received, no suspension
-                return false;
+    bool try_send_fast(SendNode& s) {
+        // Parked senders go first, and a closed channel is answered under the lock
+        if (capacity_ == 0 || nsend_.load(std::memory_order_acquire) != 0 ||
+            closed_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        s.done = ring_.push_n(s.items, s.n);
+        if (s.done == 0) return false;
+        // Pairs with the fence in recv_slow: either that receiver's re-check sees our items,
+        // or we see it parked and hand them over
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (nrecv_.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard<SpinLock> lock(lock_);
+            feed_receivers();
+        }
+        return true;
+    }
+
+    bool try_recv_fast(RecvNode& r) {
+        if (capacity_ == 0) return false;
+        r.got = ring_.pop_n(r.max, [&](T&& v) { r.put(std::move(v)); });
+        if (r.got == 0) return false;
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in send_slow
+        if (nsend_.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard<SpinLock> lock(lock_);
+            refill_from_senders();
+        }
+        return true;
+    }
+
+    // --- Locked paths (lock_ held) ---
+
+    // A parked node of a select() completes only if it wins its select first
+    template <typename Node>
+    static bool claim(Node* n) { return !n->sel || n->sel->try_claim(n->index); }
+
+    void park(SendNode& s) {
+        send_waiters_.push_back(&s);
+        nsend_.store(nsend_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    void park(RecvNode& r) {
+        recv_waiters_.push_back(&r);
+        nrecv_.store(nrecv_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    void unlink(SendNode* s) {
+        send_waiters_.remove(s);
+        nsend_.store(nsend_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+    void unlink(RecvNode* r) {
+        recv_waiters_.remove(r);
+        nrecv_.store(nrecv_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+
+    // Hand items to parked receivers, oldest first: the ring's, then parked senders'
+    void feed_receivers() {
+        while (RecvNode* r = recv_waiters_.front()) {
+            if (r->sel) {
+                if (!r->sel->begin_claim()) {
+                    unlink(r); // Lost its select
+                    continue;
+                }
+                // Ring only while the claim is tentative: a parked sender may be the same select
+                ring_.pop_n(r->max, [&](T&& v) { r->put(std::move(v)); });
+                if (r->got == 0) {
+                    r->sel->abort();
+                    break;
+                }
+                r->sel->commit(r->index);
             }
+            take(*r);
+            if (r->got == 0) break;
+            unlink(r);
+            wake(r->handle);
+        }
+    }
 
-            // 3. If closed and no data available
-            if (chan.closed_) {
-                result = std::nullopt;
-                return false; // No suspension, return a null value
+    // Fill r from the ring, then directly from parked senders (unbuffered channels, or a full ring)
+    void take(RecvNode& r) {
+        while (r.got < r.max) {
+            if (ring_.pop_n(r.max - r.got, [&](T&& v) { r.put(std::move(v)); })) {
+                refill_from_senders(); // Freed slots go to parked senders first
+                continue;
             }
+            SendNode* s = send_waiters_.front();
+            if (!s) break;
+            unlink(s);
+            if (!claim(s)) continue;
+            while (s->done < s->n && r.got < r.max) r.put(std::move(s->items[s->done++]));
+            wake(s->handle);
+        }
+    }
 
-            // 4. No data available, suspend
-            chan.recv_waiters_.push({h, &result});
-            return true;
+    // Move parked senders' items into free ring slots; wake each one that got rid of any
+    void refill_from_senders() {
+        while (SendNode* s = send_waiters_.front()) {
+            if (s->sel && !s->sel->begin_claim()) {
+                unlink(s);
+                continue;
+            }
+            s->done += ring_.push_n(s->items + s->done, s->n - s->done);
+            if (s->done == 0) { // Ring full again
+                if (s->sel) s->sel->abort();
+                break;
+            }
+            if (s->sel) s->sel->commit(s->index);
+            unlink(s);
+            wake(s->handle);
         }
+    }
 
-        std::optional<T> await_resume() { return std::move(result); }
-    };
+    // Complete s without parking if possible: true once anything moved, or the channel is closed
+    bool complete_locked(SendNode& s) {
+        // 0. Channel is closed
+        if (closed_.load(std::memory_order_relaxed)) return true; // done == 0
+
+        // 1. Direct Handoff (Directly to waiting receivers), after what the ring already holds
+        feed_receivers();
+        while (s.done < s.n) {
+            RecvNode* r = recv_waiters_.front();
+            if (!r) break;
+            unlink(r);
+            if (!claim(r)) continue;
+            while (s.done < s.n && r->got < r->max) r->put(std::move(s.items[s.done++]));
+            wake(r->handle);
+        }
 
-    // User interface
-    SendAwaiter send(T val) { return SendAwaiter{*this, std::move(val)}; }
-    RecvAwaiter recv() { return RecvAwaiter{*this}; }
+        // 2. The buffer is not full (and no parked sender is ahead of us)
+        if (s.done < s.n && !send_waiters_.front()) s.done += ring_.push_n(s.items + s.done, s.n - s.done);
+        return s.done > 0 || s.n == 0;
+    }
 
-private:
-    struct SenderWaiter {
-        std::coroutine_handle<> handle;
-        T* value_ptr; // Points to the value in SendAwaiter
-    };
+    // Same for r: true once anything arrived, or the channel is closed and drained
+    bool complete_locked(RecvNode& r) {
+        // Prioritize reading from the buffer, then Direct Handoff from waiting senders
+        take(r);
+        return r.got > 0 || r.max == 0 || closed_.load(std::memory_order_relaxed);
+    }
 
-    struct RecvWaiter {
-        std::coroutine_handle<> handle;
-        std::optional<T>* result_ptr; // Points to the result in RecvAwaiter
-    };
+    // After parking and the fence: a lock-free op may have changed the ring before it could see
+    // the waiter. Only the oldest waiter looks, so the queue order holds.
+    bool recheck(SendNode& s) {
+        return send_waiters_.front() == &s && (s.done = ring_.push_n(s.items, s.n)) > 0;
+    }
+    bool recheck(RecvNode& r) {
+        if (recv_waiters_.front() != &r) return false;
+        return ring_.pop_n(r.max, [&](T&& v) { r.put(std::move(v)); }) > 0;
+    }
+
+    // After a successful recheck (the node unlinked): pass the change on to the other side
+    void settle(SendNode&) { feed_receivers(); }
+    void settle(RecvNode&) { refill_from_senders(); }
+
+    bool send_slow(SendNode& s, std::coroutine_handle<Task::Promise> h) {
+        std::lock_guard<SpinLock> lock(lock_);
+        if (complete_locked(s)) return false; // Do not suspend
+
+        // 3. Blocking suspension: publish the waiter, then look once more
+        s.handle = h;
+        park(s);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (recheck(s)) {
+            unlink(&s);
+            return false;
+        }
+        // Ref +1 (for the waiter list), adopted again by wake() on wake-up. Nobody can take the
+        // node before we unlock.
+        Task::retain(h);
+        TINYCORO_TRACE_EVENT(TraceEvent::kChannelWait, h.address(), this);
+        return true;
+    }
+
+    bool recv_slow(RecvNode& r, std::coroutine_handle<Task::Promise> h) {
+        std::lock_guard<SpinLock> lock(lock_);
+        // Data available, or closed and no data: no suspension (a null value in the latter case)
+        if (complete_locked(r)) return false;
+
+        // No data available, suspend (same re-check as send_slow)
+        r.handle = h;
+        park(r);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (recheck(r)) {
+            unlink(&r);
+            settle(r);
+            return false;
+        }
+        // Ref +1 (for the waiter list), adopted again by wake() on wake-up
+        Task::retain(h);
+        TINYCORO_TRACE_EVENT(TraceEvent::kChannelWait, h.address(), this);
+        return true;
+    }
 
     Scheduler& sched_;
     size_t capacity_;
-    bool closed_;
-    
-    mutable std::mutex mtx_;
-    std::queue<T> buffer_;
-    std::queue<SenderWaiter> send_waiters_;
-    std::queue<RecvWaiter> recv_waiters_;
-};
\ No newline at end of file
+    std::atomic<bool> closed_{false};
+    // Parked awaiters per side, readable without the lock (lock_ holders write them)
+    alignas(64) std::atomic<size_t> nsend_{0};
+    std::atomic<size_t> nrecv_{0};
+
+    SpinLock lock_; // Only taken when someone parks or has to wake a parked peer
+    WaitList<SendNode> send_waiters_;
+    WaitList<RecvNode> recv_waiters_;
+    Ring ring_;
+};
+
+
+// Deadline case of select(): a plain duration among the cases. Its result is std::monostate.
+// A timeout <= 0 makes the select non-blocking (Go's `default:`): it wins if nothing is ready.
+struct SelectTimeout {
+    std::chrono::milliseconds timeout;
+
+    template <typename Rep, typename Period>
+    SelectTimeout(std::chrono::duration<Rep, Period> d)
+        : timeout(std::chrono::ceil<std::chrono::milliseconds>(d)) {}
+    std::monostate await_resume() { return {}; }
+};
+
+template <typename C>
+struct SelectCaseOf { using type = C; };
+template <typename Rep, typename Period>
+struct SelectCaseOf<std::chrono::duration<Rep, Period>> { using type = SelectTimeout; };
+
+// Waits on several channel operations (ch.recv(), ch.send(v)) at once, plus an optional timeout.
+// Exactly one case completes; the result is a std::variant whose index() is that case's position
+// and whose alternative is what the case's own co_await would have returned.
+//
+// Like Go's selectgo: poll every case lock-free, then lock all channels (in address order) and try
+// the locked hand-offs, then park one node per case on every channel. Whoever claims the shared
+// SelectState first completes its case and wakes the task; the resumed task unlinks the rest.
+template <typename... Cases>
+class SelectAwaiter {
+    static constexpr size_t N = sizeof...(Cases);
+    static constexpr size_t kTimeouts = (size_t(std::is_same_v<Cases, SelectTimeout>) + ...);
+    static constexpr size_t kChannels = N - kTimeouts;
+    static_assert(kTimeouts <= 1, "select() takes at most one timeout");
+    static_assert(kChannels >= 1, "select() needs at least one channel operation");
+    static constexpr size_t kTimeoutIndex = [] {
+        constexpr bool is_timeout[] = {std::is_same_v<Cases, SelectTimeout>...};
+        size_t i = 0;
+        while (i < N && !is_timeout[i]) ++i;
+        return i; // N: no timeout
+    }();
+
+    std::tuple<Cases...> cases_;
+    SelectState state_;
+    size_t start_ = 0;
+    std::array<SpinLock*, kChannels> locks_{};
+    size_t nlocks_ = 0;
+    bool parked_ = false;
+    // Timeout only
+    Reactor* reactor_ = nullptr;
+    void* task_ = nullptr;
+    TimerHandle timer_;
+    std::atomic<bool> timer_done_{false}; // The deadline lost and let go of *this
+
+    bool yield_ = false; // A case won in await_ready, but the CoopBudget is spent
+
+    // Rotating start index, so an always-ready first case cannot starve the others
+    inline static thread_local uint32_t rotation_ = 0;
+
+    template <typename C>
+    static constexpr bool kIsTimeout = std::is_same_v<std::decay_t<C>, SelectTimeout>;
+
+    // f(index, case) on case i
+    template <typename F>
+    bool visit(size_t i, F& f) {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            bool hit = false;
+            ((void)(I == i && (hit = f(I, std::get<I>(cases_)))), ...);
+            return hit;
+        }(std::index_sequence_for<Cases...>{});
+    }
+
+    // Channel cases in poll order until f returns true
+    template <typename F>
+    bool any_case(F&& f) {
+        for (size_t k = 0; k < N; ++k) {
+            if (visit((start_ + k) % N, f)) return true;
+        }
+        return false;
+    }
+
+    template <typename F>
+    void each_channel(F&& f) {
+        any_case([&](size_t i, auto& c) {
+            if constexpr (!kIsTimeout<decltype(c)>) f(i, c);
+            return false;
+        });
+    }
+
+    void lock_all() {
+        for (size_t i = 0; i < nlocks_; ++i) locks_[i]->lock();
+    }
+    void unlock_all() {
+        for (size_t i = 0; i < nlocks_; ++i) locks_[i]->unlock();
+    }
+    // lock_all() held: take back every node still parked
+    void cancel_all() {
+        each_channel([](size_t, auto& c) {
+            if (c.node.linked) c.chan.unlink(&c.node);
+        });
+    }
+
+    std::chrono::milliseconds timeout() {
+        if constexpr (kTimeoutIndex < N) return std::get<kTimeoutIndex>(cases_).timeout;
+        else return std::chrono::milliseconds::max();
+    }
+
+    // A select decided without parking spends budget like a single channel operation
+    bool finished_inline() {
+        if (CoopBudget::consume()) return true;
+        yield_ = true;
+        return false;
+    }
+
+    static void expired(void* arg) {
+        auto* self = static_cast<SelectAwaiter*>(arg);
+        if (self->state_.try_claim(kTimeoutIndex)) self->reactor_->spawn(self->task_);
+        else self->timer_done_.store(true, std::memory_order_release);
+    }
+
+public:
+    using Result = std::variant<decltype(std::declval<Cases&>().await_resume())...>;
+
+    template <typename... Args>
+    explicit SelectAwaiter(Args&&... args) : cases_(std::forward<Args>(args)...) {}
+    SelectAwaiter(const SelectAwaiter&) = delete;
+    SelectAwaiter& operator=(const SelectAwaiter&) = delete;
+
+    // 1. Lock-free pass: each case's own fast path (which also prepares its node)
+    bool await_ready() {
+        start_ = rotation_++ % N;
+        return any_case([&](size_t i, auto& c) {
+            if constexpr (kIsTimeout<decltype(c)>) {
+                return false;
+            } else {
+                if (!c.try_fast()) return false;
+                state_.commit((int)i);
+                return true;
+            }
+        }) && finished_inline();
+    }
+
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h); // Won in await_ready, but the budget is spent
+        // Lock every distinct channel in address order, so two selects cannot deadlock and no case
+        // can complete while the others are checked and parked
+        each_channel([&](size_t, auto& c) {
+            locks_[nlocks_++] = &c.chan.lock_;
+            reactor_ = c.chan.sched_.reactor();
+        });
+        std::sort(locks_.begin(), locks_.begin() + nlocks_);
+        nlocks_ = std::unique(locks_.begin(), locks_.begin() + nlocks_) - locks_.begin();
+        lock_all();
+
+        // 2. Locked pass: hand-offs with parked peers, closed channels
+        if (any_case([&](size_t i, auto& c) {
+                if constexpr (kIsTimeout<decltype(c)>) {
+                    return false;
+                } else {
+                    if (!c.chan.complete_locked(c.node)) return false;
+                    state_.commit((int)i);
+                    return true;
+                }
+            })) {
+            unlock_all();
+            return !finished_inline() && coop_yield(h);
+        }
+        if (timeout().count() <= 0) {
+            state_.commit((int)kTimeoutIndex);
+            unlock_all();
+            return !finished_inline() && coop_yield(h);
+        }
+
+        // 3. Park on every channel, then re-check the rings as a single op does. Nobody can claim
+        // yet: every channel's lock is held.
+        each_channel([&](size_t i, auto& c) {
+            c.node.handle = h;
+            c.node.sel = &state_;
+            c.node.index = (int)i;
+            c.chan.park(c.node);
+        });
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool done = any_case([&](size_t i, auto& c) {
+            if constexpr (kIsTimeout<decltype(c)>) {
+                return false;
+            } else {
+                if (!c.chan.recheck(c.node)) return false;
+                state_.commit((int)i);
+                cancel_all();
+                c.chan.settle(c.node);
+                return true;
+            }
+        });
+        if (done) {
+            unlock_all();
+            return !finished_inline() && coop_yield(h);
+        }
+
+        // Ref +1 (for the waiter lists), adopted by whichever case or deadline claims the select
+        parked_ = true;
+        Task::retain(h);
+        each_channel([&](size_t, [[maybe_unused]] auto& c) {
+            TINYCORO_TRACE_EVENT(TraceEvent::kChannelWait, h.address(), &c.chan);
+        });
+        if constexpr (kTimeoutIndex < N) {
+            task_ = h.address();
+            reactor_->add_timer(std::chrono::steady_clock::now() + timeout(), &SelectAwaiter::expired, this, &timer_);
+        }
+        // Once the first lock is released a claimer can resume the task: unlock from a copy
+        std::array<SpinLock*, kChannels> locks = locks_;
+        size_t n = nlocks_;
+        for (size_t i = 0; i < n; ++i) locks[i]->unlock();
+        return true;
+    }
+
+    Result await_resume() {
+        size_t w = (size_t)state_.winner.load(std::memory_order_acquire);
+        if (parked_) {
+            // Take back the losing cases' nodes (claimers that met one first already dropped it)
+            lock_all();
+            cancel_all();
+            unlock_all();
+            // A deadline that lost may be about to run expired(): wait until it lets go of *this
+            if constexpr (kTimeoutIndex < N) {
+                if (w != kTimeoutIndex && !reactor_->cancel_timer(timer_.id)) {
+                    while (!timer_done_.load(std::memory_order_acquire)) std::this_thread::yield();
+                }
+            }
+        }
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            using Make = Result (*)(SelectAwaiter&);
+            static constexpr Make table[] = {+[](SelectAwaiter& s) {
+                return Result(std::in_place_index<I>, std::get<I>(s.cases_).await_resume());
+            }...};
+            return table[w](*this);
+        }(std::index_sequence_for<Cases...>{});
+    }
+};
+
+// co_await select(a.recv(), b.send(v), 50ms): the first case to complete wins, see SelectAwaiter.
+// At most one duration, which bounds the wait; the channel operations must not be awaited elsewhere.
+template <typename... Cases>
+SelectAwaiter<typename SelectCaseOf<std::decay_t<Cases>>::type...> select(Cases&&... cases) {
+    return SelectAwaiter<typename SelectCaseOf<std::decay_t<Cases>>::type...>(std::forward<Cases>(cases)...);
+}
@@ -1,39 +1,81 @@
 // Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
 #pragma once
 #include <atomic>
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
-#include <list>
-#include <functional>
-#include <mutex>
-#include <thread>
+
+// Counters for EbrManager::stats(). `pending` is what the bounded-garbage check watches.
+struct EbrStats {
+    size_t threads = 0;  // Registered LocalStates
+    size_t pending = 0;  // Retired, not yet freed (thread bins + orphans)
+    size_t retired = 0;  // Total ever retired
+    size_t freed = 0;    // Total ever freed
+    size_t advances = 0; // Global epoch value
+};
 
 class EbrManager {
 public:
+    // Type-erased deleter without std::function: one function pointer per retired object
     struct Node {
         void* ptr;
-        std::function<void(void*)> deleter;
+        void (*deleter)(void*);
     };
 
-    // Thread-local state
-    struct LocalState {
+    // Thread-local state. Every field but the bins is read by other threads' try_advance/stats,
+    // and each state has its own cache lines so scans don't bounce a neighbour's.
+    struct alignas(64) LocalState {
         std::atomic<bool> active{false}; // Whether in the critical section
         std::atomic<size_t> epoch{0};    // Globally visible Epoch
+        std::atomic<bool> in_use{false}; // Registry slot taken
+        std::atomic<size_t> pending{0};  // Retired, not yet freed (owner writes)
         std::vector<Node> retire_bins[3]; // Garbage collection buckets corresponding to 3 generations (epoch-based)
-        size_t op_count{0};               // Counter to trigger GC
+        size_t bin_epoch[3] = {0, 0, 0};  // Epoch the garbage in each bin was retired in
+        size_t op_count{0};               // Retires since the last advance attempt
     };
 
+    // Registry capacity; register_thread throws beyond it
+    static constexpr size_t kMaxThreads = 512;
+    // A thread holding this much garbage tries to advance on every retire instead of every 64th
+    static constexpr size_t kPendingSoftLimit = 16;
+
     static EbrManager& get() {
         static EbrManager instance;
         return instance;
     }
 
-    // Register current thread
+    // Register a thread: claims a free slot of the fixed array, no lock
     LocalState* register_thread() {
-        std::lock_guard<std::mutex> lock(mtx_);
-        auto ptr = std::make_unique<LocalState>();
-        LocalState* raw = ptr.get();
-        threads_.push_back(std::move(ptr));
-        return raw;
+        for (size_t i = 0; i < kMaxThreads; ++i) {
+            bool expected = false;
+            if (!slots_[i].in_use.load(std::memory_order_relaxed) &&
+                slots_[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                size_t hw = high_water_.load(std::memory_order_relaxed);
+                while (hw < i + 1 && !high_water_.compare_exchange_weak(hw, i + 1, std::memory_order_acq_rel)) {}
+                return &slots_[i];
+            }
+        }
+        throw std::runtime_error("EbrManager: too many threads");
+    }
+
+    // Release a slot (the thread must be outside any critical section). Garbage the owner could
+    // not free yet becomes an orphan batch, freed by whichever thread next advances the epoch.
+    void unregister_thread(LocalState* local) {
+        for (int i = 0; i < 3; ++i) {
+            if (local->retire_bins[i].empty()) continue;
+            auto* o = new Orphan{std::move(local->retire_bins[i]), local->bin_epoch[i], nullptr};
+            local->retire_bins[i].clear();
+            push_orphan(o);
+        }
+        local->pending.store(0, std::memory_order_relaxed);
+        local->op_count = 0;
+        local->active.store(false, std::memory_order_relaxed);
+        local->in_use.store(false, std::memory_order_release);
+        // Usually the last Worker of a Scheduler: nobody lags, so the orphans go right away
+        for (int i = 0; i < 2 && orphans_.load(std::memory_order_acquire); ++i) {
+            if (!advance()) break;
+        }
+        free_orphans(global_epoch_.load(std::memory_order_acquire));
     }
 
     // Enter critical section
@@ -51,55 +93,126 @@ public:
     // Retired ptr (lazy delete)
     template<typename T>
     void retire(LocalState* local, T* ptr) {
+        // Order the caller's unlink before reading the tag: a reader pinned in a later epoch must
+        // see the new pointer, so `e + 2` really is safe
+        std::atomic_thread_fence(std::memory_order_seq_cst);
         size_t e = global_epoch_.load(std::memory_order_relaxed);
-        local->retire_bins[e % 3].push_back({
-            ptr, 
-            [](void* p) { delete static_cast<T*>(p); }
-        });
+        size_t bin = e % 3;
+        // A bin still tagged with an epoch 3+ behind is safe: recycle it before reuse
+        if (local->bin_epoch[bin] != e) {
+            free_bin(local, bin);
+            local->bin_epoch[bin] = e;
+        }
+        local->retire_bins[bin].push_back({ptr, [](void* p) { delete static_cast<T*>(p); }});
+        local->pending.store(local->pending.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        retired_.fetch_add(1, std::memory_order_relaxed);
 
-        local->op_count++;
-        if (local->op_count > 64) { // GC every 64 ops
+        if (++local->op_count > 64 || local->pending.load(std::memory_order_relaxed) > kPendingSoftLimit) {
             local->op_count = 0;
-            try_advance(local);
+            collect(local);
         }
     }
-private:
-    std::atomic<size_t> global_epoch_{0};
-    std::list<std::unique_ptr<LocalState>> threads_;
-    std::mutex mtx_;
 
-    void try_advance(LocalState* trigger_local) {
-        size_t global = global_epoch_.load(std::memory_order_acquire);
+    // Try to advance the epoch, then free this thread's bins that became safe. Cheap when there is
+    // nothing to free; Workers call it before parking so retired garbage can't wait for the next
+    // retire on an idle thread.
+    void collect(LocalState* local) {
+        if (local->pending.load(std::memory_order_relaxed) == 0) return;
+        advance();
+        size_t g = global_epoch_.load(std::memory_order_acquire);
+        for (size_t bin = 0; bin < 3; ++bin) {
+            if (!local->retire_bins[bin].empty() && local->bin_epoch[bin] + 2 <= g) free_bin(local, bin);
+        }
+    }
 
-        // Check if all active threads caught up to current Epoch
-        std::lock_guard<std::mutex> lock(mtx_);
-        for (auto& t : threads_) {
-            if (t->active.load(std::memory_order_relaxed) &&
-                t->epoch.load(std::memory_order_relaxed) != global) {
-                return; // Threads lagging; cannot advance
-                }
+    EbrStats stats() const {
+        EbrStats s;
+        size_t hw = high_water_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < hw; ++i) {
+            if (!slots_[i].in_use.load(std::memory_order_acquire)) continue;
+            ++s.threads;
+            s.pending += slots_[i].pending.load(std::memory_order_relaxed);
         }
+        s.pending += orphan_count_.load(std::memory_order_relaxed);
+        s.retired = retired_.load(std::memory_order_relaxed);
+        s.freed = freed_.load(std::memory_order_relaxed);
+        s.advances = global_epoch_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    ~EbrManager() {
+        // Static destruction: every thread is gone, everything is safe
+        size_t hw = high_water_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < hw; ++i) {
+            for (size_t bin = 0; bin < 3; ++bin) free_bin(&slots_[i], bin);
+        }
+        free_orphans(~size_t(0));
+    }
 
-        // Advance (Epoch)
-        size_t next = global + 1;
-        global_epoch_.store(next, std::memory_order_release);
+private:
+    struct Orphan {
+        std::vector<Node> nodes;
+        size_t epoch;
+        Orphan* next;
+    };
 
-        // Clean old gens: (Global-2) is safe
-        // 3-bucket cycle: (next+1)%3 = oldest bucket
-        size_t safe_bin_idx = (next + 1) % 3;
+    LocalState slots_[kMaxThreads];
+    alignas(64) std::atomic<size_t> global_epoch_{0};
+    std::atomic<size_t> high_water_{0}; // Slots [0, high_water_) have been used
+    alignas(64) std::atomic<Orphan*> orphans_{nullptr};
+    std::atomic<size_t> orphan_count_{0};
+    std::atomic<size_t> retired_{0}, freed_{0};
 
-        // Simplified: trigger cleans its own bucket
-        // Prod: each thread cleans own bucket or use global cleanup list
-        for (auto& t : threads_) {
-            auto& bin = t->retire_bins[safe_bin_idx];
-            for (auto& node : bin) {
-                node.deleter(node.ptr);
+    // Lock-free: scan the registry, then CAS the epoch forward (a concurrent advancer may win)
+    bool advance() {
+        size_t global = global_epoch_.load(std::memory_order_acquire);
+        size_t hw = high_water_.load(std::memory_order_acquire);
+        // Check if all active threads caught up to current Epoch
+        for (size_t i = 0; i < hw; ++i) {
+            const LocalState& t = slots_[i];
+            if (t.in_use.load(std::memory_order_relaxed) && t.active.load(std::memory_order_seq_cst) &&
+                t.epoch.load(std::memory_order_relaxed) != global) {
+                return false; // Threads lagging; cannot advance
             }
-            bin.clear();
         }
+        if (!global_epoch_.compare_exchange_strong(global, global + 1, std::memory_order_acq_rel)) return true;
+        if (orphans_.load(std::memory_order_relaxed)) free_orphans(global + 1);
+        return true;
     }
 
+    // Owner thread only (or teardown)
+    void free_bin(LocalState* local, size_t bin) {
+        auto& nodes = local->retire_bins[bin];
+        if (nodes.empty()) return;
+        for (auto& node : nodes) node.deleter(node.ptr);
+        local->pending.store(local->pending.load(std::memory_order_relaxed) - nodes.size(), std::memory_order_relaxed);
+        freed_.fetch_add(nodes.size(), std::memory_order_relaxed);
+        nodes.clear();
+    }
+
+    void push_orphan(Orphan* o) {
+        orphan_count_.fetch_add(o->nodes.size(), std::memory_order_relaxed);
+        o->next = orphans_.load(std::memory_order_relaxed);
+        while (!orphans_.compare_exchange_weak(o->next, o, std::memory_order_acq_rel)) {}
+    }
 
+    // Take the whole list, free what is 2 epochs old, put the rest back
+    void free_orphans(size_t global) {
+        Orphan* list = orphans_.exchange(nullptr, std::memory_order_acq_rel);
+        while (list) {
+            Orphan* o = list;
+            list = o->next;
+            if (o->epoch + 2 <= global) {
+                for (auto& node : o->nodes) node.deleter(node.ptr);
+                orphan_count_.fetch_sub(o->nodes.size(), std::memory_order_relaxed);
+                freed_.fetch_add(o->nodes.size(), std::memory_order_relaxed);
+                delete o;
+            } else {
+                orphan_count_.fetch_sub(o->nodes.size(), std::memory_order_relaxed);
+                push_orphan(o);
+            }
+        }
+    }
 };
 
 // RAII guard
@@ -107,4 +220,4 @@ struct EbrGuard {
     EbrManager::LocalState* ls;
     EbrGuard(EbrManager::LocalState* s) : ls(s) { EbrManager::get().enter(ls); }
     ~EbrGuard() { EbrManager::get().exit(ls); }
-};
\ No newline at end of file
+};
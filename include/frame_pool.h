@@ -0,0 +1,84 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "free_list_cache.h"
+
+// Counters of FramePool, summed over all threads. hit rate = pool_hits / (pool_hits + heap_allocs)
+struct FrameStats {
+    uint64_t pool_hits = 0;    // Served from a thread cache or the shared depot
+    uint64_t heap_allocs = 0;  // Pooled size class, but every list was empty: one ::operator new
+    uint64_t oversize = 0;     // Frames bigger than the largest class, never pooled
+    uint64_t depot_puts = 0;   // Batches a thread cache handed back (frames freed far from home)
+    uint64_t depot_gets = 0;   // Batches a thread cache refilled from
+};
+
+// Size-class free lists for coroutine frames (Task::Promise::operator new/delete).
+// Every thread keeps its own lists, so the common allocate/free is a pointer pop/push without
+// atomics. Frames are freed on whichever Worker drops the last reference, which is often not the
+// one that allocated them: a list that grows past its cap moves a batch to a shared depot, and an
+// empty list refills from there before falling back to the heap. Frames are never returned to the
+// heap, so after warm-up a steady workload does no malloc at all.
+class FramePool {
+public:
+    // 64-byte steps up to 1 KiB, then 1 KiB steps up to 16 KiB
+    static constexpr size_t kSmallStep = 64, kSmallMax = 1024;
+    static constexpr size_t kLargeStep = 1024, kLargeMax = 16384;
+    static constexpr size_t kClasses = kSmallMax / kSmallStep + (kLargeMax - kSmallMax) / kLargeStep;
+    static constexpr size_t kCacheBytes = 256 * 1024; // Per class and thread, before spilling
+    static constexpr size_t kMinCached = 16;
+
+    static constexpr size_t class_of(size_t n) {
+        return n <= kSmallMax ? (n + kSmallStep - 1) / kSmallStep - 1
+                              : kSmallMax / kSmallStep + (n - kSmallMax + kLargeStep - 1) / kLargeStep - 1;
+    }
+    static constexpr size_t class_size(size_t c) {
+        return c < kSmallMax / kSmallStep ? (c + 1) * kSmallStep : kSmallMax + (c + 1 - kSmallMax / kSmallStep) * kLargeStep;
+    }
+    static constexpr size_t cache_limit(size_t c) { return std::max(kMinCached, kCacheBytes / class_size(c)); }
+
+    static void* allocate(size_t n) {
+        if (n == 0) n = 1;
+        if (n > kLargeMax) {
+            if (Cache::Local* l = Cache::local()) Cache::count(*l, Traits::kOversize);
+            return ::operator new(n);
+        }
+        size_t c = class_of(n);
+        Cache::Local* l = Cache::local();
+        if (!l) return ::operator new(class_size(c)); // Thread is exiting: plain heap
+        if (void* p = Cache::pop(*l, c)) {
+            Cache::count(*l, Traits::kPoolHits);
+            return p;
+        }
+        Cache::count(*l, Traits::kHeapAllocs);
+        return ::operator new(class_size(c));
+    }
+
+    // `n` must be the size passed to allocate (coroutine frames use sized deallocation)
+    static void deallocate(void* p, size_t n) noexcept {
+        if (!p) return;
+        Cache::Local* l = n <= kLargeMax ? Cache::local() : nullptr;
+        if (!l) {
+            ::operator delete(p);
+            return;
+        }
+        Cache::push(*l, class_of(n == 0 ? 1 : n), p);
+    }
+
+    static FrameStats stats() {
+        Cache::Totals t = Cache::totals();
+        return {t[Traits::kPoolHits], t[Traits::kHeapAllocs], t[Traits::kOversize], t[Traits::kDepotPuts],
+                t[Traits::kDepotGets]};
+    }
+
+private:
+    struct Traits {
+        static constexpr size_t kClasses = FramePool::kClasses;
+        static constexpr size_t cache_limit(size_t c) { return FramePool::cache_limit(c); }
+        enum : size_t { kPoolHits, kHeapAllocs, kOversize, kDepotPuts, kDepotGets, kCounters };
+    };
+    using Cache = FreeListCache<Traits>;
+};
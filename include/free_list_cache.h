@@ -0,0 +1,172 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "spinlock.h"
+
+// Per-thread free lists with a shared depot: the machinery under FramePool and BufferPool.
+// Every thread owns one list per size class, so pop() / push() are pointer moves without atomics.
+// A list that grows past its limit hands half of itself to the depot as one batch, and an empty
+// list takes a batch back before the caller has to go to the heap. Blocks are never freed.
+//
+// Traits supplies the shape of one pool (each Traits type gets its own lists, depot and counters):
+//   kClasses                 number of size classes
+//   cache_limit(c)           blocks a thread keeps in class c before spilling half of them
+//   kCounters                per-thread event counters, bumped with count() and summed by totals()
+//   kDepotPuts, kDepotGets   the counters bumped on a spill / a refill
+template <typename Traits>
+class FreeListCache {
+    struct Block {
+        Block* next;
+    };
+    struct List {
+        Block* head = nullptr;
+        size_t count = 0;
+    };
+    using Batch = List;
+
+public:
+    static constexpr size_t kClasses = Traits::kClasses;
+    using Totals = std::array<uint64_t, Traits::kCounters>;
+
+    // One thread's lists and counters
+    struct Local {
+        List lists[kClasses];
+        std::atomic<uint64_t> counters[Traits::kCounters] = {};
+
+        Local() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.locals.push_back(this);
+        }
+
+        ~Local() {
+            for (size_t c = 0; c < kClasses; ++c) {
+                if (lists[c].count) spill(*this, c, lists[c].count);
+            }
+            Registry& r = registry();
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                add_to(r.retired);
+                r.locals.erase(std::find(r.locals.begin(), r.locals.end(), this));
+            }
+            tls_dead_ = true; // Blocks freed later on this thread (e.g. in static destructors) bypass the lists
+        }
+
+        Local(const Local&) = delete;
+        Local& operator=(const Local&) = delete;
+
+        void add_to(Totals& t) const {
+            for (size_t i = 0; i < Traits::kCounters; ++i) t[i] += counters[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    // This thread's lists, or nullptr once they are gone (thread exit): the caller uses the heap
+    static Local* local() {
+        if (tls_dead_) return nullptr;
+        static thread_local Local l;
+        return &l;
+    }
+
+    // A block of class c from this thread's list, refilled from the depot if it is empty.
+    // nullptr if both are empty.
+    static void* pop(Local& l, size_t c) {
+        List& list = l.lists[c];
+        if (!list.head && !refill(l, c)) return nullptr;
+        Block* b = list.head;
+        list.head = b->next;
+        --list.count;
+        return b;
+    }
+
+    static void push(Local& l, size_t c, void* p) {
+        List& list = l.lists[c];
+        auto* b = static_cast<Block*>(p);
+        b->next = list.head;
+        list.head = b;
+        if (++list.count > Traits::cache_limit(c)) spill(l, c, Traits::cache_limit(c) / 2);
+    }
+
+    // For a block freed on a thread whose lists are gone: straight to the depot, as a batch of one
+    static void park(size_t c, void* p) {
+        auto* b = static_cast<Block*>(p);
+        b->next = nullptr;
+        Depot& d = depot();
+        std::lock_guard<SpinLock> lock(d.lock);
+        d.batches[c].push_back({b, 1});
+    }
+
+    // Owner thread writes, totals() reads: relaxed load + store, no locked RMW on the hot path
+    static void count(Local& l, size_t counter) {
+        std::atomic<uint64_t>& n = l.counters[counter];
+        n.store(n.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Every counter, summed over live and exited threads
+    static Totals totals() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Totals t = r.retired;
+        for (Local* l : r.locals) l->add_to(t);
+        return t;
+    }
+
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Local*> locals;
+        Totals retired{}; // Counters of threads that already exited
+    };
+    struct Depot {
+        SpinLock lock;
+        std::vector<Batch> batches[kClasses];
+    };
+
+    inline static thread_local bool tls_dead_ = false;
+
+    // Never destroyed: blocks may still be freed while other statics are torn down
+    static Registry& registry() {
+        static Registry* r = new Registry();
+        return *r;
+    }
+    static Depot& depot() {
+        static Depot* d = new Depot();
+        return *d;
+    }
+
+    static void spill(Local& l, size_t c, size_t n) {
+        List& list = l.lists[c];
+        Batch batch{list.head, n};
+        Block* last = list.head;
+        for (size_t i = 1; i < n; ++i) last = last->next;
+        list.head = last->next;
+        list.count -= n;
+        last->next = nullptr;
+        Depot& d = depot();
+        {
+            std::lock_guard<SpinLock> lock(d.lock);
+            d.batches[c].push_back(batch);
+        }
+        count(l, Traits::kDepotPuts);
+    }
+
+    static bool refill(Local& l, size_t c) {
+        Depot& d = depot();
+        Batch batch;
+        {
+            std::lock_guard<SpinLock> lock(d.lock);
+            if (d.batches[c].empty()) return false;
+            batch = d.batches[c].back();
+            d.batches[c].pop_back();
+        }
+        l.lists[c] = batch;
+        count(l, Traits::kDepotGets);
+        return true;
+    }
+};
@@ -0,0 +1,347 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include "http_server.h"
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// What a handler fills in; HttpConnection formats the status line and headers around it
+struct HttpResponse {
+    int status = 200;
+    std::string_view content_type = "text/plain";
+    std::string body;          // Owned by the response
+    std::string_view body_ref; // Sent instead of `body` if set: data that outlives the flush (e.g. static), never copied
+    std::string headers;       // Extra header lines, see add_header()
+    bool close = false;        // Close the connection after this response
+
+    void add_header(std::string_view name, std::string_view value) {
+        headers.append(name).append(": ").append(value).append("\r\n");
+    }
+
+    std::string_view payload() const { return body_ref.data() ? body_ref : std::string_view(body); }
+
+    void reset() {
+        status = 200;
+        content_type = "text/plain";
+        body.clear(); // Keeps the capacity for the next request
+        body_ref = {};
+        headers.clear();
+        close = false;
+    }
+};
+
+// Method + path -> handler. A handler returning void runs inline, in the middle of the parse loop;
+// one returning Task is awaited and may suspend (a database call, spawn_blocking, ...).
+//   router.get("/", [](const HttpRequest&, HttpResponse& res) { res.body_ref = "Hello"; });
+//   router.post("/upload/*", [](const HttpRequest& req, HttpResponse& res) -> Task { ... co_return; });
+// A path ending in '*' matches by prefix. The query string is ignored for matching.
+class HttpRouter {
+public:
+    using SyncHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+    using AsyncHandler = std::function<Task(const HttpRequest&, HttpResponse&)>;
+
+    struct Route {
+        std::string method; // Empty: any method
+        std::string path;
+        SyncHandler sync;
+        AsyncHandler async;
+    };
+
+    template <typename F>
+    HttpRouter& route(std::string_view method, std::string_view path, F&& fn) {
+        Route r{std::string(method), std::string(path), {}, {}};
+        if constexpr (std::is_same_v<std::invoke_result_t<F&, const HttpRequest&, HttpResponse&>, Task>) {
+            r.async = std::forward<F>(fn);
+        } else {
+            r.sync = std::forward<F>(fn);
+        }
+        routes_.push_back(std::move(r));
+        return *this;
+    }
+
+    template <typename F>
+    HttpRouter& get(std::string_view path, F&& fn) { return route("GET", path, std::forward<F>(fn)); }
+    template <typename F>
+    HttpRouter& post(std::string_view path, F&& fn) { return route("POST", path, std::forward<F>(fn)); }
+
+    // The first matching route in registration order, or nullptr. `path_known` is set if some route
+    // has the path under another method (405 rather than 404). GET routes answer HEAD too.
+    const Route* find(std::string_view method, std::string_view path, bool& path_known) const {
+        path = path.substr(0, path.find('?'));
+        path_known = false;
+        for (const Route& r : routes_) {
+            std::string_view p = r.path;
+            bool hit = !p.empty() && p.back() == '*' ? path.starts_with(p.substr(0, p.size() - 1)) : path == p;
+            if (!hit) continue;
+            path_known = true;
+            if (r.method.empty() || r.method == method || (method == "HEAD" && r.method == "GET")) return &r;
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<Route> routes_;
+};
+
+struct HttpConnectionOptions {
+    std::chrono::milliseconds idle_timeout{60000}; // Keep-alive: wait for the next request
+    std::chrono::milliseconds read_timeout{10000}; // Wait for the rest of a request that has begun
+    size_t max_header_bytes = 64 * 1024;           // Larger: 431
+    size_t max_body_bytes = 8 * 1024 * 1024;       // Larger: 413
+    size_t flush_bytes = 64 * 1024;                // Batched replies go out early past this (0: one write each)
+};
+
+/**
+ * The HTTP/1.1 connection loop: keep-alive, pipelining, Content-Length and chunked bodies.
+ * Every complete request in the buffer is parsed and answered before the next read, and all of
+ * their replies leave together in one writev(). Use it as the accept callback:
+ *   serve_sharded(sched, "0.0.0.0", 8080, [&](AsyncSocket s) { return HttpConnection::serve(std::move(s), router); });
+ * The router must outlive every connection.
+ */
+class HttpConnection {
+public:
+    static Task serve(AsyncSocket socket, const HttpRouter& router, HttpConnectionOptions options = {}) {
+        HttpConnection c(router, options);
+        while (true) {
+            Step step = c.advance();
+            // Replies so far go out first: a handler that suspends must not hold them back
+            if (c.pending_bytes_ > 0) {
+                if (co_await socket.write_all(c.gather()) < 0) break;
+                c.flushed();
+            }
+            if (step == Step::kAsync) {
+                co_await c.route_->async(c.req_, c.resp_);
+                c.finish_request();
+                continue;
+            }
+            if (step == Step::kClose) break;
+            if (step == Step::kFlush) continue;
+            auto timeout = c.in_.empty() ? options.idle_timeout : options.read_timeout;
+            if (co_await socket.read(c.in_, timeout) <= 0) break; // Peer gone, error or timeout
+        }
+    }
+
+private:
+    enum class Step {
+        kRead,  // A partial request (or none): read more
+        kAsync, // route_ has an async handler for req_
+        kFlush, // Replies piled up past flush_bytes
+        kClose, // The last response is queued
+    };
+
+    // Bodies up to this size are copied behind their header; larger ones get their own iovec
+    static constexpr size_t kCopyBody = 4096;
+
+    // One iovec's worth of output: a range of out_ (ext == nullptr), or memory of its own
+    struct Piece {
+        const char* ext;
+        size_t offset;
+        size_t len;
+    };
+
+    const HttpRouter& router_;
+    const HttpConnectionOptions& options_;
+
+    IoBuffer in_;
+    HttpRequest req_;
+    HttpResponse resp_;
+    const HttpRouter::Route* route_ = nullptr;
+    size_t tried_ = 0;       // Header bytes scanned by a parse that came back -2
+    size_t msg_len_ = 0;     // Bytes of req_ in in_, body included
+    bool keep_ = true;       // req_ allows another request after it
+    bool continued_ = false; // "100 Continue" sent for req_
+    bool closing_ = false;
+
+    // Chunked request body: de-chunked into chunked_ as it arrives; scanned_ raw bytes were fed
+    phr_chunked_decoder decoder_{};
+    std::string chunked_;
+    size_t scanned_ = 0;
+
+    // Replies not yet written
+    std::string out_;
+    std::vector<Piece> pieces_;
+    std::deque<std::string> held_; // Large owned bodies; a deque never moves its elements
+    std::vector<iovec> iov_;
+    size_t pending_bytes_ = 0;
+
+    HttpConnection(const HttpRouter& router, const HttpConnectionOptions& options)
+        : router_(router), options_(options) {
+        reset_body();
+    }
+
+    // Answers every complete request in in_ whose handler runs inline. Stops at a partial request,
+    // at an async handler, when the replies pass flush_bytes, or once the connection is closing.
+    Step advance() {
+        while (!closing_ && !in_.empty()) {
+            if (pending_bytes_ > options_.flush_bytes) return Step::kFlush;
+
+            std::string_view w = in_.front();
+            int hl = HttpParser::parse_request(w.data(), w.size(), req_, tried_);
+            if (hl == -2) {
+                if (in_.grow_front(w.size() + 1)) continue; // The headers go on in the next chunk
+                if (in_.size() > options_.max_header_bytes) return fail(431);
+                tried_ = w.size();
+                return Step::kRead;
+            }
+            if (hl < 0) return fail(400);
+            tried_ = 0;
+
+            size_t total;
+            if (!req_.transfer_encoding.empty()) {
+                // Both headers at once is how requests get smuggled past proxies
+                if (!req_.content_length.empty()) return fail(400);
+                if (!AsciiCase::equals(req_.transfer_encoding, "chunked")) return fail(501);
+                if (w.size() < in_.size()) {
+                    // Every byte after the headers must be in front(); double the run so this stays linear
+                    in_.reserve(in_.size() * 2);
+                    continue;
+                }
+                std::string_view raw = w.substr(hl + scanned_);
+                size_t at = chunked_.size(), n = raw.size();
+                chunked_.append(raw);
+                ssize_t left = phr_decode_chunked(&decoder_, chunked_.data() + at, &n);
+                chunked_.resize(at + n);
+                if (left == -1) return fail(400);
+                if (chunked_.size() > options_.max_body_bytes) return fail(413);
+                if (left == -2) {
+                    scanned_ += raw.size();
+                    expect_continue();
+                    return Step::kRead;
+                }
+                total = w.size() - static_cast<size_t>(left); // The rest belongs to the next request
+                req_.body = chunked_;
+            } else {
+                size_t len = 0;
+                std::string_view cl = req_.content_length;
+                if (!cl.empty()) {
+                    auto [end, ec] = std::from_chars(cl.data(), cl.data() + cl.size(), len);
+                    if (ec != std::errc{} || end != cl.data() + cl.size()) return fail(400);
+                    if (len > options_.max_body_bytes) return fail(413);
+                }
+                total = hl + len;
+                if (w.size() < total) {
+                    if (in_.size() >= total) {
+                        in_.grow_front(total);
+                        continue;
+                    }
+                    in_.reserve(total); // The rest of the body is read straight into place
+                    expect_continue();
+                    return Step::kRead;
+                }
+                req_.body = w.substr(hl, len);
+            }
+
+            msg_len_ = total;
+            keep_ = req_.keep_alive();
+            resp_.reset();
+            bool path_known;
+            route_ = router_.find(req_.method, req_.path, path_known);
+            if (!route_) {
+                resp_.status = path_known ? 405 : 404;
+                resp_.body_ref = HttpServer::reason(resp_.status);
+            } else if (route_->async) {
+                return Step::kAsync;
+            } else {
+                route_->sync(req_, resp_);
+            }
+            finish_request();
+        }
+        return closing_ ? Step::kClose : Step::kRead;
+    }
+
+    void finish_request() {
+        if (!keep_ || resp_.close) closing_ = true;
+        append_response(req_.method == "HEAD");
+        in_.consume(msg_len_);
+        reset_body();
+    }
+
+    void reset_body() {
+        decoder_ = {};
+        decoder_.consume_trailer = 1; // The message ends after the trailer, not at the last chunk
+        chunked_.clear();
+        scanned_ = 0;
+        continued_ = false;
+    }
+
+    // An error reply; the connection closes after it, whatever is left in in_
+    Step fail(int status) {
+        resp_.reset();
+        resp_.status = status;
+        resp_.body_ref = HttpServer::reason(status);
+        closing_ = true;
+        append_response(false);
+        return Step::kClose;
+    }
+
+    // Clients that sent "Expect: 100-continue" wait for a go-ahead before sending the body
+    void expect_continue() {
+        if (continued_ || !AsciiCase::equals(req_.get_header("Expect"), "100-continue")) return;
+        continued_ = true;
+        size_t from = out_.size();
+        out_.append("HTTP/1.1 100 Continue\r\n\r\n");
+        add_out(from);
+    }
+
+    void append_response(bool head) {
+        std::string_view body = resp_.payload();
+        char num[24];
+        size_t from = out_.size();
+        out_.append("HTTP/1.1 ");
+        out_.append(num, std::to_chars(num, num + sizeof(num), resp_.status).ptr);
+        out_.append(" ").append(HttpServer::reason(resp_.status));
+        out_.append("\r\nServer: tiny_coro/1.0\r\nContent-Type: ").append(resp_.content_type);
+        out_.append("\r\nContent-Length: ");
+        out_.append(num, std::to_chars(num, num + sizeof(num), body.size()).ptr);
+        out_.append("\r\n").append(resp_.headers);
+        if (closing_) out_.append("Connection: close\r\n");
+        else if (req_.minor_version == 0) out_.append("Connection: keep-alive\r\n");
+        out_.append("\r\n");
+        if (head || body.empty()) {
+            add_out(from);
+        } else if (body.size() <= kCopyBody) {
+            out_.append(body);
+            add_out(from);
+        } else {
+            add_out(from);
+            if (!resp_.body_ref.data()) {
+                held_.push_back(std::move(resp_.body));
+                body = held_.back();
+            }
+            pieces_.push_back({body.data(), 0, body.size()});
+            pending_bytes_ += body.size();
+        }
+    }
+
+    // out_[from, size()) was just appended: extend the last piece if it ends there
+    void add_out(size_t from) {
+        size_t len = out_.size() - from;
+        if (!pieces_.empty() && !pieces_.back().ext && pieces_.back().offset + pieces_.back().len == from) {
+            pieces_.back().len += len;
+        } else {
+            pieces_.push_back({nullptr, from, len});
+        }
+        pending_bytes_ += len;
+    }
+
+    // out_ has stopped growing until flushed(): its pointers are stable now
+    std::span<iovec> gather() {
+        iov_.clear();
+        for (const Piece& p : pieces_) {
+            const char* base = p.ext ? p.ext : out_.data() + p.offset;
+            iov_.push_back({const_cast<char*>(base), p.len});
+        }
+        return iov_;
+    }
+
+    void flushed() {
+        out_.clear();
+        pieces_.clear();
+        held_.clear();
+        pending_bytes_ = 0;
+    }
+};
@@ -1,37 +1,215 @@
 // Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
 #pragma once
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <string_view>
-#include <vector>
 #include "../picohttpparser/picohttpparser.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Case-insensitive ASCII comparison (header names and tokens like "close"), without a per-character
+// tolower: 16 bytes per step with SSE2 / NEON, 8 bytes per step in a plain register otherwise.
+class AsciiCase {
+public:
+    static bool equals(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        const char *x = a.data(), *y = b.data();
+        size_t n = a.size();
+        if (n >= 16) return equals16(x, y, n);
+        if (n >= 8) return lower8(load8(x)) == lower8(load8(y)) && lower8(load8(x + n - 8)) == lower8(load8(y + n - 8));
+        return lower8(load_short(x, n)) == lower8(load_short(y, n));
+    }
+
+    // Whether a comma-separated header value ("keep-alive, Upgrade") holds `token`
+    static bool has_token(std::string_view list, std::string_view token) {
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            std::string_view item = list.substr(0, comma);
+            while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+            while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+            if (equals(item, token)) return true;
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+private:
+    static uint64_t load8(const char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+
+    // Packs 0..7 bytes into one word; the two 4-byte loads overlap when n < 8
+    static uint64_t load_short(const char* p, size_t n) {
+        if (n >= 4) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + n - 4, 4);
+            return lo | (uint64_t(hi) << 32);
+        }
+        if (n == 0) return 0;
+        return uint64_t(uint8_t(p[0])) | uint64_t(uint8_t(p[n / 2])) << 8 | uint64_t(uint8_t(p[n - 1])) << 16;
+    }
+
+    // Lower-cases the letters among 8 bytes at once; bytes >= 0x80 are left alone
+    static uint64_t lower8(uint64_t x) {
+        constexpr uint64_t k = 0x0101010101010101ull;
+        uint64_t low7 = x & (0x7F * k);         // No carries between bytes below
+        uint64_t ge_a = low7 + (0x80 - 'A') * k; // High bit set where byte >= 'A'
+        uint64_t gt_z = low7 + (0x7F - 'Z') * k; // High bit set where byte > 'Z'
+        uint64_t upper = ge_a & ~gt_z & ~x & (0x80 * k);
+        return x | (upper >> 2);
+    }
+
+    static bool equals16(const char* x, const char* y, size_t n) {
+        size_t i = 0;
+        for (; i + 16 < n; i += 16) {
+            if (!block_equals(x + i, y + i)) return false;
+        }
+        return block_equals(x + n - 16, y + n - 16); // Overlaps the previous block unless n % 16 == 0
+    }
+
+#if defined(__SSE2__)
+    static __m128i lower16(__m128i v) {
+        // 'A'..'Z' become the 26 smallest signed bytes after the shift
+        __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>('A' + 128)));
+        __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
+
+    static bool block_equals(const char* x, const char* y) {
+        __m128i a = lower16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+        __m128i b = lower16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    static uint8x16_t lower16(uint8x16_t v) {
+        uint8x16_t upper = vcleq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(25));
+        return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+    }
+
+    static bool block_equals(const char* x, const char* y) {
+        uint8x16_t a = lower16(vld1q_u8(reinterpret_cast<const uint8_t*>(x)));
+        uint8x16_t b = lower16(vld1q_u8(reinterpret_cast<const uint8_t*>(y)));
+        return vminvq_u8(vceqq_u8(a, b)) == 0xFF;
+    }
+#else
+    static bool block_equals(const char* x, const char* y) {
+        return lower8(load8(x)) == lower8(load8(y)) && lower8(load8(x + 8)) == lower8(load8(y + 8));
+    }
+#endif
+};
 
 struct HttpRequest {
-    std::string_view method;
-    std::string_view path;
-    int minor_version;
+    // Requests with more headers are rejected by the parser (-1)
+    static constexpr size_t kMaxHeaders = 32;
 
     struct Header {
-        std::string_view name;
+        std::string_view name;  // Empty for the continuation line of a folded header
         std::string_view value;
     };
-    std::vector<Header> headers;
 
-    // Helper method: quickly get Header value
-    std::string_view get_header(std::string_view name) const {
-        for (const auto& h : headers) {
-            // Simple implementation; it is recommended to handle case insensitivity in production environments
-            if (h.name.size() == name.size()) {
-                bool match = true;
-                for (size_t i = 0; i < name.size(); ++i) {
-                    if (std::tolower(h.name[i]) != std::tolower(name[i])) {
-                        match = false;
-                        break;
-                    }
-                }
-                if (match) return h.value;
+    // The headers in arrival order. picohttpparser writes straight into this inline array, so a
+    // request costs no allocation and no copy; Header views are made on access.
+    class HeaderList {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Header;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Header;
+
+            iterator() = default;
+            explicit iterator(const phr_header* p) : p_(p) {}
+            Header operator*() const { return make(*p_); }
+            iterator& operator++() {
+                ++p_;
+                return *this;
             }
+            iterator operator++(int) { return iterator(p_++); }
+            bool operator==(const iterator&) const = default;
+
+        private:
+            const phr_header* p_ = nullptr;
+        };
+
+        size_t size() const { return count_; }
+        bool empty() const { return count_ == 0; }
+        Header operator[](size_t i) const { return make(raw_[i]); }
+        iterator begin() const { return iterator(raw_); }
+        iterator end() const { return iterator(raw_ + count_); }
+
+    private:
+        friend struct HttpRequest;
+        friend class HttpParser;
+
+        static Header make(const phr_header& h) { return {{h.name, h.name_len}, {h.value, h.value_len}}; }
+
+        phr_header raw_[kMaxHeaders];
+        size_t count_ = 0;
+    };
+
+    std::string_view method;
+    std::string_view path;
+    int minor_version;
+    HeaderList headers;
+
+    // Indexed while parsing (first occurrence wins, as in get_header); empty if absent
+    std::string_view host;
+    std::string_view connection;
+    std::string_view content_length;
+    std::string_view transfer_encoding;
+
+    // The whole body, once HttpConnection has it (de-chunked if need be); the parser leaves it empty
+    std::string_view body;
+
+    // Helper method: get a Header value by name (case-insensitive); empty if absent
+    std::string_view get_header(std::string_view name) const {
+        for (Header h : headers) {
+            if (AsciiCase::equals(h.name, name)) return h.value;
         }
         return "";
     }
+
+    // HTTP/1.1 keeps the connection open unless "Connection: close"; HTTP/1.0 only on "keep-alive"
+    bool keep_alive() const {
+        if (minor_version >= 1) return !AsciiCase::has_token(connection, "close");
+        return AsciiCase::has_token(connection, "keep-alive");
+    }
+
+private:
+    friend class HttpParser;
+
+    void index_headers() {
+        host = connection = content_length = transfer_encoding = {};
+        // Backwards, so that the first of duplicate headers is the one left standing
+        for (size_t i = headers.count_; i-- > 0;) {
+            const phr_header& h = headers.raw_[i];
+            std::string_view name{h.name, h.name_len}, value{h.value, h.value_len};
+            switch (h.name_len) { // Only names of a matching length are compared at all
+            case 4:
+                if (AsciiCase::equals(name, "Host")) host = value;
+                break;
+            case 10:
+                if (AsciiCase::equals(name, "Connection")) connection = value;
+                break;
+            case 14:
+                if (AsciiCase::equals(name, "Content-Length")) content_length = value;
+                break;
+            case 17:
+                if (AsciiCase::equals(name, "Transfer-Encoding")) transfer_encoding = value;
+                break;
+            }
+        }
+    }
 };
 
 class HttpParser {
@@ -42,30 +220,29 @@ public:
       * > 0: Parsing succeeded, returns the total length (bytes) of the request header
       * -1: Parsing error
       * -2: Incomplete data (need to read more)
+      * After a -2, pass the length that was tried as `last_len` once more bytes are in: the scan for
+      * the end of the headers then resumes near where it stopped instead of starting over.
+      * Unless it succeeds, `req` is left without headers.
       */
-    static int parse_request(const char* buf, size_t len, HttpRequest& req) {
+    static int parse_request(const char* buf, size_t len, HttpRequest& req, size_t last_len = 0) {
         const char *method_ptr, *path_ptr;
         size_t method_len, path_len;
         int minor_version;
-        struct phr_header headers[32]; // Supports up to 32 Headers
-        size_t num_headers = 32;
+        size_t num_headers = HttpRequest::kMaxHeaders;
 
         int ret = phr_parse_request(buf, len, &method_ptr, &method_len, &path_ptr, &path_len,
-                                    &minor_version, headers, &num_headers, 0);
+                                    &minor_version, req.headers.raw_, &num_headers, last_len);
 
         if (ret > 0) {
             req.method = {method_ptr, method_len};
             req.path = {path_ptr, path_len};
             req.minor_version = minor_version;
-            req.headers.clear();
-            req.headers.reserve(num_headers);
-            for (size_t i = 0; i < num_headers; ++i) {
-                req.headers.push_back({
-                    {headers[i].name, headers[i].name_len},
-                    {headers[i].value, headers[i].value_len}
-                });
-            }
+            req.headers.count_ = num_headers;
+        } else {
+            req.headers.count_ = 0;
         }
+        req.body = {};
+        req.index_headers();
         return ret;
     }
-};
\ No newline at end of file
+};
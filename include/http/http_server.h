@@ -2,70 +2,272 @@
 #pragma once
 #include "../socket.h"
 #include "http_parser.h"
-#include <fstream>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <string>
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 
 class HttpServer {
+    friend class HttpConnection; // Shares reason()
+
     AsyncSocket& socket_;
+    // Status line and headers are formatted here: no std::string temporaries per response
+    static constexpr size_t kHeaderCap = 512;
+    char header_[kHeaderCap];
+
+    static std::string_view reason(int code) {
+        switch (code) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        default: return "Error";
+        }
+    }
+
+    struct HeaderWriter {
+        char* p;
+        char* end;
+        void put(std::string_view s) {
+            size_t n = std::min<size_t>(s.size(), end - p);
+            if (n) std::memcpy(p, s.data(), n); // Empty views may carry a null data()
+            p += n;
+        }
+        void put(size_t v) {
+            p = std::to_chars(p, end, v).ptr;
+        }
+    };
+
+    // Status line and headers into header_; `extra` is inserted verbatim (complete "Name: v\r\n" lines)
+    size_t format_header(int code, std::string_view content_type, size_t content_length, std::string_view extra = {}) {
+        if (content_type.size() > kHeaderCap / 4) content_type = "application/octet-stream";
+        if (extra.size() > kHeaderCap / 4) extra = {};
+
+        HeaderWriter w{header_, header_ + kHeaderCap};
+        w.put("HTTP/1.1 ");
+        w.put(static_cast<size_t>(code));
+        w.put(" ");
+        w.put(reason(code));
+        w.put("\r\nServer: tiny_coro/1.0\r\nContent-Type: ");
+        w.put(content_type);
+        w.put("\r\nContent-Length: ");
+        w.put(content_length);
+        w.put("\r\n");
+        w.put(extra);
+        w.put("Connection: keep-alive\r\n\r\n");
+        return w.p - header_;
+    }
+
+    static std::string_view mime_type(std::string_view path) {
+        size_t dot = path.rfind('.');
+        std::string_view ext = dot == std::string_view::npos ? std::string_view{} : path.substr(dot + 1);
+        if (ext == "html" || ext == "htm") return "text/html";
+        if (ext == "css") return "text/css";
+        if (ext == "js") return "application/javascript";
+        if (ext == "json") return "application/json";
+        if (ext == "txt") return "text/plain";
+        if (ext == "png") return "image/png";
+        if (ext == "jpg" || ext == "jpeg") return "image/jpeg";
+        if (ext == "gif") return "image/gif";
+        if (ext == "svg") return "image/svg+xml";
+        if (ext == "wasm") return "application/wasm";
+        return "application/octet-stream";
+    }
+
+    // Regular files do not do EAGAIN: loop only on short writes and EINTR
+    static bool write_file(int fd, const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t w = ::write(fd, p, n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            p += w;
+            n -= w;
+        }
+        return true;
+    }
+
+    // Upload chunk: the default pipe capacity, and the unit of one trip to the blocking pool
+    static constexpr size_t kUploadChunk = 64 * 1024;
+
+    // Disk calls leave the Worker (Scheduler::spawn_blocking): a slow disk must not stall every
+    // connection queued behind this one. Handlers always run on a Worker.
+    template <typename F>
+    static auto on_disk(F fn) {
+        return Worker::current()->scheduler().spawn_blocking(std::move(fn));
+    }
 
 public:
     explicit HttpServer(AsyncSocket& s) : socket_(s) {}
 
     /**
      * Send response
-     * Automatically construct the HTTP message header and send the Body
+     * Header and Body leave in one gathered writev(); short writes are continued until all is sent
      */
     Task send_response(int code, std::string_view content_type, std::string_view body) {
-        std::string res;
-        res.reserve(256 + body.size());
-
-        res += "HTTP/1.1 " + std::to_string(code);
-        res += (code == 200 ? " OK\r\n" : " Error\r\n");
-        res += "Server: tiny_coro/1.0\r\n";
-        res += "Content-Type: " + std::string(content_type) + "\r\n";
-        res += "Content-Length: " + std::to_string(body.size()) + "\r\n";
-        res += "Connection: keep-alive\r\n\r\n";
-
-        // Send Header first
-        co_await socket_.write(res);
-        // Then send the Body
-        if (!body.empty()) {
-            co_await socket_.write(body.data(), body.size());
+        iovec iov[2] = {
+            {header_, format_header(code, content_type, body.size())},
+            {const_cast<char*>(body.data()), body.size()},
+        };
+        co_await socket_.write_all(std::span<iovec>(iov, body.empty() ? 1 : 2));
+    }
+
+    /**
+     * Static file download
+     * `len` bytes from `offset` (default: the rest of the file) go from the page cache to the socket
+     * via sendfile(2), never through user space. A sub-range is answered with 206 + Content-Range,
+     * an empty range (len == 0) or one starting at or past the end with 416. open / fstat run on the
+     * blocking pool.
+     * The Content-Type is guessed from the extension unless given.
+     */
+    Task send_file(std::string_view path, off_t offset = 0, size_t len = SIZE_MAX, std::string_view content_type = {}) {
+        // open + fstat are disk calls too (a cold directory lookup can block): run them off the Worker
+        std::string file(path);
+        struct stat st;
+        int fd = co_await on_disk([&] {
+            int f = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+            if (f >= 0 && (::fstat(f, &st) < 0 || !S_ISREG(st.st_mode))) {
+                ::close(f);
+                f = -1;
+            }
+            return f;
+        });
+        if (fd < 0) {
+            static constexpr std::string_view kNotFound = "Not Found";
+            iovec iov[2] = {
+                {header_, format_header(404, "text/plain", kNotFound.size())},
+                {const_cast<char*>(kNotFound.data()), kNotFound.size()},
+            };
+            co_await socket_.write_all(iov);
+            co_return;
+        }
+        // A range that is empty or starts at or past the end names no byte: 416 with the size, as
+        // RFC 9110 asks (an empty file still gets its 200 for the whole, empty, body)
+        bool no_byte = st.st_size > 0 && (len == 0 || offset == st.st_size);
+        if (offset < 0 || offset > st.st_size || no_byte) {
+            ::close(fd);
+            char range[64];
+            HeaderWriter r{range, range + sizeof(range)};
+            r.put("Content-Range: bytes */");
+            r.put(static_cast<size_t>(st.st_size));
+            r.put("\r\n");
+            co_await socket_.write_all(header_, format_header(416, "text/plain", 0, {range, static_cast<size_t>(r.p - range)}));
+            co_return;
         }
+
+        size_t size = static_cast<size_t>(st.st_size);
+        size_t count = std::min(len, size - static_cast<size_t>(offset));
+        if (content_type.empty()) content_type = mime_type(path);
+
+        size_t n;
+        if (offset == 0 && count == size) {
+            n = format_header(200, content_type, count);
+        } else {
+            char range[96];
+            HeaderWriter r{range, range + sizeof(range)};
+            r.put("Content-Range: bytes ");
+            r.put(static_cast<size_t>(offset));
+            r.put("-");
+            r.put(static_cast<size_t>(offset) + count - 1); // count >= 1: empty ranges got their 416
+            r.put("/");
+            r.put(size);
+            r.put("\r\n");
+            n = format_header(206, content_type, count, {range, static_cast<size_t>(r.p - range)});
+        }
+
+        if (co_await socket_.write_all(header_, n) >= 0) {
+            while (count > 0) {
+                ssize_t sent = co_await socket_.sendfile(fd, offset, count);
+                if (sent <= 0) break; // Peer gone, or the file shrank underneath us
+                offset += sent;
+                count -= sent;
+            }
+        }
+        ::close(fd);
     }
 
     /**
      * Stream file upload
-     * Advantage: Regardless of file size, only a fixed buf memory (8KB) is occupied, and data is pumped directly to disk via coroutines
+     * On Linux the Body goes socket -> pipe -> file with splice(2): it never enters user space, and
+     * the coroutine only suspends on the socket. Elsewhere (or while io_uring multishot recv owns
+     * the socket) it is pumped through a fixed 64KB buffer. Either way memory use is constant.
+     * Every disk call runs on the Scheduler's blocking pool, one trip per 64KB chunk.
      */
     Task receive_to_file(std::string_view save_path, size_t content_length, std::string_view initial_data = "") {
-        std::ofstream file(std::string(save_path).c_str(), std::ios::binary);
-        if (!file.is_open()) {
+        // 1. Create the file and write the Body bytes that arrived with the headers, in one trip
+        std::string path(save_path);
+        size_t first = std::min(initial_data.size(), content_length);
+        int fd = co_await on_disk([&] {
+            int f = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (f >= 0 && !write_file(f, initial_data.data(), first)) {
+                ::close(f);
+                f = -1;
+            }
+            return f;
+        });
+        if (fd < 0) {
             co_return;
         }
 
-        size_t total_received = 0;
+        size_t total_received = first;
 
-        // 1. Process the Body data that has been read into the buffer during the first read
-        if (!initial_data.empty()) {
-            size_t to_write = std::min(initial_data.size(), content_length);
-            file.write(initial_data.data(), to_write);
-            total_received += to_write;
+#ifdef __linux__
+        // 2. Splice the rest. The pipe is drained into the file after every chunk, so it always has
+        // room and splice_to() can only report EAGAIN for an empty socket.
+        int pipefd[2];
+        if (!socket_.recv_streamed() && ::pipe2(pipefd, O_CLOEXEC) == 0) {
+            while (total_received < content_length) {
+                ssize_t n = co_await socket_.splice_to(pipefd[1], std::min(kUploadChunk, content_length - total_received));
+                if (n <= 0) break; // Connection interrupted
+
+                bool drained = co_await on_disk([&] {
+                    ssize_t left = n;
+                    while (left > 0) {
+                        ssize_t m = ::splice(pipefd[0], nullptr, fd, nullptr, left, SPLICE_F_MOVE);
+                        if (m < 0 && errno == EINTR) continue;
+                        if (m <= 0) break;
+                        left -= m;
+                    }
+                    return left == 0;
+                });
+                if (!drained) break; // Disk full / IO error
+                total_received += n;
+            }
+            ::close(pipefd[0]);
+            ::close(pipefd[1]);
+            ::close(fd);
+            co_return;
         }
+#endif
 
-        // 2. Loop to read the remaining data
-        char buf[8192];
+        // 3. Fill a chunk from the socket, then hand it to the disk in one go
+        std::unique_ptr<char[]> buf(new char[kUploadChunk]);
         while (total_received < content_length) {
-            size_t to_read = std::min(sizeof(buf), content_length - total_received);
-            ssize_t n = co_await socket_.read(buf, to_read);
-
-            if (n <= 0) break; // Connection interrupted
-
-            file.write(buf, n);
-            total_received += n;
+            size_t want = std::min(kUploadChunk, content_length - total_received);
+            size_t got = 0;
+            while (got < want) {
+                ssize_t n = co_await socket_.read(buf.get() + got, want - got);
+                if (n <= 0) break; // Connection interrupted
+                got += n;
+            }
+            if (got == 0) break;
+            bool written = co_await on_disk([&] { return write_file(fd, buf.get(), got); });
+            if (!written) break;
+            total_received += got;
+            if (got < want) break;
         }
 
-        file.close();
+        ::close(fd);
     }
 };
\ No newline at end of file
@@ -0,0 +1,280 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <sys/uio.h>
+#include <utility>
+
+#include "free_list_cache.h"
+
+// Counters of BufferPool, summed over all threads
+struct BufferStats {
+    uint64_t in_use = 0;       // Chunks held by IoBuffers right now
+    uint64_t pool_hits = 0;    // Served from a thread cache or the shared depot
+    uint64_t slab_allocs = 0;  // Every list was empty: one ::operator new for kSlabChunks chunks
+    uint64_t large_allocs = 0; // One message bigger than a chunk, straight from the heap
+    uint64_t depot_puts = 0;   // Batches a thread cache handed back
+    uint64_t depot_gets = 0;   // Batches a thread cache refilled from
+};
+
+// Fixed-size chunks for IoBuffer, on the same FreeListCache as FramePool with a single class: a
+// free list per thread, a shared depot for chunks freed far from where they were taken, and
+// memory that is never handed back to the heap. When the list and the depot are both empty, a new
+// slab of kSlabChunks chunks is carved.
+class BufferPool {
+public:
+    static constexpr size_t kChunkSize = 16 * 1024;
+    static constexpr size_t kSlabChunks = 16;
+    static constexpr size_t kCacheChunks = 64; // Per thread (1 MiB) before spilling half
+
+    static void* allocate() {
+        Cache::Local* l = Cache::local();
+        if (!l) return ::operator new(kChunkSize); // Thread is exiting: plain heap
+        Cache::count(*l, Traits::kAcquired);
+        if (void* p = Cache::pop(*l, 0)) {
+            Cache::count(*l, Traits::kPoolHits);
+            return p;
+        }
+        Cache::count(*l, Traits::kSlabAllocs);
+        char* slab = static_cast<char*>(::operator new(kChunkSize * kSlabChunks));
+        for (size_t i = 1; i < kSlabChunks; ++i) Cache::push(*l, 0, slab + i * kChunkSize);
+        return slab;
+    }
+
+    static void deallocate(void* p) noexcept {
+        Cache::Local* l = Cache::local();
+        if (!l) {
+            // Slab memory cannot go back to the heap piece by piece: park it in the depot
+            Cache::park(0, p);
+            return;
+        }
+        Cache::count(*l, Traits::kReleased);
+        Cache::push(*l, 0, p);
+    }
+
+    // Counted only: large chunks come from and go back to the heap
+    static void note_large() {
+        if (Cache::Local* l = Cache::local()) Cache::count(*l, Traits::kLargeAllocs);
+    }
+
+    static BufferStats stats() {
+        // A chunk is often released on another thread than the one that took it: in_use is only
+        // meaningful summed over all of them
+        Cache::Totals t = Cache::totals();
+        return {t[Traits::kAcquired] - t[Traits::kReleased], t[Traits::kPoolHits], t[Traits::kSlabAllocs],
+                t[Traits::kLargeAllocs], t[Traits::kDepotPuts], t[Traits::kDepotGets]};
+    }
+
+private:
+    struct Traits {
+        static constexpr size_t kClasses = 1;
+        static constexpr size_t cache_limit(size_t) { return kCacheChunks; }
+        enum : size_t { kAcquired, kReleased, kPoolHits, kSlabAllocs, kLargeAllocs, kDepotPuts, kDepotGets, kCounters };
+    };
+    using Cache = FreeListCache<Traits>;
+};
+
+// Byte queue over a chain of BufferPool chunks: received bytes are appended at the tail and
+// parsed / consumed from the head. A chunk goes back to the pool as soon as its last byte is
+// consumed, so a connection whose buffer is drained holds no memory at all while it waits
+// (AsyncSocket::read(IoBuffer&) only takes a chunk once the socket has bytes to give).
+// Parsers want contiguous bytes: front() is the first chunk's run, grow_front() / reserve()
+// move bytes so that a message straddling chunks becomes one run. A message bigger than a chunk
+// gets one chunk of its own from the heap.
+class IoBuffer {
+    struct Chunk {
+        Chunk* next;
+        uint32_t head; // Readable bytes are [head, tail) of data()
+        uint32_t tail;
+        uint32_t cap;
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+public:
+    // Usable bytes of one pooled chunk
+    static constexpr size_t kChunkCapacity = BufferPool::kChunkSize - sizeof(Chunk);
+    // prepare() opens a new chunk rather than read fewer bytes than this into the current one
+    static constexpr size_t kMinRead = 2048;
+
+    IoBuffer() = default;
+    IoBuffer(IoBuffer&& o) noexcept
+        : head_(std::exchange(o.head_, nullptr)), tail_(std::exchange(o.tail_, nullptr)),
+          size_(std::exchange(o.size_, 0)) {}
+    IoBuffer& operator=(IoBuffer&& o) noexcept {
+        if (this != &o) {
+            clear();
+            head_ = std::exchange(o.head_, nullptr);
+            tail_ = std::exchange(o.tail_, nullptr);
+            size_ = std::exchange(o.size_, 0);
+        }
+        return *this;
+    }
+    IoBuffer(const IoBuffer&) = delete;
+    IoBuffer& operator=(const IoBuffer&) = delete;
+    ~IoBuffer() { clear(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // Chunks held, readable or not
+    size_t chunks() const {
+        size_t n = 0;
+        for (Chunk* c = head_; c; c = c->next) ++n;
+        return n;
+    }
+
+    // The readable bytes of the first chunk: all of size() unless the data straddles chunks
+    std::string_view front() const {
+        if (!head_) return {};
+        return {head_->data() + head_->head, head_->tail - head_->head};
+    }
+
+    // Make front() at least `n` bytes long (or all of size(), if that is less) by pulling bytes
+    // out of the following chunks. Returns false if front() was already that long: more bytes have
+    // to be received first.
+    bool grow_front(size_t n) {
+        n = std::min(n, size_);
+        if (front().size() >= n) return false;
+        make_contiguous(n, 0);
+        return true;
+    }
+
+    // Make room for a message of `total` bytes in one run: front() will hold every readable byte,
+    // with room after it for the rest. For parsers that know a message's length up front.
+    void reserve(size_t total) {
+        total = std::max(total, size_);
+        if (head_ && head_ == tail_ && head_->cap - head_->head >= total) return;
+        make_contiguous(size_, total - size_);
+    }
+
+    void consume(size_t n) {
+        size_ -= n;
+        while (n > 0) {
+            size_t take = std::min<size_t>(n, head_->tail - head_->head);
+            head_->head += take;
+            n -= take;
+            if (head_->head == head_->tail) pop_front();
+        }
+    }
+
+    // Room for at least `min` bytes at the tail, taking a chunk if needed; fill it, then commit()
+    std::pair<char*, size_t> prepare(size_t min = kMinRead) {
+        if (!tail_ || tail_->cap - tail_->tail < std::min(min, kChunkCapacity)) {
+            push_back(new_chunk(std::max(min, kChunkCapacity)));
+        }
+        return {tail_->data() + tail_->tail, tail_->cap - tail_->tail};
+    }
+    void commit(size_t n) {
+        tail_->tail += n;
+        size_ += n;
+    }
+
+    void append(const void* p, size_t n) {
+        const char* src = static_cast<const char*>(p);
+        while (n > 0) {
+            auto [dst, room] = prepare(1);
+            size_t take = std::min(n, room);
+            std::memcpy(dst, src, take);
+            commit(take);
+            src += take;
+            n -= take;
+        }
+    }
+    void append(std::string_view s) { append(s.data(), s.size()); }
+
+    // Up to `max` iovecs over the readable bytes, e.g. for writev(); returns how many were filled
+    size_t gather(iovec* out, size_t max) const {
+        size_t n = 0;
+        for (Chunk* c = head_; c && n < max; c = c->next) {
+            if (c->tail > c->head) out[n++] = {c->data() + c->head, c->tail - c->head};
+        }
+        return n;
+    }
+
+    // Give back a tail chunk that holds no bytes (e.g. a read that found nothing): parked
+    // connections should not hold memory
+    void trim() {
+        if (!tail_ || tail_->head != tail_->tail) return;
+        Chunk* prev = nullptr;
+        for (Chunk* c = head_; c != tail_; c = c->next) prev = c;
+        free_chunk(tail_);
+        tail_ = prev;
+        if (prev) prev->next = nullptr;
+        else head_ = nullptr;
+    }
+
+    void clear() {
+        while (head_) pop_front();
+        size_ = 0;
+    }
+
+private:
+    Chunk* head_ = nullptr;
+    Chunk* tail_ = nullptr;
+    size_t size_ = 0;
+
+    static Chunk* new_chunk(size_t cap) {
+        void* p;
+        if (cap <= kChunkCapacity) {
+            cap = kChunkCapacity;
+            p = BufferPool::allocate();
+        } else {
+            cap = (cap + sizeof(Chunk) + 4095) / 4096 * 4096 - sizeof(Chunk);
+            p = ::operator new(cap + sizeof(Chunk));
+            BufferPool::note_large();
+        }
+        return new (p) Chunk{nullptr, 0, 0, static_cast<uint32_t>(cap)};
+    }
+
+    static void free_chunk(Chunk* c) {
+        if (c->cap == kChunkCapacity) BufferPool::deallocate(c);
+        else ::operator delete(c);
+    }
+
+    void push_back(Chunk* c) {
+        if (tail_) tail_->next = c;
+        else head_ = c;
+        tail_ = c;
+    }
+
+    void pop_front() {
+        Chunk* c = head_;
+        head_ = c->next;
+        if (!head_) tail_ = nullptr;
+        free_chunk(c);
+    }
+
+    // The first n readable bytes into one chunk with `room` free bytes after them
+    void make_contiguous(size_t n, size_t room) {
+        Chunk* c = head_;
+        if (!c || c->cap < n + room) {
+            // A new first chunk, big enough
+            c = new_chunk(n + room);
+            c->next = head_;
+            head_ = c;
+            if (!tail_) tail_ = c;
+        } else if (c->cap - c->head < n + room) {
+            // Big enough, but the bytes sit too far back: slide them to the front
+            size_t len = c->tail - c->head;
+            std::memmove(c->data(), c->data() + c->head, len);
+            c->head = 0;
+            c->tail = static_cast<uint32_t>(len);
+        }
+        // Pull from the following chunks until the first one holds n bytes
+        while (c->tail - c->head < n) {
+            Chunk* next = c->next;
+            size_t take = std::min<size_t>(n - (c->tail - c->head), next->tail - next->head);
+            std::memcpy(c->data() + c->tail, next->data() + next->head, take);
+            c->tail += static_cast<uint32_t>(take);
+            next->head += static_cast<uint32_t>(take);
+            if (next->head == next->tail) {
+                c->next = next->next;
+                if (tail_ == next) tail_ = c;
+                free_chunk(next);
+            }
+        }
+    }
+};
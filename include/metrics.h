@@ -0,0 +1,258 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Log-linear histogram in the HdrHistogram layout with 3 significant bits: values below 8 get a
+// bucket each, and every power of two above is split into 8 buckets, so a reported value is at
+// most 12.5% above the true one. 2.5 KB, whatever the range. A plain value: snapshots, merging.
+struct Histogram {
+    static constexpr int kSubBits = 3;
+    static constexpr uint64_t kSub = uint64_t(1) << kSubBits;
+    static constexpr int kMaxExp = 40; // Values of 2^41 and up (37 min in ns) share the last bucket
+    static constexpr size_t kBuckets = (kMaxExp - kSubBits + 2) * kSub;
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    static size_t bucket(uint64_t v) {
+        if (v < kSub) return size_t(v);
+        int e = 63 - __builtin_clzll(v);
+        if (e > kMaxExp) return kBuckets - 1;
+        return size_t(e - kSubBits + 1) * kSub + ((v >> (e - kSubBits)) & (kSub - 1));
+    }
+    // Largest value that lands in bucket i
+    static uint64_t upper(size_t i) {
+        if (i < kSub) return i;
+        int shift = int(i / kSub) - 1;
+        return ((kSub + i % kSub) << shift) + (uint64_t(1) << shift) - 1;
+    }
+
+    void record(uint64_t v) {
+        ++counts[bucket(v)];
+        ++count;
+        sum += v;
+        max = std::max(max, v);
+    }
+
+    void merge(const Histogram& o) {
+        for (size_t i = 0; i < kBuckets; ++i) counts[i] += o.counts[i];
+        count += o.count;
+        sum += o.sum;
+        max = std::max(max, o.max);
+    }
+
+    // q in [0, 1]; the top of the bucket holding the q-th value, capped at max. 0 if empty.
+    uint64_t percentile(double q) const {
+        if (count == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(q * double(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(upper(i), max);
+        }
+        return max;
+    }
+
+    double mean() const { return count ? double(sum) / double(count) : 0.0; }
+};
+
+// The live version: one thread records (relaxed load + store, no read-modify-write), any thread
+// may take a snapshot. A snapshot taken mid-record can be off by that one record.
+class AtomicHistogram {
+public:
+    void record(uint64_t v) {
+        bump(counts_[Histogram::bucket(v)], 1);
+        bump(sum_, v);
+        if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+    }
+
+    Histogram snapshot() const {
+        Histogram h;
+        for (size_t i = 0; i < Histogram::kBuckets; ++i) {
+            h.counts[i] = counts_[i].load(std::memory_order_relaxed);
+            h.count += h.counts[i];
+        }
+        h.sum = sum_.load(std::memory_order_relaxed);
+        h.max = max_.load(std::memory_order_relaxed);
+        return h;
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts_[Histogram::kBuckets] = {};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// One Worker's counters. Only the Worker writes them; the alignment keeps them off the cache lines
+// of its queue state and of the next Worker, so a stats() reader or a thief never bounces them.
+struct alignas(64) WorkerMetrics {
+    using Counter = std::atomic<uint64_t>;
+    Counter local_pops{0}, global_pops{0}, steals{0}, steal_failures{0};
+    Counter parks{0}, wakeups{0}, spurious{0}, spin_hits{0}, spin_misses{0}, yields{0};
+    AtomicHistogram schedule_latency; // ns from runnable to resumed, sampled
+    AtomicHistogram poll_batch;       // Events per non-empty Poller wait (multi-reactor mode)
+
+    static void bump(Counter& c) { c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+};
+
+// The Reactor thread's counters (single writer, as above)
+struct alignas(64) ReactorMetrics {
+    std::atomic<uint64_t> waits{0};        // Poller waits, including timeouts
+    std::atomic<uint64_t> timers_fired{0};
+    AtomicHistogram batch;                 // Events per non-empty wait
+
+    static void bump(std::atomic<uint64_t>& c, uint64_t n = 1) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+struct WorkerStats {
+    uint64_t tasks = 0;            // Tasks resumed: local_pops + global_pops + steals
+    uint64_t local_pops = 0;       // ... taken from the run_next_ slot or the local queue
+    uint64_t global_pops = 0;      // ... taken from the global queue (fairness tick or batch)
+    uint64_t steals = 0;           // Steal rounds that found work
+    uint64_t steal_failures = 0;   // Steal rounds that found none
+    uint64_t parks = 0;
+    uint64_t wakeups = 0;
+    uint64_t spurious_wakeups = 0;
+    uint64_t spin_hits = 0;
+    uint64_t spin_misses = 0;
+    uint64_t yields = 0;
+    size_t local_queue = 0;        // Tasks in the local queue right now (approximate)
+    bool idle = false;             // In the idle set right now
+    Histogram schedule_latency;    // ns, see SchedulerOptions::latency_sample_every
+    Histogram poll_batch;          // Events per non-empty Poller wait (multi-reactor mode)
+};
+
+// Scheduler::stats(): totals over the Workers, point-in-time gauges, and each Worker on its own
+struct SchedulerStats {
+    uint64_t tasks = 0;            // Sums of the WorkerStats fields of the same name
+    uint64_t local_pops = 0;
+    uint64_t global_pops = 0;
+    uint64_t steals = 0;
+    uint64_t steal_failures = 0;
+    uint64_t parks = 0;            // Times a Worker went to sleep
+    uint64_t wakeups = 0;          // Sleeps ended by a wake-up from the idle set
+    uint64_t spurious_wakeups = 0; // Sleeps that ended without one (stale notification, stop)
+    uint64_t spin_hits = 0;        // Spin phases that found work
+    uint64_t spin_misses = 0;      // Spin phases that gave up and parked
+    uint64_t yields = 0;           // Tasks requeued by yield_now() or a spent CoopBudget
+    size_t idle = 0;               // Workers in the idle set right now
+    size_t spinning = 0;           // Workers searching for work right now
+    size_t global_queue = 0;       // Tasks in the global queue right now (approximate)
+    size_t local_queued = 0;       // Tasks in all local queues right now (approximate)
+    size_t blocking_threads = 0;   // spawn_blocking() threads alive right now
+    size_t blocking_queued = 0;    // spawn_blocking() calls waiting for a thread
+    size_t timers = 0;             // Timers pending on the Reactor
+    uint64_t timers_fired = 0;
+    uint64_t reactor_waits = 0;    // Reactor Poller waits, including timeouts
+    Histogram reactor_batch;       // Events per non-empty Reactor wait
+    Histogram schedule_latency;    // All Workers' samples, merged
+    Histogram poll_batch;          // All Workers' Poller waits, merged
+    std::vector<WorkerStats> workers;
+
+    // Prometheus text exposition format (version 0.0.4): counters and gauges, per-Worker series
+    // labelled worker="i", latencies in seconds as summaries
+    std::string prometheus(std::string_view prefix = "tinycoro") const {
+        std::string out;
+        char line[256];
+        auto header = [&](const char* name, const char* type, const char* help) {
+            std::snprintf(line, sizeof(line), "# HELP %.*s_%s %s\n# TYPE %.*s_%s %s\n", int(prefix.size()),
+                          prefix.data(), name, help, int(prefix.size()), prefix.data(), name, type);
+            out += line;
+        };
+        // Counters and gauges are exact integers: a double keeps 15-17 digits, and "%.9g" only 9,
+        // which would freeze a busy counter past 1e9 and break rate()
+        auto value = [&](const char* name, const char* labels, uint64_t v) {
+            std::snprintf(line, sizeof(line), "%.*s_%s%s %" PRIu64 "\n", int(prefix.size()), prefix.data(), name,
+                          labels, v);
+            out += line;
+        };
+        auto seconds = [&](const char* name, const char* labels, double v) {
+            std::snprintf(line, sizeof(line), "%.*s_%s%s %.17g\n", int(prefix.size()), prefix.data(), name, labels, v);
+            out += line;
+        };
+        auto gauge = [&](const char* name, const char* help, uint64_t v) {
+            header(name, "gauge", help);
+            value(name, "", v);
+        };
+        auto counter = [&](const char* name, const char* help, uint64_t v) {
+            header(name, "counter", help);
+            value(name, "", v);
+        };
+        auto per_worker = [&](const char* name, const char* type, const char* help, auto field) {
+            header(name, type, help);
+            char labels[32];
+            for (size_t i = 0; i < workers.size(); ++i) {
+                std::snprintf(labels, sizeof(labels), "{worker=\"%zu\"}", i);
+                value(name, labels, uint64_t(field(workers[i])));
+            }
+        };
+        // Latencies (ns) are reported in seconds, the Prometheus base unit; counts stay integers
+        auto summary = [&](const char* name, const char* help, const Histogram& h, bool ns_to_seconds) {
+            header(name, "summary", help);
+            std::string base(name);
+            for (double q : {0.5, 0.9, 0.99, 0.999}) {
+                char labels[32];
+                std::snprintf(labels, sizeof(labels), "{quantile=\"%g\"}", q);
+                if (ns_to_seconds) seconds(name, labels, double(h.percentile(q)) * 1e-9);
+                else value(name, labels, h.percentile(q));
+            }
+            if (ns_to_seconds) seconds((base + "_sum").c_str(), "", double(h.sum) * 1e-9);
+            else value((base + "_sum").c_str(), "", h.sum);
+            value((base + "_count").c_str(), "", h.count);
+        };
+
+        per_worker("worker_tasks_total", "counter", "Tasks resumed",
+                   [](const WorkerStats& w) { return w.tasks; });
+        per_worker("worker_local_pops_total", "counter", "Tasks taken from the run_next slot or the local queue",
+                   [](const WorkerStats& w) { return w.local_pops; });
+        per_worker("worker_global_pops_total", "counter", "Tasks taken from the global queue",
+                   [](const WorkerStats& w) { return w.global_pops; });
+        per_worker("worker_steals_total", "counter", "Steal rounds that found work",
+                   [](const WorkerStats& w) { return w.steals; });
+        per_worker("worker_steal_failures_total", "counter", "Steal rounds that found none",
+                   [](const WorkerStats& w) { return w.steal_failures; });
+        per_worker("worker_parks_total", "counter", "Times the Worker went to sleep",
+                   [](const WorkerStats& w) { return w.parks; });
+        per_worker("worker_wakeups_total", "counter", "Sleeps ended by a wake-up from the idle set",
+                   [](const WorkerStats& w) { return w.wakeups; });
+        per_worker("worker_spurious_wakeups_total", "counter", "Sleeps that ended without a wake-up",
+                   [](const WorkerStats& w) { return w.spurious_wakeups; });
+        per_worker("worker_spin_hits_total", "counter", "Spin phases that found work",
+                   [](const WorkerStats& w) { return w.spin_hits; });
+        per_worker("worker_spin_misses_total", "counter", "Spin phases that gave up and parked",
+                   [](const WorkerStats& w) { return w.spin_misses; });
+        per_worker("worker_yields_total", "counter", "Tasks requeued by yield_now() or a spent CoopBudget",
+                   [](const WorkerStats& w) { return w.yields; });
+        per_worker("worker_local_queue", "gauge", "Tasks in the local queue",
+                   [](const WorkerStats& w) { return w.local_queue; });
+        gauge("global_queue", "Tasks in the global queue", global_queue);
+        gauge("idle_workers", "Workers in the idle set", idle);
+        gauge("spinning_workers", "Workers searching for work", spinning);
+        gauge("blocking_threads", "spawn_blocking() threads alive", blocking_threads);
+        gauge("blocking_queued", "spawn_blocking() calls waiting for a thread", blocking_queued);
+        gauge("timers", "Timers pending on the Reactor", timers);
+        counter("timers_fired_total", "Timers expired by the Reactor", timers_fired);
+        counter("reactor_waits_total", "Reactor Poller waits, including timeouts", reactor_waits);
+        summary("reactor_batch_events", "Events per non-empty Reactor wait", reactor_batch, false);
+        summary("worker_poll_batch_events", "Events per non-empty Worker Poller wait", poll_batch, false);
+        summary("schedule_latency_seconds", "Time from runnable to resumed (sampled)", schedule_latency, true);
+        return out;
+    }
+};
@@ -20,6 +20,16 @@ public:
         state.store(EMPTY, std::memory_order_release);
     }
 
+    // For owners that block somewhere else (e.g. in their Poller) and only need the handshake:
+    // begin_park() returns false if a notification is already pending; end_park() always follows.
+    bool begin_park() {
+        int expected = EMPTY;
+        return state.compare_exchange_strong(expected, PARKED, std::memory_order_acquire);
+    }
+    void end_park() { state.store(EMPTY, std::memory_order_release); }
+    // Returns true if the owner was parked and must be woken by the caller
+    bool notify() { return state.exchange(NOTIFIED, std::memory_order_release) == PARKED; }
+
     void unpark() {
         // Set to NOTIFIED (ignore current state)
         int old = state.exchange(NOTIFIED, std::memory_order_release);
@@ -33,6 +33,9 @@
 #else
 #include <x86intrin.h>
 #endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PICO_NEON 1
 #endif
 #include "picohttpparser.h"
 
@@ -122,6 +125,33 @@ static const char *findchar_fast(const char *buf, const char *buf_end, const cha
             left -= 16;
         } while (likely(left != 0));
     }
+#elif PICO_NEON
+    /* NEON has no pcmpestri: test the (at most 8) ranges one by one, then turn the byte mask into
+     * 4 bits per byte with a narrowing shift so that the first match is a count of trailing zeros */
+    if (likely(buf_end - buf >= 16)) {
+        uint8x16_t lo[8], hi[8];
+        size_t i, pairs = ranges_size / 2;
+        for (i = 0; i != pairs; ++i) {
+            lo[i] = vdupq_n_u8((unsigned char)ranges[2 * i]);
+            hi[i] = vdupq_n_u8((unsigned char)ranges[2 * i + 1]);
+        }
+
+        size_t left = (buf_end - buf) & ~15;
+        do {
+            uint8x16_t b16 = vld1q_u8((const uint8_t *)buf);
+            uint8x16_t hit = vandq_u8(vcgeq_u8(b16, lo[0]), vcleq_u8(b16, hi[0]));
+            for (i = 1; i != pairs; ++i)
+                hit = vorrq_u8(hit, vandq_u8(vcgeq_u8(b16, lo[i]), vcleq_u8(b16, hi[i])));
+            uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+            if (unlikely(bits != 0)) {
+                buf += __builtin_ctzll(bits) >> 2;
+                *found = 1;
+                break;
+            }
+            buf += 16;
+            left -= 16;
+        } while (likely(left != 0));
+    }
 #else
     /* suppress unused parameter warning */
     (void)buf_end;
@@ -135,7 +165,7 @@ static const char *get_token_to_eol(const char *buf, const char *buf_end, const
 {
     const char *token_start = buf;
 
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) || PICO_NEON
     static const char ALIGNED(16) ranges1[16] = "\0\010"    /* allow HT */
                                                 "\012\037"  /* allow SP and up to but not including DEL */
                                                 "\177\177"; /* allow chars w. MSB set */
@@ -2,9 +2,17 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <stdexcept>
 #include <unistd.h>
 
+// Readiness bits handed to wait() callbacks: callback(void* udata, uint32_t ready)
+enum : uint32_t { kPollReadable = 1, kPollWritable = 2 };
+
+// Which kernel interface the Reactor polls. Auto = io_uring when built with TINYCORO_IO_URING and
+// the running kernel supports it, epoll otherwise (kqueue on macOS / FreeBSD).
+enum class IoBackend { Auto, Epoll, IoUring };
+
 // ==========================================
 // Linux Implementation (epoll)
 // ==========================================
@@ -13,13 +21,17 @@
 #include <sys/eventfd.h>
 #include <cstring> // for memset
 
-class Poller {
+#ifdef TINYCORO_IO_URING
+#include "uring.h"
+#endif
+
+class EpollPoller {
     int epoll_fd_;
     int wake_fd_;
     struct epoll_event events_[128];
 
 public:
-    Poller() {
+    EpollPoller() {
         epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
         if (epoll_fd_ == -1) throw std::runtime_error("epoll_create1 failed");
 
@@ -30,11 +42,11 @@ public:
         // Add wake_fd to epoll
         struct epoll_event ev = {};
         ev.events = EPOLLIN | EPOLLET;
-        ev.data.fd = wake_fd_;
+        ev.data.ptr = nullptr; // wait() tells wake-ups apart by their null udata (data is a union)
         epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
     }
 
-    ~Poller() {
+    ~EpollPoller() {
         close(wake_fd_);
         close(epoll_fd_);
     }
@@ -69,8 +81,22 @@ public:
         }
     }
 
+    // Persistent registration: added once, edge-triggered in both directions. Every new readiness
+    // edge reports udata again until remove(); the owner decides who is waiting for what.
+    bool watch(int fd, void* udata) {
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = udata;
+        return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    // Forget fd entirely; a later add_read/add_write re-adds it
+    void remove(int fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
     // Unified Wait interface: pass a callback to handle events
-    // Callback: void(void* udata)
+    // Callback: void(void* udata, uint32_t ready), ready = kPollReadable | kPollWritable bits
     template<typename F>
     int wait(int timeout_ms, F&& callback) {
         int n = epoll_wait(epoll_fd_, events_, 128, timeout_ms);
@@ -83,13 +109,74 @@ public:
                 continue; // No callback, continue directly
             }
 
-            // Regular IO events
-            callback(events_[i].data.ptr);
+            // Regular IO events; hang-ups and errors wake both directions so the syscall reports them
+            uint32_t e = events_[i].events;
+            uint32_t ready = 0;
+            if (e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) ready |= kPollReadable;
+            if (e & (EPOLLOUT | EPOLLHUP | EPOLLERR)) ready |= kPollWritable;
+            callback(events_[i].data.ptr, ready);
         }
         return n;
     }
 };
 
+#ifdef TINYCORO_IO_URING
+// Runtime choice between the Linux backends; the branch is noise next to the syscalls behind it
+class Poller {
+    std::unique_ptr<UringPoller> uring_;
+    std::unique_ptr<EpollPoller> epoll_;
+
+public:
+    explicit Poller(IoBackend backend = IoBackend::Auto) {
+        if (backend != IoBackend::Epoll) {
+            try {
+                uring_ = std::make_unique<UringPoller>();
+            } catch (const std::exception&) {
+                if (backend == IoBackend::IoUring) throw; // Asked for explicitly: don't hide it
+            }
+        }
+        if (!uring_) epoll_ = std::make_unique<EpollPoller>();
+    }
+
+    // nullptr on the epoll backend
+    UringPoller* uring() { return uring_.get(); }
+
+    void wake() { uring_ ? uring_->wake() : epoll_->wake(); }
+    void add_read(int fd, void* udata) { uring_ ? uring_->add_read(fd, udata) : epoll_->add_read(fd, udata); }
+    void add_write(int fd, void* udata) { uring_ ? uring_->add_write(fd, udata) : epoll_->add_write(fd, udata); }
+    // Persistent edge-triggered registration; false on io_uring (its own fast paths cover sockets)
+    bool watch(int fd, void* udata) { return !uring_ && epoll_->watch(fd, udata); }
+
+    // Returns true if the registration is gone now. On io_uring the cancel is asynchronous and the
+    // registration's udata is still delivered once (with a failed result).
+    bool remove(int fd, void* udata) {
+        if (uring_) {
+            uring_->cancel(udata);
+            return false;
+        }
+        epoll_->remove(fd);
+        return true;
+    }
+
+    template<typename F>
+    int wait(int timeout_ms, F&& callback) {
+        return uring_ ? uring_->wait(timeout_ms, callback) : epoll_->wait(timeout_ms, callback);
+    }
+};
+#else
+class Poller : public EpollPoller {
+public:
+    explicit Poller(IoBackend backend = IoBackend::Auto) {
+        if (backend == IoBackend::IoUring) throw std::runtime_error("built without TINYCORO_IO_URING");
+    }
+
+    bool remove(int fd, void*) {
+        EpollPoller::remove(fd);
+        return true;
+    }
+};
+#endif
+
 // ==========================================
 // macOS Implementation (kqueue)
 // ==========================================
@@ -104,7 +191,8 @@ class Poller {
     struct kevent events_[128];
 
 public:
-    Poller() {
+    explicit Poller(IoBackend backend = IoBackend::Auto) {
+        if (backend == IoBackend::IoUring) throw std::runtime_error("io_uring is Linux-only");
         kq_ = kqueue();
         if (kq_ == -1) throw std::runtime_error("kqueue create failed");
         struct kevent ev;
@@ -134,6 +222,24 @@ public:
         kevent(kq_, &ev, 1, nullptr, 0, nullptr);
     }
 
+    // Persistent registration: EV_CLEAR is kqueue's edge-triggered mode
+    bool watch(int fd, void* udata) {
+        struct kevent ev[2];
+        EV_SET(&ev[0], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, udata);
+        EV_SET(&ev[1], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, udata);
+        return kevent(kq_, ev, 2, nullptr, 0, nullptr) == 0;
+    }
+
+    bool remove(int fd, void*) {
+        struct kevent ev[2];
+        EV_SET(&ev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+        EV_SET(&ev[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+        // Deleting a filter that was never added fails with ENOENT; harmless
+        kevent(kq_, &ev[0], 1, nullptr, 0, nullptr);
+        kevent(kq_, &ev[1], 1, nullptr, 0, nullptr);
+        return true;
+    }
+
     template<typename F>
     int wait(int timeout_ms, F&& callback) {
         struct timespec ts;
@@ -149,7 +255,8 @@ public:
             if (events_[i].filter == EVFILT_USER) continue;
             
             if (events_[i].udata) {
-                callback(events_[i].udata);
+                uint32_t ready = events_[i].filter == EVFILT_WRITE ? kPollWritable : kPollReadable;
+                callback(events_[i].udata, ready);
             }
         }
         return n;
@@ -5,32 +5,160 @@
 #include <optional>
 #include <deque>
 #include <mutex>
+#include <algorithm>
+#include <cstdint>
 
-// 1. Robust GlobalQueue (protected by Mutex)
-// Sacrifice minimal theoretical performance for 100% correctness and a green light in TSan
+// 1. Lock-free GlobalQueue (MPMC injection queue)
+// Hot path: a bounded Vyukov ring, where producers and consumers only CAS their own cursor.
+// Cold path: a mutex-guarded overflow deque, touched only while the ring is full,
+// so spawn() can never fail no matter how bursty the producers are.
+// Items are stored as raw addresses: push adopts the caller's reference, pop hands it back.
 template<typename T>
 class GlobalQueue {
-private:
-    std::deque<T> queue_;
-    std::mutex mtx_;
+    struct Slot {
+        std::atomic<size_t> seq;
+        void* ptr;
+    };
+
+    Slot* slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0}; // Consumers claim from here
+    alignas(64) std::atomic<size_t> tail_{0}; // Producers claim from here
+    alignas(64) std::atomic<size_t> overflow_size_{0};
+    std::mutex overflow_mtx_;
+    std::deque<void*> overflow_;
+
 public:
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    // capacity must be a power of two
+    explicit GlobalQueue(size_t capacity = kDefaultCapacity) : mask_(capacity - 1) {
+        slots_ = new Slot[capacity];
+        for (size_t i = 0; i < capacity; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    GlobalQueue(const GlobalQueue&) = delete;
+    GlobalQueue& operator=(const GlobalQueue&) = delete;
+
+    ~GlobalQueue() {
+        // Drop the references still parked in the queue
+        void* batch[64];
+        while (size_t n = pop_batch(batch, 64)) {
+            for (size_t i = 0; i < n; ++i) T::from_address(batch[i]);
+        }
+        delete[] slots_;
+    }
+
     //Adapt to the raw pointer interface
     bool push_ptr(void* ptr) {
-        return push(T::from_address(ptr));
+        push_batch(&ptr, 1);
+        return true;
     }
 
     bool push(T item) {
-        std::lock_guard<std::mutex> lock(mtx_);
-        queue_.push_back(std::move(item));
-        return true;
+        return push_ptr(item.detach());
+    }
+
+    // Push n raw addresses in as few CAS operations as the ring allows (e.g. a whole epoll batch)
+    void push_batch(void* const* ptrs, size_t n) {
+        size_t done = 0;
+        // While overflow is non-empty, keep new items behind it so the ring drains first
+        if (overflow_size_.load(std::memory_order_acquire) == 0) {
+            while (done < n) {
+                size_t k = push_ring(ptrs + done, n - done);
+                if (k == 0) break; // Ring full
+                done += k;
+            }
+        }
+        if (done < n) {
+            std::lock_guard<std::mutex> lock(overflow_mtx_);
+            overflow_.insert(overflow_.end(), ptrs + done, ptrs + n);
+            overflow_size_.store(overflow_.size(), std::memory_order_release);
+        }
     }
 
     std::optional<T> pop() {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (queue_.empty()) return std::nullopt;
-        T item = std::move(queue_.front());
-        queue_.pop_front();
-        return item;
+        void* ptr;
+        if (pop_batch(&ptr, 1) == 0) return std::nullopt;
+        return T::from_address(ptr);
+    }
+
+    // Pop up to max raw addresses into out, returns how many were taken
+    size_t pop_batch(void** out, size_t max) {
+        if (max == 0) return 0;
+        if (size_t k = pop_ring(out, max)) return k;
+        if (overflow_size_.load(std::memory_order_acquire) == 0) return 0;
+
+        std::lock_guard<std::mutex> lock(overflow_mtx_);
+        size_t k = std::min(max, overflow_.size());
+        std::copy_n(overflow_.begin(), k, out);
+        overflow_.erase(overflow_.begin(), overflow_.begin() + k);
+        overflow_size_.store(overflow_.size(), std::memory_order_release);
+        return k;
+    }
+
+    // Approximate: only exact when no other thread is touching the queue
+    size_t size_approx() const {
+        size_t t = tail_.load(std::memory_order_relaxed);
+        size_t h = head_.load(std::memory_order_relaxed);
+        return (t > h ? t - h : 0) + overflow_size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const { return size_approx() == 0; }
+
+private:
+    // Claim the longest run of free slots (up to n) with a single CAS on tail_
+    size_t push_ring(void* const* ptrs, size_t n) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            size_t k = 0;
+            while (k < n && k <= mask_) {
+                size_t seq = slots_[(pos + k) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + k) break;
+                ++k;
+            }
+            if (k == 0) {
+                size_t seq = slots_[pos & mask_].seq.load(std::memory_order_acquire);
+                if ((intptr_t)(seq - pos) < 0) return 0; // Slot still holds last lap's item: full
+                pos = tail_.load(std::memory_order_relaxed); // Another producer moved tail_
+                continue;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < k; ++i) {
+                    Slot& s = slots_[(pos + i) & mask_];
+                    s.ptr = ptrs[i];
+                    s.seq.store(pos + i + 1, std::memory_order_release);
+                }
+                return k;
+            }
+        }
+    }
+
+    // Claim the longest run of published slots (up to n) with a single CAS on head_
+    size_t pop_ring(void** out, size_t n) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            size_t k = 0;
+            while (k < n && k <= mask_) {
+                size_t seq = slots_[(pos + k) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + k + 1) break;
+                ++k;
+            }
+            if (k == 0) {
+                size_t seq = slots_[pos & mask_].seq.load(std::memory_order_acquire);
+                if ((intptr_t)(seq - (pos + 1)) < 0) return 0; // Not yet published: empty
+                pos = head_.load(std::memory_order_relaxed); // Another consumer moved head_
+                continue;
+            }
+            if (head_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < k; ++i) {
+                    Slot& s = slots_[(pos + i) & mask_];
+                    out[i] = s.ptr;
+                    s.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+                }
+                return k;
+            }
+        }
     }
 };
 
@@ -48,8 +176,9 @@ class StealQueue {
         ~Array() { delete[] buffer; }
         void put(size_t i, void* p) { buffer[i & mask].store(p, std::memory_order_relaxed); }
         void* get(size_t i) { return buffer[i & mask].load(std::memory_order_relaxed); }
-        Array* resize(long b, long t) {
-            Array* new_arr = new Array(cap * 2);
+        // Copy the live range [t, b) into a new array (same indices, different mask)
+        Array* resize(long b, long t, size_t new_cap) {
+            Array* new_arr = new Array(new_cap);
             for (long i = t; i < b; ++i) new_arr->put(i, get(i));
             return new_arr;
         }
@@ -59,28 +188,126 @@ class StealQueue {
     alignas(64) std::atomic<long> bottom{0};
     std::atomic<Array*> array;
     EbrManager::LocalState* local_state;
+    size_t initial_cap_;
+    size_t max_cap_;
+
+    static size_t round_pow2(size_t n) {
+        size_t c = 2;
+        while (c < n) c <<= 1;
+        return c;
+    }
+
+    // Owner only. Thieves may still read the old array: EBR frees it once they are done.
+    Array* replace_array(Array* a, long b, long t, size_t cap) {
+        Array* new_a = a->resize(b, t, cap);
+        array.store(new_a, std::memory_order_release);
+        EbrManager::get().retire(local_state, a);
+        return new_a;
+    }
+
+    // Claim up to `want` tasks from top, one CAS each (the owner may be popping from bottom)
+    size_t claim_top(void** out, size_t want) {
+        long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (t >= bottom.load(std::memory_order_acquire)) return 0;
+        size_t got = 0;
+        while (true) {
+            Array* a = array.load(std::memory_order_acquire);
+            void* val = a->get(t);
+            if (!top.compare_exchange_strong(t, t+1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                break; // Lost to the owner or another thief: keep what we have
+            }
+            out[got++] = val;
+            ++t;
+            if (got == want) break;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (t >= bottom.load(std::memory_order_acquire)) break;
+        }
+        return got;
+    }
+
+    bool push_impl(void* ptr, bool bounded) {
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+
+        if (b - t >= (long)a->cap - 1) {
+            if (bounded && a->cap >= max_cap_) return false;
+            a = replace_array(a, b, t, a->cap * 2);
+        }
+        a->put(b, ptr);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
 
 public:
-    StealQueue(EbrManager::LocalState* ls) : local_state(ls) {
-        array.store(new Array(1024));
+    // Upper bound on how many tasks one steal_batch moves
+    static constexpr size_t kMaxStealBatch = 64;
+
+    // Capacities are rounded up to powers of two. The array grows by doubling up to max_cap (0 =
+    // unbounded); beyond that try_push_ptr fails and the owner overflows to the global queue.
+    explicit StealQueue(EbrManager::LocalState* ls, size_t initial_cap = 1024, size_t max_cap = 0)
+        : local_state(ls), initial_cap_(round_pow2(initial_cap)),
+          max_cap_(max_cap ? std::max(round_pow2(max_cap), initial_cap_) : 0) {
+        array.store(new Array(initial_cap_));
     }
     ~StealQueue() { delete array.load(); }
 
+    size_t capacity() const { return array.load(std::memory_order_relaxed)->cap; }
+    size_t size_approx() const {
+        long n = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
     void push(T item) {
+        //Critical: Task::to_address() is called here, incrementing the reference count
+        push_ptr(item.to_address());
+    }
+
+    // Adopt a raw address that already owns a reference (e.g. a batch taken from GlobalQueue).
+    // Grows past max_cap if it has to; bounded callers use try_push_ptr.
+    void push_ptr(void* ptr) { push_impl(ptr, false); }
+
+    // false (nothing pushed) if the queue is full at max_cap
+    bool try_push_ptr(void* ptr) { return push_impl(ptr, max_cap_ != 0); }
+
+    // Room left before try_push_ptr would fail
+    size_t free_slots() const {
+        size_t cap = max_cap_ ? max_cap_ : SIZE_MAX / 2;
+        size_t used = size_approx() + 1;
+        return used < cap ? cap - used : 0;
+    }
+
+    // Owner: take up to n of the oldest tasks (e.g. to overflow into the global queue)
+    size_t take_oldest(void** out, size_t n) { return claim_top(out, n); }
+
+    // Owner, while idle: give a grown array back once its contents fit the initial size again
+    bool shrink() {
+        Array* a = array.load(std::memory_order_relaxed);
+        if (a->cap <= initial_cap_) return false;
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_acquire);
+        if (b - t > (long)initial_cap_ / 2) return false;
+        // A thief that claims top meanwhile reads its slot from either array: both hold it
+        replace_array(a, b, t, initial_cap_);
+        return true;
+    }
+
+    // Owner-side bulk push: all n addresses become visible to thieves with one bottom store
+    void push_batch(void* const* ptrs, size_t n) {
+        if (n == 0) return;
         long b = bottom.load(std::memory_order_relaxed);
         long t = top.load(std::memory_order_acquire);
         Array* a = array.load(std::memory_order_relaxed);
 
-        if (b - t >= (long)a->cap - 1) {
-            Array* new_a = a->resize(b, t);
-            array.store(new_a, std::memory_order_release);
-            EbrManager::get().retire(local_state, a);
-            a = new_a;
+        while (b - t + (long)n >= (long)a->cap - 1) {
+            a = replace_array(a, b, t, a->cap * 2);
         }
-        //Critical: Task::to_address() is called here, incrementing the reference count
-        a->put(b, item.to_address());
+        for (size_t i = 0; i < n; ++i) a->put(b + i, ptrs[i]);
         std::atomic_thread_fence(std::memory_order_release);
-        bottom.store(b + 1, std::memory_order_relaxed);
+        bottom.store(b + n, std::memory_order_relaxed);
     }
 
     std::optional<T> pop() {
@@ -126,4 +353,19 @@ public:
         }
         return std::nullopt;
     }
+
+    // Steal up to half of this queue (at most max) and move all but the first task into dst,
+    // which must be owned by the calling thread. The first task is returned to run right away.
+    // The owner pops from bottom without a CAS while it sees top below it, so a whole range
+    // can't be claimed with one CAS (the owner may already be inside it). Each task is still
+    // claimed with its own CAS, as in crossbeam's LIFO flavour, but the thief scans the victim
+    // once and publishes everything into dst with a single bottom store.
+    std::optional<T> steal_batch(StealQueue& dst, size_t max) {
+        void* buf[kMaxStealBatch];
+        size_t want = std::min<size_t>({(size_approx() + 1) / 2, max, kMaxStealBatch, dst.free_slots() + 1});
+        size_t got = claim_top(buf, std::max<size_t>(want, 1));
+        if (got == 0) return std::nullopt;
+        dst.push_batch(buf + 1, got - 1);
+        return T::from_address(buf[0]);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,227 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+
+#include "spinlock.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Byte string that keeps up to kInline bytes in place, so typical keys and session values cost no
+// allocation. A longer value lives on the heap and is reused by later assignments that still fit.
+class SmallString {
+public:
+    static constexpr size_t kInline = 24;
+
+    SmallString() = default;
+    SmallString(const SmallString&) = delete;
+    SmallString& operator=(const SmallString&) = delete;
+    SmallString(SmallString&& o) noexcept { steal(o); }
+    SmallString& operator=(SmallString&& o) noexcept {
+        if (this != &o) {
+            release();
+            steal(o);
+        }
+        return *this;
+    }
+    ~SmallString() { release(); }
+
+    void assign(std::string_view s) {
+        if (s.size() <= kInline) {
+            release();
+        } else if (!on_heap_ || s.size() > heap_.cap) {
+            release();
+            heap_.ptr = new char[s.size()];
+            heap_.cap = s.size();
+            on_heap_ = true;
+        }
+        std::memcpy(data(), s.data(), s.size());
+        size_ = static_cast<uint32_t>(s.size());
+    }
+
+    std::string_view view() const { return {on_heap_ ? heap_.ptr : buf_, size_}; }
+    size_t size() const { return size_; }
+
+    // Back to empty, releasing any heap buffer
+    void clear() {
+        release();
+        size_ = 0;
+    }
+
+private:
+    union {
+        char buf_[kInline];
+        struct {
+            char* ptr;
+            size_t cap;
+        } heap_;
+    };
+    uint32_t size_ = 0;
+    bool on_heap_ = false;
+
+    char* data() { return on_heap_ ? heap_.ptr : buf_; }
+    void release() {
+        if (on_heap_) delete[] heap_.ptr;
+        on_heap_ = false;
+    }
+    void steal(SmallString& o) {
+        std::memcpy(static_cast<void*>(this), static_cast<const void*>(&o), sizeof(SmallString));
+        o.on_heap_ = false;
+        o.size_ = 0;
+    }
+};
+
+// mini_redis storage engine: N shards (a power of two), each an open-addressing hash table with
+// linear probing behind its own SpinLock. The key's hash picks the shard (high bits) and the home
+// slot (low bits), and is stored in the slot, so a probe compares 8 bytes before any key bytes.
+// Deletion shifts the rest of the run back instead of leaving tombstones.
+//
+// Critical sections are a probe plus a memcpy and never suspend, so a SpinLock per shard is
+// cheaper than an AsyncMutex; with enough shards Workers rarely meet on the same one.
+//
+// The engine contract RedisDB relies on is set / get / del below; any type providing it plugs in.
+class ShardedKvStore {
+public:
+    explicit ShardedKvStore(size_t shards = 64, size_t slots_per_shard = 64)
+        : shards_(std::make_unique<Shard[]>(round_up(shards))), mask_(round_up(shards) - 1) {
+        for (size_t i = 0; i <= mask_; ++i) shards_[i].table.resize(round_up(std::max<size_t>(slots_per_shard, 8)));
+    }
+
+    ShardedKvStore(const ShardedKvStore&) = delete;
+    ShardedKvStore& operator=(const ShardedKvStore&) = delete;
+
+    void set(std::string_view key, std::string_view value) {
+        uint64_t h = hash(key);
+        Shard& s = shard(h);
+        std::lock_guard<SpinLock> lock(s.lock);
+        size_t i = s.find(h, key);
+        if (s.table[i].hash == 0) {
+            if ((s.size + 1) * 4 > s.table.size() * 3) { // Keep the load factor under 3/4
+                s.grow();
+                i = s.find(h, key);
+            }
+            s.table[i].hash = h;
+            s.table[i].key.assign(key);
+            ++s.size;
+        }
+        s.table[i].value.assign(value);
+    }
+
+    // Calls f(std::string_view value) under the shard lock, so the caller can format its reply
+    // straight from the table. Returns false if the key is absent.
+    template <typename F>
+    bool get(std::string_view key, F&& f) {
+        uint64_t h = hash(key);
+        Shard& s = shard(h);
+        std::lock_guard<SpinLock> lock(s.lock);
+        size_t i = s.find(h, key);
+        if (s.table[i].hash == 0) return false;
+        f(s.table[i].value.view());
+        return true;
+    }
+
+    std::optional<std::string> get(std::string_view key) {
+        std::optional<std::string> out;
+        get(key, [&](std::string_view v) { out.emplace(v); });
+        return out;
+    }
+
+    bool del(std::string_view key) {
+        uint64_t h = hash(key);
+        Shard& s = shard(h);
+        std::lock_guard<SpinLock> lock(s.lock);
+        size_t i = s.find(h, key);
+        if (s.table[i].hash == 0) return false;
+        s.erase(i);
+        return true;
+    }
+
+    // Sum over shards, each read under its lock (not a snapshot)
+    size_t size() {
+        size_t n = 0;
+        for (size_t i = 0; i <= mask_; ++i) {
+            std::lock_guard<SpinLock> lock(shards_[i].lock);
+            n += shards_[i].size;
+        }
+        return n;
+    }
+
+    size_t shard_count() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        uint64_t hash = 0; // 0: empty
+        SmallString key;
+        SmallString value;
+    };
+
+    struct alignas(64) Shard {
+        SpinLock lock;
+        size_t size = 0;
+        std::vector<Slot> table; // Power-of-two size
+
+        // The key's slot, or the empty slot ending its probe run
+        size_t find(uint64_t h, std::string_view key) const {
+            size_t mask = table.size() - 1;
+            for (size_t i = h & mask;; i = (i + 1) & mask) {
+                const Slot& slot = table[i];
+                if (slot.hash == 0 || (slot.hash == h && slot.key.view() == key)) return i;
+            }
+        }
+
+        void grow() {
+            std::vector<Slot> old(table.size() * 2);
+            old.swap(table);
+            size_t mask = table.size() - 1;
+            for (Slot& slot : old) {
+                if (slot.hash == 0) continue;
+                size_t i = slot.hash & mask;
+                while (table[i].hash != 0) i = (i + 1) & mask;
+                table[i] = std::move(slot);
+            }
+        }
+
+        // Backward-shift deletion: pull later entries of the run into the hole unless that would
+        // move them before their home slot
+        void erase(size_t hole) {
+            size_t mask = table.size() - 1;
+            for (size_t j = (hole + 1) & mask; table[j].hash != 0; j = (j + 1) & mask) {
+                size_t home = table[j].hash & mask;
+                // Entry j may fill the hole iff its home is not in the cyclic range (hole, j]
+                if (((j - home) & mask) >= ((j - hole) & mask)) {
+                    table[hole] = std::move(table[j]);
+                    hole = j;
+                }
+            }
+            table[hole].hash = 0;
+            table[hole].key.clear();
+            table[hole].value.clear();
+            --size;
+        }
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t mask_;
+
+    static size_t round_up(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static uint64_t hash(std::string_view key) {
+        uint64_t h = std::hash<std::string_view>{}(key);
+        h ^= h >> 33; // Mix, so both the shard (high) and slot (low) bits see the whole key
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h ? h : 1;
+    }
+
+    Shard& shard(uint64_t h) { return shards_[(h >> 48) & mask_]; }
+};
@@ -0,0 +1,126 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Incremental RESP request parser. Commands arrive as arrays of bulk strings (RESP2 and RESP3
+// clients frame requests the same way) or as inline "PING\r\n" lines from telnet-style clients.
+// Arguments are std::string_view windows into the caller's buffer: nothing is copied, and bulk
+// strings are binary safe ($len is honoured, payloads may contain CRLF).
+class RespParser {
+public:
+    static constexpr long kError = -1;
+    static constexpr long kIncomplete = -2;
+
+    static constexpr long long kMaxArgs = 1024 * 1024;
+    static constexpr long long kMaxBulk = 512LL * 1024 * 1024; // Redis' proto-max-bulk-len
+    static constexpr size_t kMaxInline = 64 * 1024;
+
+    /**
+      * Parse one command from the front of buf
+      * @return:
+      * > 0: bytes consumed; args holds the arguments (empty for a "*0" / blank line, to be skipped)
+      * kError: protocol error, the connection cannot be resynchronised
+      * kIncomplete: need to read more, at least up to needed() bytes in total
+      */
+    long parse(const char* buf, size_t len, std::vector<std::string_view>& args) {
+        // A half-received command is not rescanned until the bytes it is known to need are in
+        if (len < need_) return kIncomplete;
+        need_ = 0;
+        args.clear();
+        if (len == 0) return kIncomplete;
+        if (buf[0] != '*') return parse_inline(buf, len, args);
+
+        size_t pos = 1;
+        long long n;
+        if (long r = parse_int(buf, len, pos, n); r != 0) return r;
+        if (n > kMaxArgs) return kError;
+        if (n <= 0) return static_cast<long>(pos); // Null or empty array: nothing to run
+
+        for (long long i = 0; i < n; ++i) {
+            if (pos >= len) return incomplete(pos + 1);
+            char type = buf[pos++];
+            if (type == '$') {
+                long long blen;
+                if (long r = parse_int(buf, len, pos, blen); r != 0) return r;
+                if (blen < 0 || blen > kMaxBulk) return kError;
+                size_t end = pos + static_cast<size_t>(blen);
+                if (len < end + 2) return incomplete(end + 2);
+                if (buf[end] != '\r' || buf[end + 1] != '\n') return kError;
+                args.emplace_back(buf + pos, static_cast<size_t>(blen));
+                pos = end + 2;
+            } else if (type == '+' || type == ':') {
+                // Lenient: simple strings and integers as arguments
+                const char* eol = find_crlf(buf, len, pos);
+                if (!eol) return line_incomplete(len, pos);
+                args.emplace_back(buf + pos, eol - (buf + pos));
+                pos = eol - buf + 2;
+            } else {
+                return kError;
+            }
+        }
+        return static_cast<long>(pos);
+    }
+
+    // Total buffered bytes the pending command needs before parse() can make progress
+    size_t needed() const { return need_; }
+
+private:
+    size_t need_ = 0;
+
+    long incomplete(size_t need) {
+        need_ = need;
+        return kIncomplete;
+    }
+
+    // No CRLF yet: wait for one more byte, unless the line is already longer than any valid one
+    long line_incomplete(size_t len, size_t from) {
+        if (len - from > kMaxInline) return kError;
+        return incomplete(len + 1);
+    }
+
+    static const char* find_crlf(const char* buf, size_t len, size_t from) {
+        const char* p = buf + from;
+        const char* end = buf + len;
+        while ((p = static_cast<const char*>(std::memchr(p, '\r', end - p)))) {
+            if (p + 1 == end) return nullptr;
+            if (p[1] == '\n') return p;
+            ++p;
+        }
+        return nullptr;
+    }
+
+    // "<digits>\r\n" at pos; advances pos past the CRLF
+    long parse_int(const char* buf, size_t len, size_t& pos, long long& out) {
+        const char* eol = find_crlf(buf, len, pos);
+        if (!eol) return len - pos > 20 ? kError : incomplete(len + 1);
+        const char* p = buf + pos;
+        bool neg = p < eol && *p == '-';
+        if (neg) ++p;
+        if (p == eol) return kError;
+        long long v = 0;
+        for (; p < eol; ++p) {
+            if (*p < '0' || *p > '9' || v > kMaxBulk) return kError;
+            v = v * 10 + (*p - '0');
+        }
+        out = neg ? -v : v;
+        pos = eol - buf + 2;
+        return 0;
+    }
+
+    // Telnet style: one line, arguments separated by blanks
+    long parse_inline(const char* buf, size_t len, std::vector<std::string_view>& args) {
+        const char* nl = static_cast<const char*>(std::memchr(buf, '\n', len));
+        if (!nl) return line_incomplete(len, 0);
+        const char* end = (nl > buf && nl[-1] == '\r') ? nl - 1 : nl;
+        for (const char* p = buf; p < end;) {
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            const char* start = p;
+            while (p < end && *p != ' ' && *p != '\t') ++p;
+            if (p > start) args.emplace_back(start, p - start);
+        }
+        return static_cast<long>(nl - buf + 1);
+    }
+};
@@ -10,6 +10,11 @@
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <chrono>
+#include <type_traits>
 
 // ✅ Introduce cross-platform Poller (encapsulates epoll/kqueue)
 #include "poller.h"
@@ -20,15 +25,228 @@
 #include "queue.h"
 #include "parker.h"
 #include "timer.h"
+#include "spinlock.h"
+#include "topology.h"
+#include "blocking_pool.h"
+#include "metrics.h"
 // ==========================================
 // 1. Basic Components
 // ==========================================
 
-// Previously, the timer definition used the internal implementation in timer.h (same as the previous logic here) to enhance decoupling
+// Timers live in a hierarchical wheel (timer.h) owned by the Reactor
+
+// Cooperative preemption budget (Tokio's coop). A coroutine whose awaits never need to suspend
+// (data already buffered, room in the channel) would otherwise keep its Worker forever. Socket
+// and Channel awaiters charge one unit per operation they complete inline; once the running
+// task's budget is spent, the operation still completes, but the task is requeued behind the
+// global queue (coop_yield) instead of carrying on. A Worker refills the budget for every task it
+// takes from a queue. A task run from run_next_ inherits what is left (Go's inheritTime), so a
+// pair handing control back and forth cannot starve the rest either.
+class CoopBudget {
+public:
+    static constexpr int kDefault = 128;
+
+    // One operation completed without suspending: false once the budget is spent
+    static bool consume() {
+        if (left_ <= 0) return false;
+        --left_;
+        return true;
+    }
+    static void refill(int budget) { left_ = budget > 0 ? budget : INT_MAX; }
+    static int left() { return left_; }
+
+private:
+    inline static thread_local int left_ = kDefault;
+};
+
+// Scheduler construction knobs. Scheduler(n) is shorthand for SchedulerOptions{.workers = n}.
+struct SchedulerOptions {
+    size_t workers = std::thread::hardware_concurrency();
+    // Max tasks a thief moves per steal (1 = classic single-task Chase-Lev steal)
+    size_t steal_batch = 32;
+    // Try victims sharing the thief's L3 / NUMA domain before remote ones
+    bool locality_aware_steal = true;
+    // Reactor backend; IoUring throws if it is not compiled in or not supported by the kernel
+    IoBackend io_backend = IoBackend::Auto;
+    // Multi-reactor mode: every Worker owns an epoll/kqueue Poller, polls it between tasks and
+    // blocks in it instead of parking. Plain IO waits register with the current Worker's Poller,
+    // so a connection's wake-ups resume on the core that registered them. Timers and waits with a
+    // deadline stay on the Reactor thread.
+    bool poller_per_worker = false;
+    // Per-Worker StealQueue sizing (rounded up to powers of two). The array starts at the initial
+    // capacity and doubles up to the max; a Worker that fills it moves the oldest half (at most
+    // kOverflowBatch at a time) to the global queue instead of growing further (Go's runqputslow).
+    // 0 = unbounded. A Worker about to park shrinks a grown array back to the initial capacity.
+    size_t local_queue_capacity = 1024;
+    size_t local_queue_max = 64 * 1024;
+    bool shrink_idle_queues = true;
+    // Pin Worker i to one CPU: worker_cpus[i % size()] if given, else the topology order (the CPU
+    // locality-aware stealing already associates with Worker i). Linux only.
+    bool pin_workers = false;
+    std::vector<int> worker_cpus{};
+    // Pin the Reactor thread to this CPU (-1: leave it to the OS)
+    int reactor_cpu = -1;
+    // Awaits a task may complete without suspending before it is made to yield (CoopBudget).
+    // 0 = unlimited.
+    int coop_budget = CoopBudget::kDefault;
+    // spawn_blocking() pool: at most this many threads, each exits after this long without work
+    size_t blocking_threads = 512;
+    std::chrono::milliseconds blocking_idle_timeout{10000};
+    // Every n-th task to become runnable (per spawning thread) is timestamped, and its wait until
+    // a Worker resumes it goes into SchedulerStats::schedule_latency. 0 = off.
+    uint32_t latency_sample_every = 64;
+};
 
 // Forward declaration
 class Scheduler;
 class Worker;
+class Reactor;
+template <typename F>
+class BlockingAwaiter;
+
+// Cancellable handle to a pending timer. Cheap to copy; cancelling a fired or stale handle is a no-op.
+struct TimerHandle {
+    Reactor* reactor = nullptr;
+    TimerWheel::Id id;
+
+    explicit operator bool() const { return reactor != nullptr; }
+    // Returns true if the timer was still pending. A cancelled sleep resumes right away.
+    bool cancel();
+};
+
+// Poller udata is normally a bare coroutine address. Awaiters that need to run logic on the
+// Reactor thread first (e.g. an IO wait racing a deadline) register IoWaiter::tag(this) instead:
+// coroutine frames are at least 8-byte aligned, so the low bit tells the two apart.
+struct IoWaiter {
+    // Runs on the thread dispatching the Poller (the Reactor's, unless a Worker's IoRegistration);
+    // returns a task address (owning one reference) to spawn, or nullptr
+    void* (*on_ready)(IoWaiter*) = nullptr;
+
+    void* tag() { return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(this) | 1); }
+    static IoWaiter* untag(void* udata) {
+        uintptr_t p = reinterpret_cast<uintptr_t>(udata);
+        return (p & 1) ? reinterpret_cast<IoWaiter*>(p & ~uintptr_t(1)) : nullptr;
+    }
+};
+
+class FdRegistry;
+
+// Persistent per-fd registration: the fd joins the Poller once (EPOLLET / EV_CLEAR, both
+// directions) instead of one epoll_ctl per wait. Each direction has a slot holding 0, kReady (an
+// edge arrived while nobody waited) or the IoWaiter parked on it, so one reader and one writer can
+// share a socket. A parked waiter is handed the edge through on_ready(), which retries the syscall
+// itself and parks again on EAGAIN: an edge may be stale (harvested before its bytes were read),
+// so only a real result resumes the coroutine.
+struct IoRegistration {
+    enum Dir : uint8_t { kRead = 0, kWrite = 1 };
+    static constexpr uintptr_t kReady = 1;
+
+    std::atomic<uintptr_t> slots[2] = {};
+    int fd = -1;
+    FdRegistry* owner = nullptr;
+    IoRegistration* next_free = nullptr;
+
+    // Poller udata: bit 1 set (IoWaiter uses bit 0; io_uring's IoOp bit 1 never reaches callbacks)
+    void* tag() { return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(this) | 2); }
+    static IoRegistration* untag(void* udata) {
+        uintptr_t p = reinterpret_cast<uintptr_t>(udata);
+        return (p & 3) == 2 ? reinterpret_cast<IoRegistration*>(p & ~uintptr_t(3)) : nullptr;
+    }
+
+    // One waiter per direction. false: an edge was pending (now consumed), retry the syscall first
+    bool park(Dir d, IoWaiter* w) {
+        uintptr_t s = slots[d].load(std::memory_order_acquire);
+        while (true) {
+            if (s == kReady) {
+                if (slots[d].compare_exchange_weak(s, 0, std::memory_order_acq_rel)) return false;
+            } else if (slots[d].compare_exchange_weak(s, reinterpret_cast<uintptr_t>(w), std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+
+    // Take a parked waiter back (its deadline passed); false if an edge took it first
+    bool unpark(Dir d, IoWaiter* w) {
+        uintptr_t expected = reinterpret_cast<uintptr_t>(w);
+        return slots[d].compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+
+    // Poller side: hand each ready direction's edge to its waiter, emit(task) for every completion
+    template <typename F>
+    void dispatch(uint32_t ready, F&& emit) {
+        for (int d = 0; d < 2; ++d) {
+            if (!(ready & (d == kRead ? kPollReadable : kPollWritable))) continue;
+            uintptr_t s = slots[d].load(std::memory_order_acquire);
+            while (s != kReady) {
+                uintptr_t next = s == 0 ? kReady : 0;
+                if (!slots[d].compare_exchange_weak(s, next, std::memory_order_acq_rel)) continue;
+                if (s != 0) {
+                    auto* w = reinterpret_cast<IoWaiter*>(s);
+                    if (void* task = w->on_ready(w)) emit(task);
+                }
+                break;
+            }
+        }
+    }
+};
+
+// Registrations of one Poller (the Reactor's, or a Worker's in multi-reactor mode). Every edge of a
+// registration is dispatched by that Poller's thread, and nodes are only recycled, never freed,
+// while the Poller lives: an edge harvested just before close() still points at valid memory and
+// costs its new owner at most one EAGAIN.
+class FdRegistry {
+    Poller& poller_;
+    bool on_reactor_;
+    SpinLock lock_;
+    std::vector<std::unique_ptr<IoRegistration[]>> chunks_;
+    IoRegistration* free_ = nullptr;
+    static constexpr size_t kChunk = 256;
+
+public:
+    FdRegistry(Poller& poller, bool on_reactor) : poller_(poller), on_reactor_(on_reactor) {}
+    FdRegistry(const FdRegistry&) = delete;
+    FdRegistry& operator=(const FdRegistry&) = delete;
+
+    // True for the Reactor's registry: its edges and the timer wheel share one thread
+    bool on_reactor() const { return on_reactor_; }
+
+    // nullptr if the backend has no persistent mode (io_uring) or the fd cannot be added
+    IoRegistration* watch(int fd) {
+        IoRegistration* r;
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            if (!free_) {
+                chunks_.push_back(std::make_unique<IoRegistration[]>(kChunk));
+                for (size_t i = kChunk; i-- > 0;) {
+                    chunks_.back()[i].next_free = free_;
+                    free_ = &chunks_.back()[i];
+                }
+            }
+            r = free_;
+            free_ = r->next_free;
+        }
+        r->slots[0].store(0, std::memory_order_relaxed);
+        r->slots[1].store(0, std::memory_order_relaxed);
+        r->fd = fd;
+        r->owner = this;
+        if (poller_.watch(fd, r->tag())) return r;
+        release(r);
+        return nullptr;
+    }
+
+    // Before close(fd): no new edges after this; any in flight land on a recycled node
+    void unwatch(IoRegistration* r) {
+        poller_.remove(r->fd, r->tag());
+        release(r);
+    }
+
+private:
+    void release(IoRegistration* r) {
+        std::lock_guard<SpinLock> lock(lock_);
+        r->next_free = free_;
+        free_ = r;
+    }
+};
 
 // ==========================================
 // 2. Reactor Definition
@@ -37,26 +255,66 @@ class Reactor {
 private:
     Scheduler* scheduler_;
     Poller poller_; // Use the cross-platform Poller class from poller.h
+    FdRegistry registry_{poller_, true};
     std::thread thread_;
     std::atomic<bool> running_{false};
-    std::mutex mtx_;
-    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    // Short O(1) critical sections only: insert / cancel / advance, never a syscall
+    SpinLock timer_lock_;
+    TimerWheel wheel_;
+    // Tick the loop is sleeping until (kNever: no timer, 0: awake); guarded by timer_lock_
+    uint64_t wake_tick_ = 0;
+    std::vector<TimerWheel::Entry> expired_; // Reused by loop(), filled under timer_lock_
+    ReactorMetrics metrics_;
 
     void loop();
+    TimerHandle insert_timer(TimePoint expiry, const TimerWheel::Entry& entry, TimerHandle* out);
 public:
-    explicit Reactor(Scheduler* sched);
+    explicit Reactor(Scheduler* sched, IoBackend backend = IoBackend::Auto);
     ~Reactor();
 
     void start();
     void stop();
-    void add_timer(TimePoint expiry, std::coroutine_handle<> handle);
+    // Resume h at expiry (takes its own reference). *fired, if given, is set to true on expiry
+    // and false if the handle is cancelled first. *out, if given, receives the handle before the
+    // timer can fire, i.e. before h can be resumed on another thread.
+    TimerHandle add_timer(TimePoint expiry, std::coroutine_handle<Task::Promise> h,
+                          bool* fired = nullptr, TimerHandle* out = nullptr);
+    // Call fn(arg) on the Reactor thread at expiry; keep it short. Cancelling drops the call silently.
+    TimerHandle add_timer(TimePoint expiry, void (*fn)(void*), void* arg, TimerHandle* out = nullptr);
+    bool cancel_timer(TimerWheel::Id id);
+    // Hand a task address (owning one reference) to the scheduler, e.g. from a timer callback
+    void spawn(void* task);
+    size_t timer_count();
+    const ReactorMetrics& metrics() const { return metrics_; }
 
     // ✅ Proxy Poller's registration interface
     // Poller internally handles epoll/kqueue differences automatically
-    void register_read(int fd, void* handle) { poller_.add_read(fd, handle); }
-    void register_write(int fd, void* handle) { poller_.add_write(fd, handle); }
-
+    void register_read(int fd, void* handle) { poller_for(handle).add_read(fd, handle); }
+    void register_write(int fd, void* handle) { poller_for(handle).add_write(fd, handle); }
+    // Persistent registration for a socket, from the current Worker's Poller in multi-reactor mode.
+    // nullptr on io_uring. Release with reg->owner->unwatch(reg) before closing the fd.
+    IoRegistration* watch(int fd);
+    // Drop a pending registration (Reactor thread only). Returns false if the backend cancels
+    // asynchronously (io_uring): handle is then still delivered once.
+    bool unregister(int fd, void* handle) { return poller_.remove(fd, handle); }
+#ifdef TINYCORO_IO_URING
+    // Direct submission interface; nullptr unless the io_uring backend is active. Also nullptr in
+    // multi-reactor mode: completions would land here instead of on the registering Worker.
+    UringPoller* uring() { return uring_enabled_ ? poller_.uring() : nullptr; }
+    // A closed socket's multishot stream (UringStream::close) still waits for its final CQE, and
+    // frees itself on it. stop() keeps reaping until every such stream is gone.
+    void stream_closing() { closing_streams_.fetch_add(1, std::memory_order_relaxed); }
+    void stream_freed() { closing_streams_.fetch_sub(1, std::memory_order_release); }
+#endif
 
+private:
+#ifdef TINYCORO_IO_URING
+    bool uring_enabled_ = true;
+    std::atomic<size_t> closing_streams_{0};
+#endif
+    // Bare coroutines registered from a Worker go to that Worker's Poller in multi-reactor mode;
+    // IoWaiter tags always stay here since their hooks run on the Reactor thread
+    Poller& poller_for(void* handle);
 };
 
 // ==========================================
@@ -64,25 +322,100 @@ public:
 // ==========================================
 class Worker {
 private:
+    friend class Scheduler;
     size_t id_;
     Scheduler& scheduler_;
     EbrManager::LocalState* ebr_state_;
     std::unique_ptr<StealQueue<Task>> local_queue_;
+    // LIFO "next task" slot (Go's runnext): the task most recently woken by this Worker runs next
+    alignas(64) std::atomic<void*> run_next_{nullptr};
     Parker parker_;
     std::mt19937 rng_;
+    // Tasks handed to this Worker by Scheduler::spawn_on() from other threads
+    SpinLock inbox_lock_;
+    std::vector<void*> inbox_;
+    std::atomic<bool> inbox_ready_{false};
+    // Multi-reactor mode only (SchedulerOptions::poller_per_worker)
+    std::unique_ptr<Poller> poller_;
+    std::unique_ptr<FdRegistry> registry_;
+    uint32_t ticks_ = 0;
+    int coop_budget_;
+    // Counted in Scheduler::nspinning_ (owner thread only)
+    bool spinning_ = false;
+    // Guarded by Scheduler::idle_lock_
+    bool idle_ = false;
+    // Spin iterations before parking, adapted to how long recent parks lasted
+    uint32_t spin_limit_ = kSpinInitial;
+    // Owner thread writes, stats() reads
+    WorkerMetrics metrics_;
+    static void bump(WorkerMetrics::Counter& c) { WorkerMetrics::bump(c); }
+    inline static thread_local Worker* current_ = nullptr;
     void run_once();
+    // inherit: the task came from run_next_ and keeps the CoopBudget its waker left
+    void execute(Task& t, bool inherit);
+    std::optional<Task> spin();
+    void stop_spinning();
+    // Owner-side push that overflows to the global queue when the local one is full
+    void push_local(void* ptr);
+    void overflow(void* ptr);
+    std::optional<Task> pop_global_batch();
+    // Move spawn_on() arrivals into the local queue; true if there were any
+    bool drain_inbox();
+    // Move ready IO wake-ups into the local queue; true if there were any
+    bool poll(int timeout_ms);
+    // Join the idle set and sleep; returns a task found by the last look instead
+    std::optional<Task> park();
 
 public:
+    // Tasks between two non-blocking polls of a busy Worker's Poller
+    static constexpr uint32_t kPollInterval = 61;
+    // Every kGlobalInterval-th task comes from the global queue if it has any (Go's schedtick % 61),
+    // so Reactor wake-ups and yielded tasks don't wait behind a busy local queue
+    static constexpr uint32_t kGlobalInterval = 61;
+    // Upper bound on how many tasks one local queue overflow moves to the global queue
+    static constexpr size_t kOverflowBatch = 256;
+    // Spin budget bounds (in cpu_relax rounds); a park shorter than kShortPark doubles the budget,
+    // one longer than kLongPark halves it
+    static constexpr uint32_t kSpinMin = 16, kSpinInitial = 64, kSpinMax = 2048;
+    static constexpr std::chrono::microseconds kShortPark{50}, kLongPark{1000};
+    // A spinning Worker also tries to steal every kStealEvery rounds
+    static constexpr uint32_t kStealEvery = 8;
+
     Worker(size_t id, Scheduler& s);
     Worker(const Worker&) = delete;
+    ~Worker();
 
     void run();
-    void wake() { parker_.unpark(); }
+    void wake() {
+        if (!poller_) parker_.unpark();
+        else if (parker_.notify()) poller_->wake(); // Only a Worker blocked in its Poller needs the syscall
+    }
     void schedule(Task t);
+    // Adopt a raw task address on the owner thread: it takes the run_next_ slot,
+    // the previous occupant moves to the local queue. Returns true if something was displaced.
+    bool schedule_local(void* ptr);
     std::optional<Task> steal();
+    // Any thread: queue a task address (owning one reference) for this Worker; see Scheduler::spawn_on
+    void post(void* ptr) {
+        std::lock_guard<SpinLock> lock(inbox_lock_);
+        inbox_.push_back(ptr);
+        inbox_ready_.store(true, std::memory_order_relaxed);
+    }
+    // Move up to half of this Worker's queue into thief's queue, returning one task to run
+    std::optional<Task> steal_batch(Worker& thief, size_t max);
+    // Last resort before parking: also take the victim's run_next_ slot
+    std::optional<Task> steal_next();
     size_t id() const { return id_; }
+    Scheduler& scheduler() { return scheduler_; }
+    // nullptr unless the Scheduler runs in multi-reactor mode
+    Poller* poller() { return poller_.get(); }
+    FdRegistry* registry() { return registry_.get(); }
 
+    // The Worker running on the calling thread, nullptr for the Reactor, main or foreign threads
+    static Worker* current() { return current_; }
 
+    // Requeue a task behind everything queued so far (the global queue); ptr owns one reference
+    void yield(void* ptr);
 };
 
 // ==========================================
@@ -96,40 +429,173 @@ private:
     std::vector<std::thread> threads_;
     std::atomic<bool> stop_{false};
     std::unique_ptr<Reactor> reactor_;
+    std::unique_ptr<BlockingPool> blocking_;
+    SchedulerOptions options_;
+    CpuTopology topology_;
+    // Victim order per thief: same-domain peers first, then the rest
+    std::vector<std::vector<size_t>> near_peers_;
+    std::vector<std::vector<size_t>> far_peers_;
+
+    // Idle set (Go's pidle): parked Workers, most recent last so the cache-warmest wakes first
+    mutable SpinLock idle_lock_;
+    std::vector<Worker*> idle_;
+    alignas(64) std::atomic<size_t> nidle_{0};
+    // Workers looking for work (Go's nmspinning). Whoever queues work only wakes a parked Worker
+    // if nobody is searching: a searcher finds the work itself and, once it does, wakes the next.
+    alignas(64) std::atomic<size_t> nspinning_{0};
+
+    // New work is queued (Go's wakep). One Worker at most, however much work: if it finds more
+    // than it can run, stop_spinning() wakes the next one.
+    void wake_idle() {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in Worker::park
+        if (nidle_.load(std::memory_order_relaxed) == 0) return;
+        size_t expected = 0;
+        if (!nspinning_.compare_exchange_strong(expected, 1, std::memory_order_seq_cst)) return;
+        Worker* w = pop_idle();
+        if (!w) {
+            nspinning_.fetch_sub(1, std::memory_order_seq_cst);
+            return;
+        }
+        w->wake(); // Counted as spinning on its behalf: taken out of the idle set means "search"
+    }
+
+    // Go's limit: at most half of the busy Workers search at once
+    bool try_begin_spinning() {
+        size_t busy = workers_.size() - nidle_.load(std::memory_order_relaxed);
+        if (2 * nspinning_.load(std::memory_order_relaxed) >= busy) return false;
+        nspinning_.fetch_add(1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // Sampled timestamp for SchedulerStats::schedule_latency, taken before ptr is published
+    void mark_ready(void* ptr) {
+        if (options_.latency_sample_every == 0) return;
+        static thread_local uint32_t n = 0;
+        if (++n < options_.latency_sample_every) return;
+        n = 0;
+        auto h = std::coroutine_handle<Task::Promise>::from_address(ptr);
+        h.promise().ready_at = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void push_idle(Worker* w);
+    Worker* pop_idle();
+    // false if a waker took w out first
+    bool remove_idle(Worker* w);
 
 public:
-    Scheduler(size_t n = std::thread::hardware_concurrency());
+    // Upper bound on how many tasks a Worker moves from the global queue in one go
+    static constexpr size_t kGlobalBatch = 32;
+
+    Scheduler(size_t n = std::thread::hardware_concurrency())
+        : Scheduler(SchedulerOptions{.workers = n}) {}
+    explicit Scheduler(const SchedulerOptions& options);
     ~Scheduler();
 
     // 🟢 Spawn: Use detach() to avoid reference count race conditions
+    // On one of our Worker threads the task stays local (run_next_ slot, no wake-up),
+    // so Channel / AsyncMutex hand-offs keep running on the same cache-hot core.
+    // Only off-worker callers (Reactor, main thread) go through the global queue.
     void spawn(Task t) {
         if (void* ptr = t.detach()) {
-            global_queue_.push_ptr(ptr);
-            if (!workers_.empty()) {
-                static std::atomic<size_t> next{0};
-                workers_[next.fetch_add(1, std::memory_order_relaxed) % workers_.size()]->wake();
+            mark_ready(ptr);
+            if (Worker* w = Worker::current(); w && &w->scheduler() == this) {
+                // Surplus work appeared in the local queue: let someone come and steal it
+                if (w->schedule_local(ptr)) wake_idle();
+                return;
             }
+            global_queue_.push_ptr(ptr);
+            wake_idle();
         }
     }
 
+    // Start the task on Worker i (e.g. a per-Worker accept loop, so that its fd registration and the
+    // connections it spawns live on that Worker). Only the start is placed: once it suspends and
+    // becomes runnable again, idle peers may steal it like any other task.
+    void spawn_on(size_t i, Task t) {
+        void* ptr = t.detach();
+        if (!ptr) return;
+        mark_ready(ptr);
+        Worker& w = *workers_[i % workers_.size()];
+        if (Worker::current() == &w) {
+            if (w.schedule_local(ptr)) wake_idle();
+            return;
+        }
+        w.post(ptr);
+        // Pairs with the fence in Worker::park: either it sees the inbox, or we see it idle
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (remove_idle(&w)) {
+            nspinning_.fetch_add(1, std::memory_order_seq_cst); // Woken as a searcher, as in wake_idle
+            w.wake();
+        }
+    }
+
+    // co_await sched.spawn_blocking(fn): run fn() on the blocking pool instead of a Worker, so a
+    // slow disk or a long computation does not hold up the tasks queued behind this one. The
+    // awaiting task resumes on a Worker with fn's result. fn is moved into the awaiter.
+    template <typename F>
+    BlockingAwaiter<std::decay_t<F>> spawn_blocking(F&& fn);
+
+    // Batch spawn: every address must already own one reference (e.g. a Reactor epoll batch)
+    void spawn_batch(void* const* ptrs, size_t n) {
+        if (n == 0) return;
+        for (size_t i = 0; i < n; ++i) mark_ready(ptrs[i]);
+        global_queue_.push_batch(ptrs, n);
+        wake_idle();
+    }
+
     std::optional<Task> pop_global() { return global_queue_.pop(); }
 
-    std::optional<Task> steal() {
-        size_t n = workers_.size();
-        if (n <= 1) return std::nullopt;
+    // Take a fair share of the global queue (Go's globrunqget: len/workers + 1, capped)
+    size_t pop_global_batch(void** out, size_t max) {
+        size_t share = global_queue_.size_approx() / std::max<size_t>(workers_.size(), 1) + 1;
+        return global_queue_.pop_batch(out, std::min(max, share));
+    }
+
+    // Steal on behalf of thief: near victims first, each from a random starting offset
+    std::optional<Task> steal(Worker& thief, bool include_next = false) {
+        if (workers_.size() <= 1) return std::nullopt;
         static thread_local std::mt19937 rng(std::random_device{}());
-        size_t start = std::uniform_int_distribution<size_t>(0, n-1)(rng);
-        for (size_t i = 0; i < n; ++i) {
-            size_t idx = (start + i) % n;
-            if (auto t = workers_[idx]->steal()) return t;
+        for (auto* peers : {&near_peers_[thief.id()], &far_peers_[thief.id()]}) {
+            size_t n = peers->size();
+            if (n == 0) continue;
+            size_t start = std::uniform_int_distribution<size_t>(0, n-1)(rng);
+            for (size_t i = 0; i < n; ++i) {
+                Worker& victim = *workers_[(*peers)[(start + i) % n]];
+                if (auto t = victim.steal_batch(thief, options_.steal_batch)) {
+                    TINYCORO_TRACE_EVENT(TraceEvent::kSteal, t->handle.address(), &victim);
+                    WorkerMetrics::bump(thief.metrics_.steals);
+                    return t;
+                }
+            }
+        }
+        if (include_next) {
+            for (auto& w : workers_) {
+                if (w.get() == &thief) continue;
+                if (auto t = w->steal_next()) {
+                    TINYCORO_TRACE_EVENT(TraceEvent::kSteal, t->handle.address(), w.get());
+                    WorkerMetrics::bump(thief.metrics_.steals);
+                    return t;
+                }
+            }
         }
+        WorkerMetrics::bump(thief.metrics_.steal_failures);
         return std::nullopt;
     }
 
     size_t worker_count() const { return workers_.size(); }
+    // CPU Worker i is pinned to, -1 if it is not
+    int worker_cpu(size_t i) const {
+        if (!options_.pin_workers) return -1;
+        if (!options_.worker_cpus.empty()) return options_.worker_cpus[i % options_.worker_cpus.size()];
+        return topology_.cpu(i);
+    }
+    const SchedulerOptions& options() const { return options_; }
     Worker& get_worker(size_t i) { return *workers_[i]; }
     bool is_running() const { return !stop_.load(std::memory_order_acquire); }
     Reactor* reactor() { return reactor_.get(); }
+    BlockingPool& blocking_pool() { return *blocking_; }
+    SchedulerStats stats() const;
 };
 
 // ==========================================
@@ -138,7 +604,11 @@ public:
 
 // --- Reactor Implementation ---
 
-inline Reactor::Reactor(Scheduler* sched) : scheduler_(sched) {}
+inline Reactor::Reactor(Scheduler* sched, IoBackend backend) : scheduler_(sched), poller_(backend) {
+#ifdef TINYCORO_IO_URING
+    uring_enabled_ = !sched->options().poller_per_worker;
+#endif
+}
 inline Reactor::~Reactor() { stop(); }
 
 inline void Reactor::start() {
@@ -155,60 +625,182 @@ inline void Reactor::stop() {
     }
 }
 
-inline void Reactor::add_timer(TimePoint expiry, std::coroutine_handle<> handle) {
+inline TimerHandle Reactor::insert_timer(TimePoint expiry, const TimerWheel::Entry& entry, TimerHandle* out) {
     bool need_wake = false;
+    TimerWheel::Id id;
     {
-        std::lock_guard<std::mutex> lock(mtx_);
-        timers_.push({expiry, handle});
-        if (timers_.top().expiry == expiry) need_wake = true;
+        std::lock_guard<SpinLock> lock(timer_lock_);
+        uint64_t tick = std::max(wheel_.tick_ceil(expiry), wheel_.now_tick() + 1);
+        id = wheel_.insert(tick, entry);
+        if (out) *out = {this, id};
+        // The loop recomputes its timeout after every wait, so only a deadline earlier than the one
+        // it is sleeping towards needs a wake-up. Later inserts for the same tick reuse that wake-up.
+        if (tick < wake_tick_) {
+            wake_tick_ = tick;
+            need_wake = true;
+        }
     }
     if (need_wake) poller_.wake();
+    return {this, id};
+}
+
+inline TimerHandle Reactor::add_timer(TimePoint expiry, std::coroutine_handle<Task::Promise> h,
+                                      bool* fired, TimerHandle* out) {
+    // Ref +1 (for the wheel), adopted by spawn() on expiry or cancel
+    Task::retain(h);
+    return insert_timer(expiry, {.task = h.address(), .fired = fired}, out);
+}
+
+inline TimerHandle Reactor::add_timer(TimePoint expiry, void (*fn)(void*), void* arg, TimerHandle* out) {
+    return insert_timer(expiry, {.callback = fn, .arg = arg}, out);
+}
+
+inline bool Reactor::cancel_timer(TimerWheel::Id id) {
+    TimerWheel::Entry e;
+    {
+        std::lock_guard<SpinLock> lock(timer_lock_);
+        if (!wheel_.cancel(id, &e)) return false;
+    }
+    if (e.task) {
+        if (e.fired) *e.fired = false;
+        scheduler_->spawn(Task::from_address(e.task));
+    }
+    return true;
+}
+
+inline void Reactor::spawn(void* task) {
+    scheduler_->spawn(Task::from_address(task));
+}
+
+inline Poller& Reactor::poller_for(void* handle) {
+    if (!IoWaiter::untag(handle)) {
+        if (Worker* w = Worker::current(); w && w->poller() && &w->scheduler() == scheduler_) return *w->poller();
+    }
+    return poller_;
+}
+
+inline IoRegistration* Reactor::watch(int fd) {
+    if (Worker* w = Worker::current(); w && w->registry() && &w->scheduler() == scheduler_) return w->registry()->watch(fd);
+    return registry_.watch(fd);
+}
+
+inline size_t Reactor::timer_count() {
+    std::lock_guard<SpinLock> lock(timer_lock_);
+    return wheel_.size();
+}
+
+inline bool TimerHandle::cancel() {
+    return reactor && reactor->cancel_timer(id);
 }
 
 inline void Reactor::loop() {
+    if (int cpu = scheduler_->options().reactor_cpu; cpu >= 0) pin_current_thread(cpu);
+    // Woken handles are collected and handed to the scheduler in one batch per wait,
+    // instead of one GlobalQueue push + wake per event
+    void* batch[128];
+    size_t batch_size = 0;
+    auto flush = [&] {
+        scheduler_->spawn_batch(batch, batch_size);
+        batch_size = 0;
+    };
+
     // ✅ Define IO callback function
     // Whether using Linux epoll or macOS kqueue, the underlying layer will call this lambda
-    auto io_handler = [this](void* udata) {
-        if (udata) {
-            // Recover Task from void* and schedule it
-            // Note: Task::from_address takes over the reference count
-            scheduler_->spawn(Task::from_address(udata));
+    auto emit = [&](void* task) {
+        // Note: every task already owns the reference taken in await_suspend
+        batch[batch_size++] = task;
+        if (batch_size == 128) flush();
+    };
+    auto io_emit = [&](void* task) {
+        TINYCORO_TRACE_EVENT(TraceEvent::kIoEvent, task, this);
+        emit(task);
+    };
+    auto io_handler = [&](void* udata, uint32_t ready) {
+        if (IoRegistration* reg = IoRegistration::untag(udata)) {
+            reg->dispatch(ready, io_emit);
+            return;
         }
+        if (IoWaiter* w = IoWaiter::untag(udata)) udata = w->on_ready(w);
+        if (udata) io_emit(udata);
     };
 
     while (running_) {
         int timeout_ms = -1;
         {
-            std::lock_guard<std::mutex> lock(mtx_);
-            if (!timers_.empty()) {
-                auto now = std::chrono::steady_clock::now();
-                auto next = timers_.top().expiry;
-                if (next <= now) timeout_ms = 0;
-                else timeout_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count());
+            std::lock_guard<SpinLock> lock(timer_lock_);
+            uint64_t next = wheel_.next_tick();
+            if (next != TimerWheel::kNever) {
+                uint64_t now = wheel_.tick_floor(std::chrono::steady_clock::now());
+                timeout_ms = next <= now ? 0 : static_cast<int>(std::min<uint64_t>(next - now, INT32_MAX));
             }
+            wake_tick_ = next;
         }
 
         // ✅ Core change: unified wait interface
         // Pass timeout and callback to mask differences in underlying event arrays
-        poller_.wait(timeout_ms, io_handler);
+        size_t events = 0;
+        poller_.wait(timeout_ms, [&](void* udata, uint32_t ready) {
+            ++events;
+            io_handler(udata, ready);
+        });
+        ReactorMetrics::bump(metrics_.waits);
+        if (events) metrics_.batch.record(events);
+        flush();
 
-        // Handle timers
+        // Handle timers: everything due up to the current tick expires in one pass
         {
-            std::lock_guard<std::mutex> lock(mtx_);
-            auto now = std::chrono::steady_clock::now();
-            while (!timers_.empty() && timers_.top().expiry <= now) {
-                Timer t = timers_.top();
-                timers_.pop();
-                scheduler_->spawn(Task::from_address(t.handle.address()));
+            std::lock_guard<SpinLock> lock(timer_lock_);
+            wake_tick_ = 0;
+            wheel_.advance(wheel_.tick_floor(std::chrono::steady_clock::now()),
+                           [this](const TimerWheel::Entry& e) { expired_.push_back(e); });
+        }
+        ReactorMetrics::bump(metrics_.timers_fired, expired_.size());
+        for (const TimerWheel::Entry& e : expired_) {
+            TINYCORO_TRACE_EVENT(TraceEvent::kTimerFire, e.callback ? e.arg : e.task, nullptr);
+            if (e.callback) {
+                e.callback(e.arg);
+                continue;
             }
+            if (e.fired) *e.fired = true;
+            emit(e.task);
         }
+        expired_.clear();
+        flush();
     }
+#ifdef TINYCORO_IO_URING
+    // Streams closed just before stop() (a listener or socket going out of scope right before its
+    // Scheduler) would otherwise never see their final CQE and leak. Bounded, in case a CQE is lost.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (closing_streams_.load(std::memory_order_acquire) > 0 && std::chrono::steady_clock::now() < deadline) {
+        poller_.wait(1, io_handler);
+        flush();
+    }
+#endif
 }
 
 // --- Scheduler & Worker Implementation (logic remains unchanged) ---
 
-inline Scheduler::Scheduler(size_t n) {
-    reactor_ = std::make_unique<Reactor>(this);
+inline Scheduler::Scheduler(const SchedulerOptions& options)
+    : options_(options), topology_(CpuTopology::discover()) {
+    size_t n = std::max<size_t>(options_.workers, 1);
+    // Worker i is associated with topology_.cpu(i) (or its pinned CPU); group victims by that CPU's domain
+    auto domain = [&](size_t i) {
+        return options_.pin_workers && !options_.worker_cpus.empty()
+                   ? topology_.domain_of_cpu(options_.worker_cpus[i % options_.worker_cpus.size()])
+                   : topology_.domain(i);
+    };
+    near_peers_.resize(n);
+    far_peers_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j) continue;
+            bool near = !options_.locality_aware_steal || domain(i) == domain(j);
+            (near ? near_peers_[i] : far_peers_[i]).push_back(j);
+        }
+    }
+
+    reactor_ = std::make_unique<Reactor>(this, options_.io_backend);
+    blocking_ = std::make_unique<BlockingPool>(options_.blocking_threads, options_.blocking_idle_timeout);
     workers_.reserve(n);
     for (size_t i = 0; i < n; ++i) workers_.push_back(std::make_unique<Worker>(i, *this));
     reactor_->start();
@@ -220,57 +812,354 @@ inline Scheduler::~Scheduler() {
     stop_.store(true, std::memory_order_release);
     for(auto& w : workers_) w->wake();
     for(auto& t : threads_) if(t.joinable()) t.join();
+    // Calls still running finish and queue their tasks, which nobody runs any more
+    blocking_->shutdown();
 }
 
 inline Worker::Worker(size_t id, Scheduler& s)
-    : id_(id), scheduler_(s), rng_(std::random_device{}()) {
+    : id_(id), scheduler_(s), rng_(std::random_device{}()), coop_budget_(s.options().coop_budget) {
     ebr_state_ = EbrManager::get().register_thread();
-    local_queue_ = std::make_unique<StealQueue<Task>>(ebr_state_);
+    local_queue_ = std::make_unique<StealQueue<Task>>(ebr_state_, s.options().local_queue_capacity,
+                                                      s.options().local_queue_max);
+    // Readiness only: io_uring completions for these fds would need a ring per Worker too
+    if (s.options().poller_per_worker) {
+        poller_ = std::make_unique<Poller>(IoBackend::Epoll);
+        registry_ = std::make_unique<FdRegistry>(*poller_, false);
+    }
+}
+
+// After the thread has been joined: the queue's retired arrays become EBR orphans
+inline Worker::~Worker() {
+    local_queue_.reset();
+    EbrManager::get().unregister_thread(ebr_state_);
 }
 
 inline void Worker::schedule(Task t) {
-    local_queue_->push(std::move(t));
+    if (void* ptr = t.detach()) push_local(ptr);
+}
+
+inline bool Worker::schedule_local(void* ptr) {
+    void* prev = run_next_.exchange(ptr, std::memory_order_acq_rel);
+    if (!prev) return false;
+    push_local(prev);
+    return true;
+}
+
+inline void Worker::push_local(void* ptr) {
+    if (!local_queue_->try_push_ptr(ptr)) overflow(ptr);
+}
+
+// Full at max capacity: hand the oldest half plus ptr to the global queue in one batch, so the
+// next pushes are cheap again and idle peers pick the surplus up
+inline void Worker::overflow(void* ptr) {
+    void* batch[kOverflowBatch + 1];
+    size_t n = local_queue_->take_oldest(batch, std::min(local_queue_->size_approx() / 2, kOverflowBatch));
+    batch[n++] = ptr;
+    scheduler_.global_queue_.push_batch(batch, n);
+    scheduler_.wake_idle();
+}
+
+inline bool Worker::drain_inbox() {
+    if (!inbox_ready_.load(std::memory_order_acquire)) return false;
+    std::vector<void*> batch;
+    {
+        std::lock_guard<SpinLock> lock(inbox_lock_);
+        batch.swap(inbox_);
+        inbox_ready_.store(false, std::memory_order_relaxed);
+    }
+    for (void* ptr : batch) push_local(ptr);
+    return !batch.empty();
 }
 
 inline std::optional<Task> Worker::steal() {
     return local_queue_->steal();
 }
 
+inline std::optional<Task> Worker::steal_batch(Worker& thief, size_t max) {
+    if (max <= 1) return local_queue_->steal();
+    return local_queue_->steal_batch(*thief.local_queue_, max);
+}
+
+inline std::optional<Task> Worker::steal_next() {
+    if (void* ptr = run_next_.exchange(nullptr, std::memory_order_acq_rel)) return Task::from_address(ptr);
+    return std::nullopt;
+}
+
+// Run the first task of a global batch, keep the rest in the local queue (must hold EbrGuard)
+inline std::optional<Task> Worker::pop_global_batch() {
+    void* batch[Scheduler::kGlobalBatch];
+    size_t n = scheduler_.pop_global_batch(batch, Scheduler::kGlobalBatch);
+    if (n == 0) return std::nullopt;
+    for (size_t i = 1; i < n; ++i) push_local(batch[i]);
+    TINYCORO_TRACE_EVENT(TraceEvent::kGlobal, batch[0], this);
+    bump(metrics_.global_pops);
+    return Task::from_address(batch[0]);
+}
+
 inline void Worker::run() {
+    current_ = this;
+    if (int cpu = scheduler_.worker_cpu(id_); cpu >= 0) pin_current_thread(cpu);
     while (scheduler_.is_running()) {
         run_once();
     }
 }
 
-inline void Worker::run_once() {
-    std::optional<Task> task;
+// Wake-ups land in the local queue, so the connection keeps running on this core (peers can still steal)
+inline bool Worker::poll(int timeout_ms) {
+    size_t n = 0;
+    // Every task owns the reference taken in await_suspend. One wait yields at most 128 events, and
+    // a registration at most two completions per event.
+    void* ready[256];
+    auto emit = [&](void* task) {
+        TINYCORO_TRACE_EVENT(TraceEvent::kIoEvent, task, this);
+        ready[n++] = task;
+    };
+    poller_->wait(timeout_ms, [&](void* udata, uint32_t events) {
+        if (IoRegistration* reg = IoRegistration::untag(udata)) reg->dispatch(events, emit);
+        else if (udata) emit(udata);
+    });
+    if (n == 0) return false;
+    metrics_.poll_batch.record(n);
     {
         EbrGuard guard(ebr_state_);
-        if (auto t = local_queue_->pop()) task = std::move(t);
-        else if (auto t = scheduler_.pop_global()) task = std::move(t);
-        else if (auto t = scheduler_.steal()) task = std::move(t);
+        for (size_t i = 0; i < n; ++i) {
+            scheduler_.mark_ready(ready[i]);
+            push_local(ready[i]);
+        }
     }
+    if (n > 1) scheduler_.wake_idle(); // Surplus: let an idle peer steal some
+    return true;
+}
+
+// Leaves the spinning state (Go's resetspinning). The last searcher to find work wakes a
+// replacement, so a burst of spawns fans out one Worker at a time instead of all at once.
+inline void Worker::stop_spinning() {
+    spinning_ = false;
+    if (scheduler_.nspinning_.fetch_sub(1, std::memory_order_seq_cst) == 1) scheduler_.wake_idle();
+}
 
-    if (task) {
-        task->resume();
-        return;
+inline void Worker::execute(Task& t, bool inherit) {
+    if (spinning_) stop_spinning();
+    if (!inherit) CoopBudget::refill(coop_budget_);
+    if (t.handle) {
+        if (uint64_t& ready_at = t.handle.promise().ready_at) {
+            uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch()).count();
+            metrics_.schedule_latency.record(now > ready_at ? now - ready_at : 0);
+            ready_at = 0;
+        }
     }
+    t.run();
+}
 
-    for (int i = 0; i < 50; ++i) {
+inline void Worker::yield(void* ptr) {
+    bump(metrics_.yields);
+    scheduler_.mark_ready(ptr);
+    scheduler_.global_queue_.push_ptr(ptr);
+    scheduler_.wake_idle();
+}
+
+// Search for a while before sleeping: work that shows up within the budget costs no futex round trip
+inline std::optional<Task> Worker::spin() {
+    if (!spinning_ && !scheduler_.try_begin_spinning()) return std::nullopt;
+    spinning_ = true;
+    for (uint32_t i = 1; i <= spin_limit_ && scheduler_.is_running(); ++i) {
+        std::optional<Task> t;
         {
             EbrGuard guard(ebr_state_);
-            if (auto t = scheduler_.pop_global()) {
-                 t->resume();
-                 return;
+            t = pop_global_batch();
+            if (!t && i % kStealEvery == 0) t = scheduler_.steal(*this);
+        }
+        if (!t && i % kStealEvery == 0 && poller_ && poll(0)) {
+            EbrGuard guard(ebr_state_);
+            t = local_queue_->pop();
+            if (t) {
+                TINYCORO_TRACE_EVENT(TraceEvent::kPop, t->handle.address(), this);
+                bump(metrics_.local_pops);
             }
         }
-        #if defined(__x86_64__) || defined(_M_X64)
-            _mm_pause();
-        #elif defined(__aarch64__)
-            asm volatile("yield");
-        #endif
+        if (t) {
+            bump(metrics_.spin_hits);
+            return t;
+        }
+        cpu_relax();
     }
-    parker_.park();
+    bump(metrics_.spin_misses);
+    return std::nullopt;
+}
+
+inline std::optional<Task> Worker::park() {
+    // Idle: give a burst's grown array back, then free retired arrays now, not at the next resize
+    if (scheduler_.options().shrink_idle_queues) local_queue_->shrink();
+    EbrManager::get().collect(ebr_state_);
+
+    scheduler_.push_idle(this);
+    if (spinning_) {
+        spinning_ = false;
+        scheduler_.nspinning_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    // Last look (Go's findrunnable re-check). A producer that saw this Worker busy or spinning did
+    // not wake anyone, so work queued before our idle_ entry became visible must be found here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::optional<Task> t;
+    {
+        EbrGuard guard(ebr_state_);
+        if (drain_inbox()) t = local_queue_->pop();
+        if (t) {
+            TINYCORO_TRACE_EVENT(TraceEvent::kPop, t->handle.address(), this);
+            bump(metrics_.local_pops);
+        }
+        if (!t) t = pop_global_batch();
+        if (!t) t = scheduler_.steal(*this, true); // Also rescues busy Workers' run_next_ slots
+    }
+    if (t) {
+        if (!scheduler_.remove_idle(this)) spinning_ = true; // A waker counted us as its searcher
+        return t;
+    }
+
+    bump(metrics_.parks);
+    TINYCORO_TRACE_EVENT(TraceEvent::kPark, nullptr, this);
+    auto start = std::chrono::steady_clock::now();
+    bool io = false;
+    if (!poller_) {
+        parker_.park();
+    } else {
+        if (parker_.begin_park()) io = poll(-1);
+        parker_.end_park();
+    }
+    TINYCORO_TRACE_EVENT(TraceEvent::kUnpark, nullptr, this);
+    auto slept = std::chrono::steady_clock::now() - start;
+    // Work that came back quickly would have been cheaper to spin for, a long sleep was not worth spinning
+    if (slept < kShortPark) spin_limit_ = std::min(spin_limit_ * 2, kSpinMax);
+    else if (slept > kLongPark) spin_limit_ = std::max(spin_limit_ / 2, kSpinMin);
+
+    if (!scheduler_.remove_idle(this)) {
+        spinning_ = true;
+        bump(metrics_.wakeups);
+    } else if (!io) {
+        bump(metrics_.spurious);
+    }
+    return std::nullopt;
+}
+
+inline void Worker::run_once() {
+    ++ticks_;
+    // A busy Worker still owes its connections a look now and then
+    if (poller_ && ticks_ % kPollInterval == 0) poll(0);
+
+    std::optional<Task> task;
+    bool inherit = false;
+    {
+        EbrGuard guard(ebr_state_);
+        if (inbox_ready_.load(std::memory_order_relaxed)) drain_inbox();
+        // Fairness tick: one task from the global queue ahead of run_next_ and the local queue
+        if (ticks_ % kGlobalInterval == 0) {
+            task = scheduler_.pop_global();
+            if (task) {
+                TINYCORO_TRACE_EVENT(TraceEvent::kGlobal, task->handle.address(), this);
+                bump(metrics_.global_pops);
+            }
+        }
+        if (!task) {
+            if (void* ptr = run_next_.exchange(nullptr, std::memory_order_acquire)) {
+                TINYCORO_TRACE_EVENT(TraceEvent::kPop, ptr, this);
+                bump(metrics_.local_pops);
+                task = Task::from_address(ptr);
+                inherit = true;
+            } else if (auto t = local_queue_->pop()) {
+                TINYCORO_TRACE_EVENT(TraceEvent::kPop, t->handle.address(), this);
+                bump(metrics_.local_pops);
+                task = std::move(t);
+            } else if (auto t = pop_global_batch()) task = std::move(t);
+            else if (auto t = scheduler_.steal(*this)) task = std::move(t);
+        }
+    }
+    if (!task && poller_ && poll(0)) return;
+    if (!task) task = spin();
+    if (!task) task = park();
+    if (task) execute(*task, inherit);
+}
+
+// --- Idle set ---
+
+inline void Scheduler::push_idle(Worker* w) {
+    std::lock_guard<SpinLock> lock(idle_lock_);
+    w->idle_ = true;
+    idle_.push_back(w);
+    nidle_.store(idle_.size(), std::memory_order_seq_cst);
+}
+
+inline Worker* Scheduler::pop_idle() {
+    std::lock_guard<SpinLock> lock(idle_lock_);
+    if (idle_.empty()) return nullptr;
+    Worker* w = idle_.back();
+    idle_.pop_back();
+    w->idle_ = false;
+    nidle_.store(idle_.size(), std::memory_order_seq_cst);
+    return w;
+}
+
+inline bool Scheduler::remove_idle(Worker* w) {
+    std::lock_guard<SpinLock> lock(idle_lock_);
+    if (!w->idle_) return false;
+    w->idle_ = false;
+    idle_.erase(std::find(idle_.begin(), idle_.end(), w));
+    nidle_.store(idle_.size(), std::memory_order_seq_cst);
+    return true;
+}
+
+inline SchedulerStats Scheduler::stats() const {
+    SchedulerStats s;
+    auto load = [](const std::atomic<uint64_t>& c) { return c.load(std::memory_order_relaxed); };
+    for (auto& w : workers_) {
+        const WorkerMetrics& m = w->metrics_;
+        WorkerStats ws;
+        ws.local_pops = load(m.local_pops);
+        ws.global_pops = load(m.global_pops);
+        ws.steals = load(m.steals);
+        ws.steal_failures = load(m.steal_failures);
+        ws.parks = load(m.parks);
+        ws.wakeups = load(m.wakeups);
+        ws.spurious_wakeups = load(m.spurious);
+        ws.spin_hits = load(m.spin_hits);
+        ws.spin_misses = load(m.spin_misses);
+        ws.yields = load(m.yields);
+        ws.tasks = ws.local_pops + ws.global_pops + ws.steals; // Every task run came from one of them
+        ws.local_queue = w->local_queue_->size_approx();
+        ws.schedule_latency = m.schedule_latency.snapshot();
+        ws.poll_batch = m.poll_batch.snapshot();
+
+        s.tasks += ws.tasks;
+        s.local_pops += ws.local_pops;
+        s.global_pops += ws.global_pops;
+        s.steals += ws.steals;
+        s.steal_failures += ws.steal_failures;
+        s.parks += ws.parks;
+        s.wakeups += ws.wakeups;
+        s.spurious_wakeups += ws.spurious_wakeups;
+        s.spin_hits += ws.spin_hits;
+        s.spin_misses += ws.spin_misses;
+        s.yields += ws.yields;
+        s.local_queued += ws.local_queue;
+        s.schedule_latency.merge(ws.schedule_latency);
+        s.poll_batch.merge(ws.poll_batch);
+        s.workers.push_back(std::move(ws));
+    }
+    {
+        std::lock_guard<SpinLock> lock(idle_lock_);
+        for (Worker* w : idle_) s.workers[w->id_].idle = true;
+    }
+    s.idle = nidle_.load(std::memory_order_relaxed);
+    s.spinning = nspinning_.load(std::memory_order_relaxed);
+    s.global_queue = global_queue_.size_approx();
+    BlockingPool::Stats b = blocking_->stats();
+    s.blocking_threads = b.threads;
+    s.blocking_queued = b.queued;
+    s.timers = reactor_->timer_count();
+    s.timers_fired = load(reactor_->metrics().timers_fired);
+    s.reactor_waits = load(reactor_->metrics().waits);
+    s.reactor_batch = reactor_->metrics().batch.snapshot();
+    return s;
 }
 
 // Helper Classes
@@ -278,16 +1167,83 @@ class AsyncSleep {
 private:
     Scheduler& sched_;
     std::chrono::milliseconds duration_;
+    TimerHandle* out_;
+    bool fired_ = true;
 public:
-    AsyncSleep(Scheduler& s, std::chrono::milliseconds d) : sched_(s), duration_(d) {}
-    bool await_ready() const noexcept { return false; }
-    void await_suspend(std::coroutine_handle<> h) {
+    // out, if given, receives the cancellable handle as the coroutine suspends
+    AsyncSleep(Scheduler& s, std::chrono::milliseconds d, TimerHandle* out = nullptr)
+        : sched_(s), duration_(d), out_(out) {}
+    bool await_ready() const noexcept { return duration_.count() <= 0; }
+    void await_suspend(std::coroutine_handle<Task::Promise> h) {
         auto expiry = std::chrono::steady_clock::now() + duration_;
-        sched_.reactor()->add_timer(expiry, h);
+        // Nothing may touch *this after add_timer: the sleeper can already be running elsewhere
+        sched_.reactor()->add_timer(expiry, h, &fired_, out_);
     }
-    void await_resume() noexcept {}
+    // true: the full duration elapsed; false: the handle was cancelled
+    bool await_resume() noexcept { return fired_; }
 };
 
-inline AsyncSleep sleep_for(Scheduler& s, int ms) {
-    return AsyncSleep(s, std::chrono::milliseconds(ms));
-}
\ No newline at end of file
+inline AsyncSleep sleep_for(Scheduler& s, int ms, TimerHandle* out = nullptr) {
+    return AsyncSleep(s, std::chrono::milliseconds(ms), out);
+}
+
+// For await_suspend: requeue h behind the global queue and suspend. Returns false (don't suspend)
+// when not called on a Worker.
+inline bool coop_yield(std::coroutine_handle<Task::Promise> h) {
+    Worker* w = Worker::current();
+    if (!w) return false;
+    // Ref +1 (for the queue), usually the running token
+    Task::retain(h);
+    w->yield(h.address());
+    return true;
+}
+
+// co_await yield_now(): let everything already queued run first, e.g. between chunks of a
+// CPU-heavy handler that never waits on anything
+struct YieldAwaiter {
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) { return coop_yield(h); }
+    void await_resume() const noexcept {}
+};
+
+inline YieldAwaiter yield_now() { return {}; }
+
+// Scheduler::spawn_blocking(). The awaiter is the pool's job: no allocation beyond the frame.
+template <typename F>
+class BlockingAwaiter : BlockingPool::Job {
+    using R = std::invoke_result_t<F&>;
+    Scheduler& sched_;
+    F fn_;
+    void* task_ = nullptr;
+    std::conditional_t<std::is_void_v<R>, bool, std::optional<R>> result_{};
+
+    // On a pool thread
+    static void run(BlockingPool::Job* job) {
+        auto* self = static_cast<BlockingAwaiter*>(job);
+        if constexpr (std::is_void_v<R>) self->fn_();
+        else self->result_.emplace(self->fn_());
+        // Not on a Worker, so this is the global queue + wake_idle(). The task may resume (and
+        // *self be gone) as soon as it is queued.
+        Scheduler& sched = self->sched_;
+        sched.spawn(Task::from_address(self->task_));
+    }
+
+public:
+    BlockingAwaiter(Scheduler& s, F fn) : BlockingPool::Job{&BlockingAwaiter::run}, sched_(s), fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<Task::Promise> h) {
+        task_ = h.address();
+        // Ref +1 (for the pool), usually the running token; run() hands it to spawn()
+        Task::retain(h);
+        sched_.blocking_pool().submit(this);
+    }
+    R await_resume() {
+        if constexpr (!std::is_void_v<R>) return std::move(*result_);
+    }
+};
+
+template <typename F>
+BlockingAwaiter<std::decay_t<F>> Scheduler::spawn_blocking(F&& fn) {
+    return BlockingAwaiter<std::decay_t<F>>(*this, std::forward<F>(fn));
+}
@@ -2,12 +2,27 @@
 #pragma once
 
 #include "scheduler.h"
+#include "io_buffer.h"
 #include <sys/socket.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#else
+#include <sys/types.h>
+#endif
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <cstring>
 #include <stdexcept>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <span>
 
 // Non-blocking Mode Setting Utility Function
 inline void set_nonblocking(int fd) {
@@ -15,108 +30,1125 @@ inline void set_nonblocking(int fd) {
     fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
+#ifdef __linux__
+// socket() flags for new fds: non-blocking from birth where the platform allows it
+inline constexpr int kSocketFlags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+#else
+inline constexpr int kSocketFlags = 0;
+#endif
+
+// accept4 hands the fd out non-blocking in the same syscall; elsewhere two fcntl calls follow
+inline int accept_nonblocking(int fd, struct sockaddr* addr, socklen_t* len) {
+#ifdef __linux__
+    return ::accept4(fd, addr, len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int client = ::accept(fd, addr, len);
+    if (client >= 0) set_nonblocking(client);
+    return client;
+#endif
+}
+
+// Pass as timeout to wait forever (the default)
+inline constexpr std::chrono::milliseconds kNoTimeout{-1};
+
 // ==========================================
 // 1. Awaiters (Wait Body)
 // ==========================================
 
-class AsyncReadAwaiter {
+// One fd wait racing a deadline. The fd registration (tagged udata) and the timer callback both
+// fire on the Reactor thread; whichever claims `state` first disarms the other and resumes the
+// task with the single reference taken in await_suspend.
+struct IoDeadline : IoWaiter {
+    enum : uint8_t { kArming = 1, kIoReady = 2, kTimedOut = 4 };
+    std::atomic<uint8_t> state{0};
+    Reactor* reactor = nullptr;
+    int fd = -1;
+    void* task = nullptr;
+    TimerHandle timer;
+    bool deferred = false; // io_uring: the cancelled poll's completion resumes the task
+
+    IoDeadline() { on_ready = &IoDeadline::ready; }
+
+    void arm(Reactor* r, int fd_, void* t, bool write, std::chrono::milliseconds timeout) {
+        reactor = r;
+        fd = fd_;
+        task = t;
+        state.store(kArming, std::memory_order_relaxed);
+        // Timer first, so an early IO event always finds a timer to cancel
+        r->add_timer(std::chrono::steady_clock::now() + timeout, &IoDeadline::expired, this, &timer);
+        if (write) r->register_write(fd_, tag());
+        else r->register_read(fd_, tag());
+        // From here on both sides may complete: nothing in *this may be touched by the arming thread
+        state.fetch_and(~kArming, std::memory_order_acq_rel);
+    }
+
+    bool timed_out() const { return state.load(std::memory_order_acquire) & kTimedOut; }
+
+private:
+    // An event can beat arm() by a few instructions; wait for it to publish both registrations
+    bool claim(uint8_t who) {
+        uint8_t s = state.load(std::memory_order_acquire);
+        while (true) {
+            if (s & kArming) {
+                std::this_thread::yield();
+                s = state.load(std::memory_order_acquire);
+                continue;
+            }
+            if (s != 0) return false;
+            if (state.compare_exchange_weak(s, who, std::memory_order_acq_rel)) return true;
+        }
+    }
+
+    static void* ready(IoWaiter* w) {
+        auto* d = static_cast<IoDeadline*>(w);
+        if (!d->claim(kIoReady)) return d->deferred ? d->task : nullptr;
+        void* t = d->task;
+        d->reactor->cancel_timer(d->timer.id); // Callback timer: cancelling just drops it
+        return t;
+    }
+
+    static void expired(void* arg) {
+        auto* d = static_cast<IoDeadline*>(arg);
+        if (!d->claim(kTimedOut)) return;
+        void* t = d->task;
+        Reactor* r = d->reactor;
+        // On the Reactor thread no event for fd can still be in flight, so epoll/kqueue removal is
+        // final. io_uring cancels asynchronously: its last completion lands in ready() instead.
+        if (r->unregister(d->fd, d->tag())) r->spawn(t);
+        else d->deferred = true;
+    }
+};
+
+#ifdef TINYCORO_IO_URING
+// Completions of one multishot SQE (accepted fds, received chunks), queued by the Reactor thread
+// and consumed by one coroutine at a time. Heap-allocated and owned by its socket; after close()
+// it frees itself once the kernel has delivered the final CQE.
+template <typename Derived, typename Item>
+class UringStream : public IoOp {
+protected:
+    Reactor* reactor_;
+    UringPoller* uring_;
+    int fd_;
+    SpinLock lock_;
+    std::deque<Item> items_;
+    bool armed_ = false;     // A multishot SQE is in flight
+    bool closing_ = false;
+    void* waiter_ = nullptr; // Parked consumer, owning one reference
+    TimerHandle timer_;      // Its deadline, if any
+    bool timed_out_ = false;
+
+    UringStream(Reactor* r, int fd) : reactor_(r), uring_(r->uring()), fd_(fd) {
+        complete = &UringStream::on_cqe;
+    }
+
+    // lock_ held: nothing in flight references *this any more
+    bool idle_locked() const { return !armed_; }
+
+    // lock_ held: keep completions flowing while someone is interested
+    void rearm_locked() {
+        if (!armed_ && !closing_) {
+            armed_ = true;
+            static_cast<Derived*>(this)->submit();
+        }
+    }
+
+    // lock_ held: the deadline passed while the derived stream still owns the waiter's buffer
+    bool defer_timeout_locked() { return false; }
+
+    void* take_waiter_locked() {
+        void* t = waiter_;
+        waiter_ = nullptr;
+        if (timer_) {
+            reactor_->cancel_timer(timer_.id); // Callback timer: cancelling just drops it
+            timer_ = {};
+        }
+        return t;
+    }
+
+public:
+    // Suspend the consumer unless something arrived meanwhile; takes a reference only when parking
+    bool park(std::coroutine_handle<Task::Promise> h, std::chrono::milliseconds timeout) {
+        std::lock_guard<SpinLock> lock(lock_);
+        if (!items_.empty()) return false;
+        rearm_locked();
+        // Ref +1 (for the stream), adopted by spawn() when an item or the deadline arrives
+        Task::retain(h);
+        waiter_ = h.address();
+        timed_out_ = false;
+        if (timeout.count() >= 0) {
+            reactor_->add_timer(std::chrono::steady_clock::now() + timeout, &UringStream::expired, this, &timer_);
+        }
+        return true;
+    }
+
+    ~UringStream() {
+        if (closing_) reactor_->stream_freed();
+    }
+
+    // Called by the owner instead of delete
+    void close() {
+        bool free_now;
+        reactor_->stream_closing();
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            closing_ = true;
+            for (Item& item : items_) static_cast<Derived*>(this)->discard(item);
+            items_.clear();
+            free_now = static_cast<Derived*>(this)->idle_locked();
+        }
+        if (free_now) delete static_cast<Derived*>(this);
+        else uring_->cancel(tag());
+    }
+
+private:
+    static void* on_cqe(IoOp* op, int32_t res, uint32_t flags) {
+        auto* self = static_cast<Derived*>(op);
+        void* t = nullptr;
+        bool dead = false;
+        {
+            std::lock_guard<SpinLock> lock(self->lock_);
+            if (!(flags & IORING_CQE_F_MORE)) self->armed_ = false;
+            if (self->closing_) {
+                self->discard_cqe(res, flags);
+                dead = self->idle_locked();
+            } else if (self->on_completion(res, flags) && self->waiter_) {
+                t = self->take_waiter_locked();
+            }
+        }
+        if (dead) delete self;
+        return t;
+    }
+
+    static void expired(void* arg) {
+        auto* self = static_cast<Derived*>(arg);
+        void* t = nullptr;
+        {
+            std::lock_guard<SpinLock> lock(self->lock_);
+            self->timer_ = {};
+            if (self->waiter_ && !self->defer_timeout_locked()) {
+                t = self->waiter_;
+                self->waiter_ = nullptr;
+                self->timed_out_ = true;
+            }
+        }
+        if (t) self->reactor_->spawn(t);
+    }
+};
+
+// Multishot accept: one SQE for the listener's whole life, one CQE per connection
+class AcceptStream : public UringStream<AcceptStream, int32_t> {
+    friend class UringStream<AcceptStream, int32_t>;
+
+    void submit() { uring_->accept_multishot(fd_, this); }
+    static void discard(int32_t fd) { if (fd >= 0) ::close(fd); }
+    void discard_cqe(int32_t res, uint32_t) { discard(res); }
+    // Returns true if the parked consumer should wake
+    bool on_completion(int32_t res, uint32_t) {
+        items_.push_back(res); // fd or -errno, both delivered in order
+        return true;
+    }
+
+public:
+    AcceptStream(Reactor* r, int fd) : UringStream(r, fd) {}
+
+    // false: nothing queued (the stream is armed so a later park() will be woken)
+    bool try_pop(int& out) {
+        std::lock_guard<SpinLock> lock(lock_);
+        if (timed_out_) {
+            timed_out_ = false;
+            errno = ETIMEDOUT;
+            out = -1;
+            return true;
+        }
+        if (items_.empty()) {
+            rearm_locked();
+            return false;
+        }
+        int32_t r = items_.front();
+        items_.pop_front();
+        if (r < 0) errno = -r;
+        out = r < 0 ? -1 : r;
+        return true;
+    }
+};
+
+// Multishot recv into the Poller's provided buffer ring. Chunks queue up in arrival order and
+// read() copies out of them; a ring that ran dry (ENOBUFS) falls back to one direct read, into the
+// parked reader's buffer or, for a reader parked without one (read(IoBuffer&)), into a BufferPool
+// chunk taken at that moment.
+class RecvStream : public UringStream<RecvStream, RecvStream*> {
+public:
+    struct Chunk {
+        int32_t res;     // > 0 bytes, 0 EOF, < 0 -errno
+        uint16_t bid;
+        uint32_t off;
+    };
+
+private:
+    friend class UringStream<RecvStream, RecvStream*>;
+    std::deque<Chunk> chunks_;
+    // Direct-read fallback for ENOBUFS, filled into the parked reader's buffer or into `data`
+    struct Fallback : IoOp {
+        RecvStream* stream;
+        int32_t res = 0;
+        char* data = nullptr; // BufferPool chunk, copied out like a provided buffer
+        uint32_t off = 0;
+        bool inflight = false;
+        bool cancelled = false; // Deadline passed while in flight
+        bool done = false;
+    } fallback_;
+    void* wait_buf_ = nullptr;
+    size_t wait_len_ = 0;
+
+    void submit() { uring_->recv_multishot(fd_, this); }
+    static void discard(RecvStream*) {}
+    void discard_cqe(int32_t res, uint32_t flags) {
+        if (res > 0 && (flags & IORING_CQE_F_BUFFER)) uring_->recycle(flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+
+    bool idle_locked() const { return !armed_ && !fallback_.inflight; }
+
+    // The fallback read writes into the waiter's buffer: cancel it and let its CQE wake the waiter
+    bool defer_timeout_locked() {
+        if (!fallback_.inflight) return false;
+        fallback_.cancelled = true;
+        uring_->cancel(fallback_.tag());
+        return true;
+    }
+
+    bool on_completion(int32_t res, uint32_t flags) {
+        if (res == -ENOBUFS) {
+            // Every provided buffer is waiting to be consumed; read straight into the caller's buffer
+            if (waiter_ && chunks_.empty() && !fallback_.inflight) {
+                fallback_.inflight = true;
+                fallback_.cancelled = false;
+                if (wait_buf_) {
+                    uring_->read(fd_, wait_buf_, wait_len_, &fallback_);
+                } else {
+                    fallback_.data = static_cast<char*>(BufferPool::allocate());
+                    fallback_.off = 0;
+                    uring_->read(fd_, fallback_.data, BufferPool::kChunkSize, &fallback_);
+                }
+            }
+            return false;
+        }
+        uint16_t bid = (flags & IORING_CQE_F_BUFFER) ? uint16_t(flags >> IORING_CQE_BUFFER_SHIFT) : 0;
+        chunks_.push_back({res, bid, 0});
+        items_.push_back(this); // Non-empty items_ marks "something to consume" for the base class
+        return true;
+    }
+
+    static void* fallback_done(IoOp* op, int32_t res, uint32_t) {
+        RecvStream* self = static_cast<Fallback*>(op)->stream;
+        void* t = nullptr;
+        bool dead = false;
+        {
+            std::lock_guard<SpinLock> lock(self->lock_);
+            Fallback& f = self->fallback_;
+            f.inflight = false;
+            if (self->closing_) {
+                dead = self->idle_locked();
+            } else if (f.cancelled && res == -ECANCELED) {
+                self->release_fallback_locked();
+                self->timed_out_ = true;
+                t = self->waiter_;
+                self->waiter_ = nullptr;
+            } else {
+                f.res = res; // Landed before the cancel: the bytes count
+                f.done = true;
+                t = self->take_waiter_locked();
+            }
+        }
+        if (dead) delete self;
+        return t;
+    }
+
+    void release_fallback_locked() {
+        if (fallback_.data) BufferPool::deallocate(fallback_.data);
+        fallback_.data = nullptr;
+    }
+
+    // lock_ held
+    bool consume_locked(void* buf, size_t n, ssize_t& out) {
+        if (fallback_.done) {
+            Fallback& f = fallback_;
+            if (f.data && f.res > 0) {
+                size_t k = std::min<size_t>(n, size_t(f.res) - f.off);
+                std::memcpy(buf, f.data + f.off, k);
+                f.off += k;
+                if (f.off == uint32_t(f.res)) {
+                    f.done = false;
+                    release_fallback_locked();
+                }
+                out = static_cast<ssize_t>(k);
+                return true;
+            }
+            f.done = false;
+            release_fallback_locked();
+            if (f.res < 0) errno = -f.res;
+            out = f.res < 0 ? -1 : f.res;
+            return true;
+        }
+        if (chunks_.empty()) return false;
+        Chunk& c = chunks_.front();
+        if (c.res > 0) {
+            size_t k = std::min<size_t>(n, size_t(c.res) - c.off);
+            std::memcpy(buf, uring_->buffer(c.bid) + c.off, k);
+            c.off += k;
+            if (c.off == uint32_t(c.res)) {
+                uring_->recycle(c.bid);
+                chunks_.pop_front();
+                items_.pop_front();
+            }
+            out = static_cast<ssize_t>(k);
+        } else if (c.res == 0) {
+            out = 0; // EOF stays queued: every later read sees it too
+        } else {
+            errno = -c.res;
+            out = -1;
+            chunks_.pop_front();
+            items_.pop_front();
+        }
+        return true;
+    }
+
+public:
+    RecvStream(Reactor* r, int fd) : UringStream(r, fd) {
+        fallback_.stream = this;
+        fallback_.complete = &RecvStream::fallback_done;
+    }
+
+    ~RecvStream() {
+        for (Chunk& c : chunks_) if (c.res > 0) uring_->recycle(c.bid);
+        release_fallback_locked();
+    }
+
+    bool try_read(void* buf, size_t n, ssize_t& out) {
+        std::lock_guard<SpinLock> lock(lock_);
+        if (timed_out_) {
+            timed_out_ = false;
+            errno = ETIMEDOUT;
+            out = -1;
+            return true;
+        }
+        if (consume_locked(buf, n, out)) return true;
+        rearm_locked();
+        return false;
+    }
+
+    // buf == nullptr: the reader takes its buffer after waking, and an ENOBUFS fallback reads into a
+    // BufferPool chunk of the stream's own
+    bool park(std::coroutine_handle<Task::Promise> h, void* buf, size_t n, std::chrono::milliseconds timeout) {
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            wait_buf_ = buf;
+            wait_len_ = n;
+        }
+        return UringStream::park(h, timeout);
+    }
+};
+#endif
+
+// Shared by the awaiters below: plain one-shot registration, or IoDeadline when a timeout is set
+class IoWaitBase {
+protected:
     int fd_;
     Reactor* reactor_;
+    std::chrono::milliseconds timeout_;
+    bool suspended_ = false; // errno is thread-local: the coroutine may resume on another Worker
+    IoDeadline deadline_;
+
+    // Persistent registration (epoll / kqueue): the awaiter parks in its direction's slot and the
+    // dispatcher runs attempt_ on every edge, so the coroutine wakes up with its result in hand
+    using Attempt = bool (*)(IoWaitBase*); // Performs the syscall; false on EAGAIN
+    struct Parked : IoWaiter {
+        IoWaitBase* self = nullptr;
+    } parked_;
+    IoRegistration** reg_slot_;
+    IoRegistration* reg_ = nullptr;
+    Attempt attempt_;
+    IoRegistration::Dir dir_;
+    bool registered_ = false;
+    bool timed_out_ = false;
+    int err_ = 0; // errno of a failed attempt, which may have run on another thread
+    std::atomic<bool> arming_{false};
+    void* task_ = nullptr;
+    TimerHandle timer_;
+#ifdef TINYCORO_IO_URING
+    // io_uring without a deadline: the kernel performs the read/write itself and the completion
+    // carries the result, so await_resume needs no second syscall
+    struct DirectOp : IoOp {
+        void* task = nullptr;
+        int32_t res = 0;
+        DirectOp() { complete = &DirectOp::done; }
+        static void* done(IoOp* op, int32_t res, uint32_t) {
+            auto* d = static_cast<DirectOp*>(op);
+            d->res = res;
+            return d->task;
+        }
+    } direct_;
+    bool direct_used_ = false;
+    bool streamed_ = false;
+
+    // Takes the reference and returns the backend to submit to, or nullptr for the poll path
+    UringPoller* direct(std::coroutine_handle<Task::Promise> h) {
+        UringPoller* u = timeout_.count() < 0 ? reactor_->uring() : nullptr;
+        if (!u) return nullptr;
+        suspended_ = direct_used_ = true;
+        direct_.task = h.address();
+        // Ref +1 (for the in-flight op), adopted by spawn() on completion
+        Task::retain(h);
+        return u;
+    }
+
+    ssize_t direct_result() {
+        if (direct_.res < 0) {
+            errno = -direct_.res;
+            return -1;
+        }
+        return direct_.res;
+    }
+#endif
+
+    IoWaitBase(int fd, Reactor* r, std::chrono::milliseconds timeout, IoRegistration** reg,
+               IoRegistration::Dir dir, Attempt attempt)
+        : fd_(fd), reactor_(r), timeout_(timeout), reg_slot_(reg), attempt_(attempt), dir_(dir) {
+        parked_.self = this;
+        parked_.on_ready = &IoWaitBase::on_edge;
+    }
+
+    // false if the result is already in (no suspension)
+    bool suspend(std::coroutine_handle<Task::Promise> h) {
+#ifdef TINYCORO_IO_URING
+        bool persistent = !reactor_->uring(); // io_uring has no persistent mode; skip the attempt
+#else
+        bool persistent = true;
+#endif
+        if (reg_slot_ && !*reg_slot_ && persistent) *reg_slot_ = reactor_->watch(fd_);
+        reg_ = reg_slot_ ? *reg_slot_ : nullptr;
+        // A deadline needs the timer wheel's thread to dispatch the edges too; a Worker's
+        // registration falls back to a one-shot wait on the Reactor's Poller
+        if (reg_ && (timeout_.count() < 0 || reg_->owner->on_reactor())) return park(h);
+        suspend_oneshot(h, dir_ == IoRegistration::kWrite);
+        return true;
+    }
+
+    void suspend_oneshot(std::coroutine_handle<Task::Promise> h, bool write) {
+        suspended_ = true;
+        // Ref +1 (for Reactor), handed to whichever registration completes
+        Task::retain(h);
+        if (timeout_.count() >= 0) {
+            deadline_.arm(reactor_, fd_, h.address(), write, timeout_);
+        } else if (write) {
+            reactor_->register_write(fd_, h.address());
+        } else {
+            reactor_->register_read(fd_, h.address());
+        }
+    }
+
+    // await_ready finished the operation without suspending: charge the running task's
+    // CoopBudget. Once that is spent, report "not ready" instead, so await_suspend yields with the
+    // result in hand and await_resume returns it like a registered wait's (errno restored).
+    bool yield_ = false;
+    bool finished_inline() {
+        if (CoopBudget::consume()) return true;
+        yield_ = registered_ = true;
+        return false;
+    }
+
+    // After resumption: true if the deadline won, in which case errno is set to ETIMEDOUT
+    bool check_timeout() {
+        if (!(registered_ ? timed_out_ : deadline_.timed_out())) return false;
+        errno = ETIMEDOUT;
+        return true;
+    }
+
+    // After a registered wait: the attempt's outcome, errno restored on this thread
+    template <typename T>
+    T registered_result(T result) {
+        if (result < 0) errno = err_;
+        return result;
+    }
+
+private:
+    bool park(std::coroutine_handle<Task::Promise> h) {
+        registered_ = true;
+        task_ = h.address();
+        bool timed = timeout_.count() >= 0;
+        if (timed) arming_.store(true, std::memory_order_relaxed);
+        // Ref +1 (for the registration slot), adopted by spawn() on completion
+        bool token = Task::retain(h);
+        while (!reg_->park(dir_, &parked_)) {
+            // An edge was pending: retry right here, and stay on this thread if that finishes
+            if (attempt_(this)) {
+                Task::unretain(h, token);
+                arming_.store(false, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        if (timed) {
+            // Parked: an edge may already be on the Reactor waiting for this timer to exist
+            reactor_->add_timer(std::chrono::steady_clock::now() + timeout_, &IoWaitBase::expired, this, &timer_);
+            arming_.store(false, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Dispatcher thread. Timed waits are only parked on the Reactor's registry, so on_edge and
+    // expired never run concurrently: whichever runs first settles the wait.
+    static void* on_edge(IoWaiter* w) {
+        IoWaitBase* self = static_cast<Parked*>(w)->self;
+        while (self->arming_.load(std::memory_order_acquire)) std::this_thread::yield();
+        while (!self->attempt_(self)) {
+            // Stale edge: nothing may touch *self once it is parked again
+            if (self->reg_->park(self->dir_, w)) return nullptr;
+        }
+        if (self->timeout_.count() >= 0) self->reactor_->cancel_timer(self->timer_.id);
+        return self->task_;
+    }
+
+    static void expired(void* arg) {
+        auto* self = static_cast<IoWaitBase*>(arg);
+        while (self->arming_.load(std::memory_order_acquire)) std::this_thread::yield();
+        if (!self->reg_->unpark(self->dir_, &self->parked_)) return;
+        self->timed_out_ = true;
+        self->reactor_->spawn(self->task_);
+    }
+};
+
+#ifdef TINYCORO_IO_URING
+using RecvStreamSlot = RecvStream*;
+using AcceptStreamSlot = AcceptStream*;
+#else
+using RecvStreamSlot = void*;
+using AcceptStreamSlot = void*;
+#endif
+
+class AsyncReadAwaiter : IoWaitBase {
     void* buffer_;
     size_t size_;
     ssize_t result_{0};
+    RecvStreamSlot* stream_; // Owner's multishot recv state (io_uring), created on first wait
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncReadAwaiter*>(base);
+        self->result_ = ::read(self->fd_, self->buffer_, self->size_);
+        if (self->result_ >= 0) return true;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+        self->err_ = errno;
+        return true;
+    }
 
 public:
-    AsyncReadAwaiter(int fd, Reactor* r, void* buf, size_t sz)
-        : fd_(fd), reactor_(r), buffer_(buf), size_(sz) {}
+    AsyncReadAwaiter(int fd, Reactor* r, void* buf, size_t sz, std::chrono::milliseconds timeout = kNoTimeout,
+                     IoRegistration** reg = nullptr, RecvStreamSlot* stream = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kRead, &AsyncReadAwaiter::attempt),
+          buffer_(buf), size_(sz), stream_(stream) {}
 
     bool await_ready() {
-        result_ = ::read(fd_, buffer_, size_);
-        if (result_ >= 0) return true;
-        if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
-        return true;
+#ifdef TINYCORO_IO_URING
+        // Once multishot recv is running, the socket's bytes arrive through the stream only
+        if (stream_ && *stream_) {
+            streamed_ = true;
+            return (*stream_)->try_read(buffer_, size_, result_) && finished_inline();
+        }
+#endif
+        return attempt(this) && finished_inline();
     }
 
-    void await_suspend(std::coroutine_handle<Task::Promise> h) {
-        // Ref +1 (for Reactor)
-        h.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
-        reactor_->register_read(fd_, h.address());
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h);
+#ifdef TINYCORO_IO_URING
+        if (UringPoller* u = reactor_->uring()) {
+            if (stream_ && u->multishot_recv()) {
+                if (!*stream_) *stream_ = new RecvStream(reactor_, fd_);
+                streamed_ = suspended_ = true;
+                return (*stream_)->park(h, buffer_, size_, timeout_);
+            }
+            if ((u = direct(h))) {
+                u->read(fd_, buffer_, size_, &direct_);
+                return true;
+            }
+        }
+#endif
+        return suspend(h);
     }
 
+    // -1 with errno == ETIMEDOUT if the deadline passed first
     ssize_t await_resume() {
-        if (result_ < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+#ifdef TINYCORO_IO_URING
+        if (streamed_) {
+            if (suspended_ && !(*stream_)->try_read(buffer_, size_, result_)) {
+                errno = EAGAIN; // Woken with nothing to read; not expected
+                result_ = -1;
+            }
+            return result_;
+        }
+        if (direct_used_) return result_ = direct_result();
+#endif
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return -1;
             result_ = ::read(fd_, buffer_, size_);
         }
         return result_;
     }
 };
 
-class AsyncWriteAwaiter {
-    int fd_;
-    Reactor* reactor_;
-    const void* buffer_;
-    size_t size_;
+// read(IoBuffer&): read() into the buffer's tail. The attempt takes a chunk just for the syscall and
+// hands it back if the socket had nothing, so a connection parked here holds no buffer memory.
+// Multishot recv parks without one too: the bytes wait in the ring's provided buffers. Only a
+// direct io_uring read keeps its chunk, since the kernel writes into it while the read is queued.
+class AsyncBufferReadAwaiter : IoWaitBase {
+    IoBuffer& buf_;
     ssize_t result_{0};
+    RecvStreamSlot* stream_;
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncBufferReadAwaiter*>(base);
+        auto [p, room] = self->buf_.prepare();
+        self->result_ = ::read(self->fd_, p, room);
+        if (self->result_ > 0) {
+            self->buf_.commit(self->result_);
+            return true;
+        }
+        int err = errno;
+        self->buf_.trim();
+        errno = err;
+        if (self->result_ == 0) return true;
+        if (err == EAGAIN || err == EWOULDBLOCK) return false;
+        self->err_ = err;
+        return true;
+    }
+
+#ifdef TINYCORO_IO_URING
+    bool stream_read() {
+        auto [p, room] = buf_.prepare();
+        bool got = (*stream_)->try_read(p, room, result_);
+        if (got && result_ > 0) {
+            buf_.commit(result_);
+        } else {
+            int err = errno;
+            buf_.trim();
+            errno = err;
+        }
+        return got;
+    }
+#endif
 
 public:
-    AsyncWriteAwaiter(int fd, Reactor* r, const void* buf, size_t sz)
-        : fd_(fd), reactor_(r), buffer_(buf), size_(sz) {}
+    AsyncBufferReadAwaiter(int fd, Reactor* r, IoBuffer& buf, std::chrono::milliseconds timeout = kNoTimeout,
+                           IoRegistration** reg = nullptr, RecvStreamSlot* stream = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kRead, &AsyncBufferReadAwaiter::attempt),
+          buf_(buf), stream_(stream) {}
 
     bool await_ready() {
-        result_ = ::write(fd_, buffer_, size_);
-        if (result_ >= 0) return true;
+#ifdef TINYCORO_IO_URING
+        if (stream_ && *stream_) {
+            streamed_ = true;
+            return stream_read() && finished_inline();
+        }
+#endif
+        return attempt(this) && finished_inline();
+    }
+
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h);
+#ifdef TINYCORO_IO_URING
+        if (UringPoller* u = reactor_->uring()) {
+            if (stream_ && u->multishot_recv()) {
+                if (!*stream_) *stream_ = new RecvStream(reactor_, fd_);
+                streamed_ = suspended_ = true;
+                return (*stream_)->park(h, nullptr, 0, timeout_); // stream_read() takes the chunk on wake-up
+            }
+            if ((u = direct(h))) {
+                // The kernel writes into the tail chunk while the read is queued
+                auto [p, room] = buf_.prepare();
+                u->read(fd_, p, room, &direct_);
+                return true;
+            }
+        }
+#endif
+        return suspend(h);
+    }
+
+    // Bytes appended to the buffer; 0 at EOF, -1 with errno set (ETIMEDOUT if the deadline passed)
+    ssize_t await_resume() {
+#ifdef TINYCORO_IO_URING
+        if (streamed_) {
+            if (suspended_ && !stream_read()) {
+                errno = EAGAIN; // Woken with nothing to read; not expected
+                result_ = -1;
+            }
+            return result_;
+        }
+        if (direct_used_) {
+            result_ = direct_result();
+            if (result_ > 0) {
+                buf_.commit(result_);
+            } else {
+                int err = errno;
+                buf_.trim(); // EOF or error: nothing landed in the chunk
+                errno = err;
+            }
+            return result_;
+        }
+#endif
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return -1;
+            attempt(this);
+        }
+        return result_;
+    }
+};
+
+class AsyncWriteAwaiter : IoWaitBase {
+    const void* buffer_;
+    size_t size_;
+    ssize_t result_{0};
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncWriteAwaiter*>(base);
+        self->result_ = ::write(self->fd_, self->buffer_, self->size_);
+        if (self->result_ >= 0) return true;
         if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+        self->err_ = errno;
         return true;
     }
 
-    void await_suspend(std::coroutine_handle <Task::Promise> h) {
-        // Ref +1 (for Reactor)
-        h.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
-        reactor_->register_write(fd_, h.address());
+public:
+    AsyncWriteAwaiter(int fd, Reactor* r, const void* buf, size_t sz, std::chrono::milliseconds timeout = kNoTimeout,
+                      IoRegistration** reg = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kWrite, &AsyncWriteAwaiter::attempt),
+          buffer_(buf), size_(sz) {}
+
+    bool await_ready() { return attempt(this) && finished_inline(); }
+
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h);
+#ifdef TINYCORO_IO_URING
+        if (UringPoller* u = direct(h)) {
+            u->write(fd_, buffer_, size_, &direct_);
+            return true;
+        }
+#endif
+        return suspend(h);
     }
 
+    // -1 with errno == ETIMEDOUT if the deadline passed first
     ssize_t await_resume() {
-        if (result_ < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+#ifdef TINYCORO_IO_URING
+        if (direct_used_) return result_ = direct_result();
+#endif
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return -1;
             result_ = ::write(fd_, buffer_, size_);
         }
         return result_;
     }
 };
 
+// Gathered write: one writev() for the whole iovec array, which is advanced in place as bytes go
+// out. With `all` (write_all) short writes are continued until every byte is sent: a persistent
+// registration retries on each edge in the dispatcher, io_uring resubmits the rest from the
+// completion, and the coroutine wakes up once with the total. Only a one-shot wait with a
+// deadline can still come back short, after its single retry.
+class AsyncWritevAwaiter : IoWaitBase {
+    iovec* iov_;
+    int iovcnt_;
+    bool all_;
+    size_t done_ = 0;
+    ssize_t result_{0};
+    iovec one_; // write_all(buf, n)
+
+    // Drop what the kernel took from the front of the array
+    void advance(size_t n) {
+        done_ += n;
+        while (iovcnt_ > 0 && n >= iov_->iov_len) {
+            n -= iov_->iov_len;
+            ++iov_;
+            --iovcnt_;
+        }
+        if (n) {
+            iov_->iov_base = static_cast<char*>(iov_->iov_base) + n;
+            iov_->iov_len -= n;
+        }
+    }
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncWritevAwaiter*>(base);
+        while (true) {
+            ssize_t n = ::writev(self->fd_, self->iov_, std::min(self->iovcnt_, IOV_MAX));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if (self->done_ == 0 || self->all_) return false;
+                    self->result_ = self->done_; // Partial writev(): report what went out
+                    return true;
+                }
+                self->err_ = errno;
+                self->result_ = -1;
+                return true;
+            }
+            self->advance(n);
+            if (!self->all_ || self->iovcnt_ == 0) {
+                self->result_ = self->done_;
+                return true;
+            }
+        }
+    }
+
+#ifdef TINYCORO_IO_URING
+    struct VecOp : IoOp {
+        AsyncWritevAwaiter* self = nullptr;
+        UringPoller* uring = nullptr;
+        void* task = nullptr;
+        VecOp() { complete = &VecOp::done; }
+        static void* done(IoOp* op, int32_t res, uint32_t) {
+            auto* v = static_cast<VecOp*>(op);
+            AsyncWritevAwaiter* a = v->self;
+            if (res < 0) {
+                a->err_ = -res;
+                a->result_ = -1;
+                return v->task;
+            }
+            a->advance(res);
+            if (a->all_ && a->iovcnt_ > 0 && res > 0) {
+                v->uring->writev(a->fd_, a->iov_, std::min(a->iovcnt_, IOV_MAX), v);
+                return nullptr;
+            }
+            a->result_ = a->done_;
+            return v->task;
+        }
+    } vec_op_;
+#endif
+
+public:
+    AsyncWritevAwaiter(int fd, Reactor* r, std::span<iovec> iov, bool all,
+                       std::chrono::milliseconds timeout = kNoTimeout, IoRegistration** reg = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kWrite, &AsyncWritevAwaiter::attempt),
+          iov_(iov.data()), iovcnt_(static_cast<int>(iov.size())), all_(all) {}
+
+    AsyncWritevAwaiter(int fd, Reactor* r, const void* buf, size_t n,
+                       std::chrono::milliseconds timeout = kNoTimeout, IoRegistration** reg = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kWrite, &AsyncWritevAwaiter::attempt),
+          iov_(&one_), iovcnt_(1), all_(true), one_{const_cast<void*>(buf), n} {}
+
+    bool await_ready() {
+        if (iovcnt_ == 0) return true;
+        return attempt(this) && finished_inline();
+    }
+
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h);
+#ifdef TINYCORO_IO_URING
+        if (UringPoller* u = direct(h)) {
+            vec_op_.self = this;
+            vec_op_.uring = u;
+            vec_op_.task = h.address();
+            u->writev(fd_, iov_, std::min(iovcnt_, IOV_MAX), &vec_op_);
+            return true;
+        }
+#endif
+        return suspend(h);
+    }
+
+    // Bytes written; -1 on error (errno == ETIMEDOUT if the deadline passed first)
+    ssize_t await_resume() {
+#ifdef TINYCORO_IO_URING
+        if (direct_used_) return registered_result(result_);
+#endif
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return done_ ? static_cast<ssize_t>(done_) : -1;
+            if (!attempt(this)) { // Still full after the one retry
+                if (done_) return static_cast<ssize_t>(done_);
+                errno = EAGAIN;
+                return -1;
+            }
+            return registered_result(result_);
+        }
+        return result_;
+    }
+};
+
+// File -> socket inside the kernel (sendfile(2)): no user-space copy of the file's bytes. Like
+// write_all, it keeps going until `count` bytes are out, parking on EAGAIN, and stops early at the
+// end of the file. The page-cache read itself is synchronous.
+class AsyncSendfileAwaiter : IoWaitBase {
+    int file_fd_;
+    off_t offset_;
+    size_t left_;
+    size_t done_ = 0;
+    ssize_t result_{0};
+
+    // Bytes sent, 0 at end of file, -1 with errno
+    ssize_t send_chunk() {
+#ifdef __linux__
+        return ::sendfile(fd_, file_fd_, &offset_, left_); // Advances offset_
+#else
+        off_t len = static_cast<off_t>(left_);
+        int rc = ::sendfile(file_fd_, fd_, offset_, &len, nullptr, 0);
+        // macOS reports partial progress together with EAGAIN / EINTR
+        if (rc < 0 && len == 0) return -1;
+        offset_ += len;
+        return len;
+#endif
+    }
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncSendfileAwaiter*>(base);
+        while (self->left_ > 0) {
+            ssize_t n = self->send_chunk();
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+                self->err_ = errno;
+                self->result_ = -1;
+                return true;
+            }
+            if (n == 0) break; // File shorter than asked
+            self->done_ += n;
+            self->left_ -= n;
+        }
+        self->result_ = self->done_;
+        return true;
+    }
+
+public:
+    AsyncSendfileAwaiter(int fd, Reactor* r, int file_fd, off_t offset, size_t count,
+                         std::chrono::milliseconds timeout = kNoTimeout, IoRegistration** reg = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kWrite, &AsyncSendfileAwaiter::attempt),
+          file_fd_(file_fd), offset_(offset), left_(count) {}
+
+    bool await_ready() { return attempt(this) && finished_inline(); }
+
+    // io_uring has no sendfile op: readiness path on every backend
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) { return yield_ ? coop_yield(h) : suspend(h); }
+
+    // Bytes sent; -1 on error (errno == ETIMEDOUT if the deadline passed first)
+    ssize_t await_resume() {
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return done_ ? static_cast<ssize_t>(done_) : -1;
+            if (!attempt(this)) { // Still full after the one retry
+                if (done_) return static_cast<ssize_t>(done_);
+                errno = EAGAIN;
+                return -1;
+            }
+            return registered_result(result_);
+        }
+        return result_;
+    }
+};
+
+#ifdef __linux__
+// Socket -> pipe inside the kernel (splice(2)), waiting for the socket to become readable. The
+// pipe must have room: drain it after every call, so EAGAIN can only mean "socket empty".
+class AsyncSpliceAwaiter : IoWaitBase {
+    int pipe_fd_;
+    size_t max_;
+    ssize_t result_{0};
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncSpliceAwaiter*>(base);
+        self->result_ = ::splice(self->fd_, nullptr, self->pipe_fd_, nullptr, self->max_,
+                                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (self->result_ >= 0) return true;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+        self->err_ = errno;
+        return true;
+    }
+
+public:
+    AsyncSpliceAwaiter(int fd, Reactor* r, int pipe_fd, size_t max,
+                       std::chrono::milliseconds timeout = kNoTimeout, IoRegistration** reg = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kRead, &AsyncSpliceAwaiter::attempt),
+          pipe_fd_(pipe_fd), max_(max) {}
+
+    bool await_ready() { return attempt(this) && finished_inline(); }
+
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) { return yield_ ? coop_yield(h) : suspend(h); }
+
+    // Bytes moved, 0 at end of stream; -1 on error (errno == ETIMEDOUT if the deadline passed first)
+    ssize_t await_resume() {
+        if (registered_) return check_timeout() ? -1 : registered_result(result_);
+        if (suspended_) {
+            if (check_timeout()) return -1;
+            attempt(this);
+            return registered_result(result_);
+        }
+        return result_;
+    }
+};
+#endif
+
 // Forward Declaration
 class AsyncSocket;
 
-class AsyncAcceptAwaiter {
-    int fd_;
-    Reactor* reactor_;
+class AsyncAcceptAwaiter : IoWaitBase {
     struct sockaddr* addr_;
     socklen_t* len_;
     int client_fd_{-1};
+    AcceptStreamSlot* stream_; // Listener's multishot accept state (io_uring)
+
+    static bool attempt(IoWaitBase* base) {
+        auto* self = static_cast<AsyncAcceptAwaiter*>(base);
+        self->client_fd_ = accept_nonblocking(self->fd_, self->addr_, self->len_);
+        if (self->client_fd_ >= 0) return true;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+        self->err_ = errno;
+        return true;
+    }
 
 public:
-    AsyncAcceptAwaiter(int fd, Reactor* r, struct sockaddr* a, socklen_t* l)
-        : fd_(fd), reactor_(r), addr_(a), len_(l) {}
+    AsyncAcceptAwaiter(int fd, Reactor* r, struct sockaddr* a, socklen_t* l,
+                       std::chrono::milliseconds timeout = kNoTimeout, IoRegistration** reg = nullptr,
+                       AcceptStreamSlot* stream = nullptr)
+        : IoWaitBase(fd, r, timeout, reg, IoRegistration::kRead, &AsyncAcceptAwaiter::attempt),
+          addr_(a), len_(l), stream_(stream) {}
 
     bool await_ready() {
-        client_fd_ = ::accept(fd_, addr_, len_);
-        if (client_fd_ >= 0) {
-            set_nonblocking(client_fd_);
-            return true;
+#ifdef TINYCORO_IO_URING
+        // Multishot accept cannot report peer addresses; callers asking for one take the classic path
+        UringPoller* u = reactor_->uring();
+        if (stream_ && !addr_ && u && u->multishot_accept()) {
+            if (!*stream_) *stream_ = new AcceptStream(reactor_, fd_);
+            streamed_ = true;
+            return (*stream_)->try_pop(client_fd_) && finished_inline();
         }
-        if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
-        return true;
+#endif
+        return attempt(this) && finished_inline();
     }
 
-    void await_suspend(std::coroutine_handle<Task::Promise> h) {
-        // Ref +1 (for Reactor)
-        h.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
-        reactor_->register_read(fd_, h.address());
+    bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+        if (yield_) return coop_yield(h);
+#ifdef TINYCORO_IO_URING
+        if (streamed_) {
+            suspended_ = true;
+            return (*stream_)->park(h, timeout_);
+        }
+#endif
+        return suspend(h);
     }
 
+    // -1 with errno == ETIMEDOUT if the deadline passed first
     int await_resume() {
-        if (client_fd_ < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            client_fd_ = ::accept(fd_, addr_, len_);
-            if (client_fd_ >= 0) set_nonblocking(client_fd_);
+#ifdef TINYCORO_IO_URING
+        if (streamed_) {
+            if (suspended_ && !(*stream_)->try_pop(client_fd_)) {
+                errno = EAGAIN;
+                client_fd_ = -1;
+            }
+            return client_fd_;
+        }
+#endif
+        if (registered_) return check_timeout() ? -1 : registered_result(client_fd_);
+        if (suspended_) {
+            if (check_timeout()) return -1;
+            client_fd_ = accept_nonblocking(fd_, addr_, len_);
         }
         return client_fd_;
     }
@@ -129,22 +1161,42 @@ public:
 class AsyncSocket {
     int fd_;
     Reactor* reactor_;
+    IoRegistration* reg_ = nullptr; // Persistent epoll / kqueue registration, made by the first wait
+    RecvStreamSlot recv_ = nullptr; // io_uring multishot recv, created by the first read that waits
+
+    void release() {
+#ifdef TINYCORO_IO_URING
+        if (recv_) recv_->close();
+#endif
+        recv_ = nullptr;
+        if (reg_) reg_->owner->unwatch(reg_);
+        reg_ = nullptr;
+        if (fd_ != -1) ::close(fd_); // Use ::close here to prevent recursion
+    }
 
 public:
-    AsyncSocket(int fd, Reactor* r) : fd_(fd), reactor_(r) {
-        if (fd_ != -1) set_nonblocking(fd_);
+    // `nonblocking`: the fd already is (accepted by accept_nonblocking), skip the fcntl round trip
+    AsyncSocket(int fd, Reactor* r, bool nonblocking = false) : fd_(fd), reactor_(r) {
+        if (fd_ != -1 && !nonblocking) set_nonblocking(fd_);
     }
 
-    AsyncSocket(AsyncSocket&& other) noexcept : fd_(other.fd_), reactor_(other.reactor_) {
+    AsyncSocket(AsyncSocket&& other) noexcept
+        : fd_(other.fd_), reactor_(other.reactor_), reg_(other.reg_), recv_(other.recv_) {
         other.fd_ = -1;
+        other.reg_ = nullptr;
+        other.recv_ = nullptr;
     }
 
     AsyncSocket& operator=(AsyncSocket&& other) noexcept {
         if (this != &other) {
-            if (fd_ != -1) ::close(fd_); // Use ::close here to prevent recursion
+            release();
             fd_ = other.fd_;
             reactor_ = other.reactor_;
+            reg_ = other.reg_;
+            recv_ = other.recv_;
             other.fd_ = -1;
+            other.reg_ = nullptr;
+            other.recv_ = nullptr;
         }
         return *this;
     }
@@ -152,21 +1204,57 @@ public:
     AsyncSocket(const AsyncSocket&) = delete;
     AsyncSocket& operator=(const AsyncSocket&) = delete;
 
-    ~AsyncSocket() {
-        if (fd_ != -1) ::close(fd_);
+    ~AsyncSocket() { release(); }
+
+    // With a timeout, the wait gives up after `timeout` and returns -1 / ETIMEDOUT.
+    // One read and one write may be pending at the same time (from different coroutines).
+    AsyncReadAwaiter read(void* buf, size_t size, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncReadAwaiter(fd_, reactor_, buf, size, timeout, &reg_, &recv_);
+    }
+
+    // Appends to `buf`, taking a pooled chunk only once there are bytes to receive
+    AsyncBufferReadAwaiter read(IoBuffer& buf, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncBufferReadAwaiter(fd_, reactor_, buf, timeout, &reg_, &recv_);
+    }
+
+    AsyncWriteAwaiter write(const void* buf, size_t size, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncWriteAwaiter(fd_, reactor_, buf, size, timeout, &reg_);
+    }
+
+    AsyncWriteAwaiter write(const std::string& s, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncWriteAwaiter(fd_, reactor_, s.data(), s.size(), timeout, &reg_);
+    }
+
+    // One gathered syscall; may be short like write(). The iovecs are advanced in place.
+    AsyncWritevAwaiter writev(std::span<iovec> iov, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncWritevAwaiter(fd_, reactor_, iov, false, timeout, &reg_);
+    }
+
+    // Loops on short writes until everything is sent or an error occurs; returns the total
+    AsyncWritevAwaiter write_all(std::span<iovec> iov, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncWritevAwaiter(fd_, reactor_, iov, true, timeout, &reg_);
     }
 
-    AsyncReadAwaiter read(void* buf, size_t size) {
-        return AsyncReadAwaiter(fd_, reactor_, buf, size);
+    AsyncWritevAwaiter write_all(const void* buf, size_t size, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncWritevAwaiter(fd_, reactor_, buf, size, timeout, &reg_);
     }
 
-    AsyncWriteAwaiter write(const void* buf, size_t size) {
-        return AsyncWriteAwaiter(fd_, reactor_, buf, size);
+    // Up to `count` bytes of file_fd from `offset`, kernel to kernel; returns the total sent
+    AsyncSendfileAwaiter sendfile(int file_fd, off_t offset, size_t count,
+                                  std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncSendfileAwaiter(fd_, reactor_, file_fd, offset, count, timeout, &reg_);
     }
 
-    AsyncWriteAwaiter write(const std::string& s) {
-        return AsyncWriteAwaiter(fd_, reactor_, s.data(), s.size());
+#ifdef __linux__
+    // Up to `max` received bytes into the write end of a pipe, without a user-space copy.
+    // Not while an io_uring RecvStream owns the socket's bytes (see recv_streamed()).
+    AsyncSpliceAwaiter splice_to(int pipe_fd, size_t max, std::chrono::milliseconds timeout = kNoTimeout) {
+        return AsyncSpliceAwaiter(fd_, reactor_, pipe_fd, max, timeout, &reg_);
     }
+#endif
+
+    // io_uring multishot recv is running: received bytes must be taken with read()
+    bool recv_streamed() const { return recv_ != nullptr; }
 
     int fd() const { return fd_; }
 };
@@ -175,39 +1263,64 @@ public:
 // 3. TcpListener
 // ==========================================
 
+struct ListenOptions {
+    int backlog = 4096;
+    // SO_REUSEPORT: several listeners share the port and the kernel spreads new connections over them
+    bool reuse_port = false;
+    // SO_INCOMING_CPU (Linux, with reuse_port): prefer this listener for connections whose packets
+    // the kernel processes on that CPU. -1: unset
+    int incoming_cpu = -1;
+};
+
 class TcpListener {
     int fd_;
     Reactor* reactor_;
+    IoRegistration* reg_ = nullptr;     // Persistent epoll / kqueue registration
+    AcceptStreamSlot accept_ = nullptr; // io_uring multishot accept, armed by the first accept()
+
+    void release() {
+#ifdef TINYCORO_IO_URING
+        if (accept_) accept_->close();
+#endif
+        accept_ = nullptr;
+        if (reg_) reg_->owner->unwatch(reg_);
+        reg_ = nullptr;
+        if (fd_ != -1) ::close(fd_);
+    }
 
 public:
     TcpListener(Reactor* r) : fd_(-1), reactor_(r) {}
 
-    ~TcpListener() {
-        if (fd_ != -1) ::close(fd_);
-    }
+    ~TcpListener() { release(); }
 
-    int bind(const char* ip, int port) {
-        if (fd_ != -1) {
-            ::close(fd_);
-        }
-        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int bind(const char* ip, int port, const ListenOptions& opts = {}) {
+        release();
+        fd_ = socket(AF_INET, SOCK_STREAM | kSocketFlags, 0);
         if (fd_ < 0) return -1;
 
         int opt = 1;
         setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if (opts.reuse_port && setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            release();
+            return -1;
+        }
+#ifdef SO_INCOMING_CPU
+        if (opts.incoming_cpu >= 0) {
+            setsockopt(fd_, SOL_SOCKET, SO_INCOMING_CPU, &opts.incoming_cpu, sizeof(opts.incoming_cpu));
+        }
+#endif
 
         struct sockaddr_in addr{};
         addr.sin_family = AF_INET;
         addr.sin_port = htons(port);
         inet_pton(AF_INET, ip, &addr.sin_addr);
 
-        if (::bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0)
-            return -1;
-
-        if (::listen(fd_, 4096) < 0)
+        if (::bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd_, opts.backlog) < 0) {
+            release();
             return -1;
+        }
 
-        set_nonblocking(fd_);
+        if (!kSocketFlags) set_nonblocking(fd_);
         return 0;
     }
 
@@ -215,23 +1328,65 @@ public:
         AsyncAcceptAwaiter awaiter;
         Reactor* r;
 
-        CoAccept(int fd, Reactor* reactor)
-            : awaiter(fd, reactor, nullptr, nullptr), r(reactor) {}
+        CoAccept(int fd, Reactor* reactor, std::chrono::milliseconds timeout, IoRegistration** reg,
+                 AcceptStreamSlot* stream)
+            : awaiter(fd, reactor, nullptr, nullptr, timeout, reg, stream), r(reactor) {}
 
         bool await_ready() { return awaiter.await_ready(); }
 
         // 🟢 Fix: Forward to Awaiter to increment the reference count
-        void await_suspend(std::coroutine_handle<Task::Promise> h) {
-            awaiter.await_suspend(h);
+        bool await_suspend(std::coroutine_handle<Task::Promise> h) {
+            return awaiter.await_suspend(h);
         }
 
         AsyncSocket await_resume() {
             int client_fd = awaiter.await_resume();
-            return AsyncSocket(client_fd, r);
+            return AsyncSocket(client_fd, r, true);
         }
     };
 
-    CoAccept accept() {
-        return CoAccept(fd_, reactor_);
+    // On timeout the returned socket has fd() == -1 and errno == ETIMEDOUT
+    CoAccept accept(std::chrono::milliseconds timeout = kNoTimeout) {
+        return CoAccept(fd_, reactor_, timeout, &reg_, &accept_);
+    }
+};
+
+// ==========================================
+// 4. Sharded Accept (SO_REUSEPORT)
+// ==========================================
+
+template <typename F>
+Task sharded_accept_loop(Scheduler& sched, std::unique_ptr<TcpListener> listener, F on_accept) {
+    while (sched.is_running()) {
+        // A readiness edge is drained here: accept() only suspends once the backlog is empty
+        AsyncSocket client = co_await listener->accept();
+        if (client.fd() < 0) {
+            // Out of fds: back off instead of spinning on a backlog we cannot take from
+            if (errno == EMFILE || errno == ENFILE) co_await sleep_for(sched, 10);
+            continue;
+        }
+        // On this Worker: the new task takes its run_next_ slot
+        sched.spawn(on_accept(std::move(client)));
     }
-};
\ No newline at end of file
+}
+
+// One SO_REUSEPORT listener and accept loop per Worker. The kernel spreads connections across the
+// listeners, and each loop starts on its own Worker: with poller_per_worker its fd registration
+// (and so its wake-ups) belongs to that Worker, and the connections it spawns start there too.
+// With pinned Workers each listener also asks for the connections processed on its CPU.
+// on_accept(AsyncSocket) returns the connection's Task. false if any listener failed to bind.
+template <typename F>
+bool serve_sharded(Scheduler& sched, const char* ip, int port, F on_accept, ListenOptions opts = {}) {
+    opts.reuse_port = true;
+    std::vector<std::unique_ptr<TcpListener>> listeners;
+    for (size_t i = 0; i < sched.worker_count(); ++i) {
+        auto l = std::make_unique<TcpListener>(sched.reactor());
+        opts.incoming_cpu = sched.worker_cpu(i);
+        if (l->bind(ip, port, opts) < 0) return false;
+        listeners.push_back(std::move(l));
+    }
+    for (size_t i = 0; i < listeners.size(); ++i) {
+        sched.spawn_on(i, sharded_accept_loop(sched, std::move(listeners[i]), on_accept));
+    }
+    return true;
+}
@@ -2,6 +2,18 @@
 #pragma once
 #include <atomic>
 #include <thread>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// One spin-wait hint: PAUSE on x86, YIELD on ARM, nothing elsewhere
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
 
 // Lightweight spinlock, to be used with std::lock_guard
 struct SpinLock {
@@ -14,13 +26,7 @@ struct SpinLock {
                 return;
             }
             // Busy waiting (Spin)
-            while (lock_.load(std::memory_order_relaxed)) {
-#if defined(__x86_64__) || defined(_M_X64)
-                _mm_pause();
-#elif defined(__aarch64__)
-                asm volatile("yield");
-#endif
-            }
+            while (lock_.load(std::memory_order_relaxed)) cpu_relax();
         }
     }
 
@@ -2,32 +2,59 @@
 #pragma once
 #include <coroutine>
 #include <atomic>
+#include <cstdint>
 #include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "frame_pool.h"
+#include "trace.h"
 
 struct Task {
-    struct Promise {
-        // Use seq_cst for absolute safety
+    // Everything the runtime needs from a frame. Queues, Workers and awaiters see every coroutine
+    // (Task or Lazy<T>) as a std::coroutine_handle<Task::Promise>, so promise types add no data
+    // before this base and keep its alignment (checked in Lazy<T>).
+    struct PromiseBase {
+        // Increments are relaxed (the new owner already holds a reference, as with shared_ptr);
+        // the decrement that may destroy the frame is acq_rel
         std::atomic<int> ref_count{1};
-        std::atomic<bool> is_running{false};
+        // Set by whoever co_awaits this coroutine, and owns one reference to it
         std::coroutine_handle<> continuation = nullptr;
+        // steady_clock ns when it last became runnable, if sampled (Scheduler::mark_ready); 0 if not
+        uint64_t ready_at = 0;
+
+#ifndef TINYCORO_NO_FRAME_POOL
+        // Frames come from per-thread size-class lists instead of the global heap
+        static void* operator new(size_t n) { return FramePool::allocate(n); }
+        static void operator delete(void* p, size_t n) noexcept { FramePool::deallocate(p, n); }
+#endif
 
-        Task get_return_object();
         std::suspend_always initial_suspend() noexcept { return {}; }
 
+        // Symmetric transfer to the awaiting coroutine. Its reference becomes the running token;
+        // the token this thread held for the finished coroutine, if any, is released.
         struct FinalAwaiter {
+            PromiseBase& promise;
             bool await_ready() noexcept { return false; }
-            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
-                h.promise().is_running.store(false, std::memory_order_seq_cst);
-                if (h.promise().continuation) return h.promise().continuation;
-                return std::noop_coroutine();
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) noexcept {
+                std::coroutine_handle<> next = promise.continuation;
+                if (!next) return std::noop_coroutine();
+                void* held = running_;
+                running_ = next.address();
+                if (held == h.address()) Task::from_address(held); // Adopted and dropped
+                return next;
             }
             void await_resume() noexcept {}
         };
-        FinalAwaiter final_suspend() noexcept { return {}; }
-        void return_void() {}
+        FinalAwaiter final_suspend() noexcept { return {*this}; }
         void unhandled_exception() { std::terminate(); }
     };
 
+    struct Promise : PromiseBase {
+        Task get_return_object();
+        void return_void() {}
+    };
+
     using promise_type = Promise;
     std::coroutine_handle<Promise> handle;
 
@@ -36,7 +63,7 @@ struct Task {
     Task() : handle(nullptr) {}
 
     explicit Task(std::coroutine_handle<Promise> h) : handle(h) {
-        if (handle) handle.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
+        if (handle) handle.promise().ref_count.fetch_add(1, std::memory_order_relaxed);
     }
 
     // Take over construction (unchanged)
@@ -44,7 +71,7 @@ struct Task {
 
     // Copy (+1)
     Task(const Task& o) : handle(o.handle) {
-        if (handle) handle.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
+        if (handle) handle.promise().ref_count.fetch_add(1, std::memory_order_relaxed);
     }
 
     // Move (unchanged)
@@ -62,7 +89,7 @@ struct Task {
     ~Task() { if (handle) dec_ref(); }
 
     void dec_ref() {
-        if (handle.promise().ref_count.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+        if (handle.promise().ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             handle.destroy();
         }
     }
@@ -80,7 +107,7 @@ struct Task {
     // Compatible interface: only for obtaining the address, no ownership transfer
     void* to_address() {
         if (handle) {
-            handle.promise().ref_count.fetch_add(1, std::memory_order_seq_cst);
+            handle.promise().ref_count.fetch_add(1, std::memory_order_relaxed);
             return handle.address();
         }
         return nullptr;
@@ -92,19 +119,171 @@ struct Task {
         return Task(std::coroutine_handle<Promise>::from_address(ptr), AdoptTag{});
     }
 
+    // A suspended coroutine may be resumed as soon as its handle is published, even while the
+    // suspending thread is still returning from await_suspend: awaiters never touch the frame
+    // after publishing. So nothing here touches the frame once handle.resume() returns either.
     void resume() {
         if (!handle || handle.done()) return;
-        bool expected = false;
-        if (handle.promise().is_running.compare_exchange_strong(expected, true, std::memory_order_seq_cst)) {
-            handle.resume();
-            if (handle && !handle.done()) {
-                handle.promise().is_running.store(false, std::memory_order_seq_cst);
-            }
+        [[maybe_unused]] void* addr = handle.address();
+        TINYCORO_TRACE_EVENT(TraceEvent::kResume, addr, nullptr);
+        handle.resume();
+        TINYCORO_TRACE_EVENT(TraceEvent::kSuspend, addr, nullptr);
+    }
+
+    // Resume while holding the running token. A Worker owns the reference of the task it popped;
+    // if the coroutine suspends by publishing its own handle (retain() below), that reference
+    // moves with the handle. Awaiting another task hands the token down and a finishing child
+    // hands it back up (FinalAwaiter), so on return the token names whichever frame last held it,
+    // if any, and that reference is dropped (typically the coroutine finished).
+    void run() {
+        if (!handle) return;
+        auto h = handle;
+        void* outer = running_;
+        running_ = detach();
+        if (!h.done()) {
+            TINYCORO_TRACE_EVENT(TraceEvent::kResume, h.address(), nullptr);
+            h.resume();
+            TINYCORO_TRACE_EVENT(TraceEvent::kSuspend, h.address(), nullptr);
+        }
+        void* held = running_;
+        running_ = outer;
+        if (held) Task::from_address(held); // Adopted and dropped: the frame may go here
+    }
+
+    // Called by await_suspend right before publishing h (to a queue, the Reactor, a waiter list):
+    // the published address must own one reference. Takes over the running token when h is the
+    // task this thread is running, otherwise adds a reference. Returns true if the token was taken.
+    static bool retain(std::coroutine_handle<Promise> h) {
+        if (running_ == h.address()) {
+            running_ = nullptr;
+            return true;
         }
+        h.promise().ref_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
+
+    // Undo retain() when await_suspend ends up not publishing (and not suspending) after all
+    static void unretain(std::coroutine_handle<Promise> h, bool took_token) {
+        if (took_token) running_ = h.address();
+        else h.promise().ref_count.fetch_sub(1, std::memory_order_relaxed); // The caller still holds one
+    }
+
+    // For await_suspend returning a handle to run right away (symmetric transfer), after the
+    // suspending task has been retain()ed: t's reference becomes this thread's running token.
+    static std::coroutine_handle<> run_inline(Task&& t) {
+        running_ = t.detach();
+        return std::coroutine_handle<>::from_address(running_);
+    }
+
     bool done() const { return !handle || handle.done(); }
+
+    // co_await task: the child starts on this thread by symmetric transfer, with no trip through a
+    // queue, and the parent continues from the child's final_suspend. Await a Task at most once,
+    // and not after spawning it.
+    struct Awaiter {
+        std::coroutine_handle<Promise> child;
+        bool await_ready() const noexcept { return !child || child.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            Task::retain(h); // Owned by the child's continuation
+            child.promise().continuation = h;
+            return child;
+        }
+        void await_resume() noexcept {}
+    };
+    Awaiter operator co_await() const noexcept { return Awaiter{handle}; }
+
+private:
+    inline static thread_local void* running_ = nullptr;
 };
 
 inline Task Task::Promise::get_return_object() {
     return Task{std::coroutine_handle<Promise>::from_promise(*this), Task::AdoptTag{}};
-}
\ No newline at end of file
+}
+// Hands an awaiter the frame as the std::coroutine_handle<Task::Promise> every awaiter in the
+// runtime expects. Lazy<T> routes all of its co_awaits through this (await_transform).
+template <typename A>
+struct TaskAwaiterAdapter {
+    A awaiter; // The awaiter itself, or a reference to a temporary of the co_await expression
+
+    bool await_ready() { return awaiter.await_ready(); }
+    template <typename P>
+    auto await_suspend(std::coroutine_handle<P> h) {
+        return awaiter.await_suspend(std::coroutine_handle<Task::Promise>::from_address(h.address()));
+    }
+    decltype(auto) await_resume() { return awaiter.await_resume(); }
+};
+
+/**
+ * Lazy<T>: a coroutine that produces a T for whoever co_awaits it.
+ * Like Task it starts suspended. `T v = co_await lazy_fn();` runs it on the awaiting thread by
+ * symmetric transfer; the value is moved into a slot in the awaiter, not into the frame.
+ * Lazy<T> is move-only and awaited once; use Task for coroutines without a result.
+ */
+template <typename T>
+class Lazy {
+    static_assert(!std::is_void_v<T> && !std::is_reference_v<T>, "Lazy<T> needs an object type; use Task for no result");
+
+public:
+    struct promise_type : Task::PromiseBase {
+        std::optional<T>* result = nullptr; // The awaiter's slot, set before the body first runs
+
+        Lazy get_return_object() { return Lazy(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        template <typename U = T>
+        void return_value(U&& v) {
+            if (result) result->emplace(std::forward<U>(v));
+        }
+
+        template <typename X>
+        auto await_transform(X&& x) {
+            if constexpr (requires { std::forward<X>(x).operator co_await(); }) {
+                return TaskAwaiterAdapter<decltype(std::forward<X>(x).operator co_await())>{std::forward<X>(x).operator co_await()};
+            } else {
+                return TaskAwaiterAdapter<X&&>{std::forward<X>(x)};
+            }
+        }
+    };
+
+    Lazy() = default;
+    Lazy(Lazy&& o) noexcept : handle_(std::exchange(o.handle_, nullptr)) {}
+    Lazy& operator=(Lazy&& o) noexcept {
+        if (this != &o) {
+            reset();
+            handle_ = std::exchange(o.handle_, nullptr);
+        }
+        return *this;
+    }
+    Lazy(const Lazy&) = delete;
+    Lazy& operator=(const Lazy&) = delete;
+    ~Lazy() { reset(); }
+
+    explicit operator bool() const { return static_cast<bool>(handle_); }
+
+    struct Awaiter {
+        std::coroutine_handle<promise_type> child;
+        std::optional<T> result;
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Task::Promise> h) noexcept {
+            Task::retain(h); // Owned by the child's continuation
+            child.promise().result = &result;
+            child.promise().continuation = h;
+            return child;
+        }
+        T await_resume() { return std::move(*result); }
+    };
+    Awaiter operator co_await() && noexcept { return Awaiter{handle_, std::nullopt}; }
+
+private:
+    std::coroutine_handle<promise_type> handle_ = nullptr;
+
+    explicit Lazy(std::coroutine_handle<promise_type> h) : handle_(h) {
+        static_assert(alignof(promise_type) == alignof(Task::Promise), "promise must sit where Task::Promise would");
+    }
+
+    // Published addresses (a parked child) hold references too, so the frame is shared like a Task's
+    void reset() {
+        if (handle_ && handle_.promise().ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) handle_.destroy();
+        handle_ = nullptr;
+    }
+};
@@ -2,17 +2,227 @@
 #pragma once
 #include <chrono>
 #include <coroutine>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <bit>
+#include <algorithm>
 
 using TimePoint = std::chrono::steady_clock::time_point;
 
-struct Timer {
-    TimePoint expiry;
-    std::coroutine_handle<> handle;
+// Hierarchical timing wheel: 4 levels x 64 slots with a 1 ms tick (~4.6 hours before re-cascading).
+// * insert / cancel are O(1): nodes come from a pooled slab and are addressed by (index, generation),
+//   so a stale handle can never cancel somebody else's timer.
+// * Timers due in the same tick expire together, so 100k timeouts cost one wake-up per tick, not per timer.
+// Not thread-safe: the owner (Reactor) serializes access.
+class TimerWheel {
+public:
+    static constexpr int kSlotBits = 6;
+    static constexpr uint64_t kSlots = 1ull << kSlotBits;
+    static constexpr int kLevels = 4;
+    static constexpr uint64_t kNever = UINT64_MAX;
 
-    // Key: To make priority_queue a min-heap,
-    // we need to use it with std::greater, and std::greater internally calls operator>.
-    // Logic: If A's time > B's time, then A is "greater", A will sink to the bottom, and B will float up.
-    bool operator>(const Timer& other) const {
-        return expiry > other.expiry;
+    // What a timer carries: a task to hand back to the scheduler, or a callback
+    struct Entry {
+        void* task = nullptr;               // Coroutine address owning one reference
+        bool* fired = nullptr;              // Optional: set true on expiry, false on cancel
+        void (*callback)(void*) = nullptr;  // Used instead of task when set
+        void* arg = nullptr;
+    };
+
+    // Handle to a pending timer; gen 0 never names a live node
+    struct Id {
+        uint32_t index = 0;
+        uint32_t gen = 0;
+    };
+
+    explicit TimerWheel(TimePoint origin = std::chrono::steady_clock::now()) : origin_(origin) {}
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Round expiries up (never fire early) and "now" down
+    uint64_t tick_ceil(TimePoint tp) const {
+        if (tp <= origin_) return 0;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(tp - origin_).count();
+        return (us + 999) / 1000;
+    }
+    uint64_t tick_floor(TimePoint tp) const {
+        if (tp <= origin_) return 0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(tp - origin_).count();
+    }
+
+    uint64_t now_tick() const { return now_tick_; }
+    size_t size() const { return size_; }
+
+    Id insert(uint64_t expiry_tick, const Entry& entry) {
+        Node* n = alloc();
+        n->expiry = std::max(expiry_tick, now_tick_ + 1);
+        n->entry = entry;
+        place(n);
+        ++size_;
+        return {n->index, n->gen};
+    }
+
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(Id id, Entry* out = nullptr) {
+        if (id.gen == 0 || (id.index >> kChunkBits) >= chunks_.size()) return false;
+        Node* n = node_at(id.index);
+        if (n->gen != id.gen || !n->linked) return false;
+        unlink(n);
+        if (out) *out = n->entry;
+        release(n);
+        --size_;
+        return true;
+    }
+
+    // Earliest tick at which advance() has work to do (an expiry or a cascade), kNever if empty
+    uint64_t next_tick() const {
+        if (size_ == 0) return kNever;
+        uint64_t best = kNever;
+        if (occupied_[0]) {
+            uint64_t pos = (now_tick_ + 1) & (kSlots - 1);
+            best = now_tick_ + 1 + std::countr_zero(std::rotr(occupied_[0], (int)pos));
+        }
+        for (int level = 1; level < kLevels; ++level) {
+            if (!occupied_[level]) continue;
+            int shift = kSlotBits * level;
+            uint64_t cur = now_tick_ >> shift;
+            uint64_t pos = (cur + 1) & (kSlots - 1);
+            uint64_t dist = std::countr_zero(std::rotr(occupied_[level], (int)pos)) + 1;
+            best = std::min(best, (cur + dist) << shift);
+        }
+        return best;
+    }
+
+    // Advance to to_tick, calling on_expire(const Entry&) for every expired timer
+    template <typename F>
+    void advance(uint64_t to_tick, F&& on_expire) {
+        while (now_tick_ < to_tick) {
+            uint64_t step = std::min(next_tick(), to_tick);
+            if (step == kNever) {
+                now_tick_ = to_tick;
+                break;
+            }
+            now_tick_ = step;
+            cascade(step);
+            fire_slot(step, on_expire);
+        }
+    }
+
+private:
+    static constexpr int kChunkBits = 8;
+    static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+
+    struct Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        uint64_t expiry = 0;
+        uint32_t index = 0;
+        uint32_t gen = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool linked = false;
+        Entry entry;
+    };
+
+    TimePoint origin_;
+    uint64_t now_tick_ = 0;
+    size_t size_ = 0;
+    Node* heads_[kLevels][kSlots] = {};
+    uint64_t occupied_[kLevels] = {};
+    std::vector<std::unique_ptr<Node[]>> chunks_;
+    Node* free_ = nullptr;
+
+    Node* node_at(uint32_t index) { return &chunks_[index >> kChunkBits][index & (kChunkSize - 1)]; }
+
+    Node* alloc() {
+        if (!free_) {
+            uint32_t base = (uint32_t)chunks_.size() << kChunkBits;
+            chunks_.push_back(std::make_unique<Node[]>(kChunkSize));
+            Node* chunk = chunks_.back().get();
+            for (uint32_t i = kChunkSize; i-- > 0;) {
+                chunk[i].index = base + i;
+                chunk[i].next = free_;
+                free_ = &chunk[i];
+            }
+        }
+        Node* n = free_;
+        free_ = n->next;
+        return n;
+    }
+
+    void release(Node* n) {
+        if (++n->gen == 0) n->gen = 1; // Skip the invalid generation on wrap-around
+        n->entry = {};
+        n->next = free_;
+        free_ = n;
+    }
+
+    // Slot choice is relative to now: level L holds timers due within 64^(L+1) ticks
+    void place(Node* n) {
+        uint64_t expiry = std::max(n->expiry, now_tick_);
+        uint64_t delta = expiry - now_tick_;
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (kSlots << (kSlotBits * level))) ++level;
+        if (delta >= (kSlots << (kSlotBits * level))) {
+            expiry = now_tick_ + (kSlots << (kSlotBits * level)) - 1; // Beyond the horizon: re-cascade later
+        }
+        uint8_t slot = (expiry >> (kSlotBits * level)) & (kSlots - 1);
+        n->level = (uint8_t)level;
+        n->slot = slot;
+        n->prev = nullptr;
+        n->next = heads_[level][slot];
+        if (n->next) n->next->prev = n;
+        heads_[level][slot] = n;
+        occupied_[level] |= 1ull << slot;
+        n->linked = true;
+    }
+
+    void unlink(Node* n) {
+        if (n->prev) n->prev->next = n->next;
+        else heads_[n->level][n->slot] = n->next;
+        if (n->next) n->next->prev = n->prev;
+        if (!heads_[n->level][n->slot]) occupied_[n->level] &= ~(1ull << n->slot);
+        n->linked = false;
+    }
+
+    Node* take_slot(int level, uint64_t slot) {
+        Node* head = heads_[level][slot];
+        heads_[level][slot] = nullptr;
+        occupied_[level] &= ~(1ull << slot);
+        return head;
+    }
+
+    // At a boundary of level L, redistribute that level's current slot (highest level first)
+    void cascade(uint64_t tick) {
+        int top = 0;
+        while (top + 1 < kLevels && (tick & ((1ull << (kSlotBits * (top + 1))) - 1)) == 0) ++top;
+        for (int level = top; level >= 1; --level) {
+            Node* n = take_slot(level, (tick >> (kSlotBits * level)) & (kSlots - 1));
+            while (n) {
+                Node* next = n->next;
+                place(n);
+                n = next;
+            }
+        }
+    }
+
+    template <typename F>
+    void fire_slot(uint64_t tick, F& on_expire) {
+        Node* n = take_slot(0, tick & (kSlots - 1));
+        while (n) {
+            Node* next = n->next;
+            n->linked = false;
+            if (n->expiry > tick) {
+                place(n); // Not due in this lap
+            } else {
+                Entry e = n->entry;
+                release(n);
+                --size_;
+                on_expire(e);
+            }
+            n = next;
+        }
     }
-};
\ No newline at end of file
+};
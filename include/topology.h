@@ -0,0 +1,117 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// CPU topology discovered once at Scheduler startup.
+// A "domain" is a group of CPUs sharing a last-level cache (L3), falling back to the NUMA node.
+// Stealing inside a domain keeps the stolen task's cache lines on the same die.
+struct CpuTopology {
+    std::vector<int> cpus;      // Online CPUs, grouped so that members of one domain are adjacent
+    std::vector<int> domain_of; // Indexed by position in cpus
+
+    size_t size() const { return cpus.size(); }
+    int cpu(size_t i) const { return cpus[i % cpus.size()]; }
+    int domain(size_t i) const { return domain_of[i % domain_of.size()]; }
+    // Domain of a CPU number (not a position); 0 if it is not online
+    int domain_of_cpu(int c) const {
+        for (size_t i = 0; i < cpus.size(); ++i) {
+            if (cpus[i] == c) return domain_of[i];
+        }
+        return 0;
+    }
+
+    static CpuTopology discover() {
+        CpuTopology topo;
+#ifdef __linux__
+        std::vector<int> online = parse_cpu_list(read_line("/sys/devices/system/cpu/online"));
+        std::map<std::string, std::vector<int>> groups; // shared_cpu_list -> members
+        for (int c : online) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(c);
+            std::string key = read_line(base + "/cache/index3/shared_cpu_list");
+            if (key.empty()) key = "node" + std::to_string(numa_node_of(c));
+            groups[key].push_back(c);
+        }
+        int id = 0;
+        for (auto& [key, members] : groups) {
+            for (int c : members) {
+                topo.cpus.push_back(c);
+                topo.domain_of.push_back(id);
+            }
+            ++id;
+        }
+#endif
+        if (topo.cpus.empty()) {
+            // Unknown layout (macOS, restricted /sys): one flat domain
+            unsigned n = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned i = 0; i < n; ++i) {
+                topo.cpus.push_back(i);
+                topo.domain_of.push_back(0);
+            }
+        }
+        return topo;
+    }
+
+    // "0-3,8-11" -> {0,1,2,3,8,9,10,11}
+    static std::vector<int> parse_cpu_list(const std::string& s) {
+        std::vector<int> out;
+        size_t pos = 0;
+        while (pos < s.size()) {
+            size_t comma = s.find(',', pos);
+            std::string part = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = part.find('-');
+            try {
+                int lo = std::stoi(part.substr(0, dash));
+                int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+                for (int c = lo; c <= hi; ++c) out.push_back(c);
+            } catch (...) {
+                return {};
+            }
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return out;
+    }
+
+private:
+    static std::string read_line(const std::string& path) {
+        std::ifstream f(path);
+        std::string line;
+        std::getline(f, line);
+        return line;
+    }
+
+    static int numa_node_of(int cpu) {
+        for (int node = 0; node < 1024; ++node) {
+            std::string list = read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (list.empty()) {
+                if (node > 0) break;
+                continue;
+            }
+            for (int c : parse_cpu_list(list)) if (c == cpu) return node;
+        }
+        return 0;
+    }
+};
+
+// Bind the calling thread to one CPU. Linux only: macOS has no hard affinity (thread affinity
+// tags are mere hints), so elsewhere this is a no-op returning false.
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -0,0 +1,311 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Runtime tracing in the coroTracer format (analyze_bugs/trace.jsonl). Built with -DTINYCORO_TRACE
+// (CMake: -DENABLE_TRACE=ON), the scheduler's probes write 32-byte records into a per-thread ring,
+// and Tracer::start() runs a thread that drains the rings to JSONL. Without the define every probe
+// is ((void)0): nothing is compiled in.
+//
+//   Tracer::start("trace.jsonl");   // Probes record from here on
+//   ...
+//   Tracer::stop();                 // Last drain, file closed
+enum class TraceEvent : uint8_t {
+    kResume,      // A Worker resumes a task (Task::run)
+    kSuspend,     // ... and gets control back: the task suspended or finished
+    kPop,         // Task taken from the Worker's own run_next_ slot or local queue
+    kSteal,       // Task stolen from a peer (addr: the victim Worker)
+    kGlobal,      // Task taken from the global queue
+    kPark,        // Worker goes to sleep (probe 0)
+    kUnpark,      // ... and wakes up
+    kIoEvent,     // A readiness edge or completion hands a task back (addr: Worker or Reactor)
+    kTimerFire,   // A timer expires (probe: its task, or a callback's argument)
+    kChannelWait, // A task parks on a Channel (addr: the Channel)
+    kMutexWait,   // A task queues on an AsyncMutex / AsyncRwLock (addr: the lock)
+    kCount
+};
+
+#ifdef TINYCORO_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__APPLE__)
+#include <pthread.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define TINYCORO_TRACE_EVENT(event, probe, addr) Tracer::record((event), (probe), (addr))
+
+struct TraceRecord {
+    uint64_t ts;    // Raw TraceClock ticks; the drainer converts them to CLOCK_MONOTONIC ns
+    uint64_t probe; // The coroutine frame, 0 if none
+    uint64_t addr;  // The object involved (victim, channel, lock), 0 if none
+    uint32_t seq;   // Per-thread event count, dropped records included: gaps show losses
+    TraceEvent event;
+};
+static_assert(sizeof(TraceRecord) == 32);
+
+// Cycle counter, read without a syscall or a fence: ~7 ns instead of ~20 for clock_gettime.
+// Invariant TSC / the ARM generic timer tick at the same rate on every core.
+struct TraceClock {
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#else
+        return mono_ns();
+#endif
+    }
+    static uint64_t mono_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Single producer (the owning thread), single consumer (the drainer). When the drainer falls behind,
+// new records are dropped and counted; the producer never waits.
+struct alignas(64) TraceRing {
+    static constexpr size_t kCapacity = 16384; // 512 KB per traced thread
+    static constexpr size_t kMask = kCapacity - 1;
+
+    // Producer side
+    std::atomic<uint64_t> head{0};
+    uint64_t tail_cache = 0;
+    uint32_t seq = 0;
+    std::atomic<uint64_t> dropped{0};
+
+    // Consumer side
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t last_seq = 0;              // seq widened to 64 bits
+    std::atomic<bool> retired{false};   // The thread exited: free once drained
+    uint64_t tid = 0;
+
+    TraceRecord records[kCapacity];
+
+    void push(TraceEvent event, const void* probe, const void* addr) {
+        uint32_t s = ++seq;
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail_cache == kCapacity) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h - tail_cache == kCapacity) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        records[h & kMask] = {TraceClock::now(), reinterpret_cast<uint64_t>(probe),
+                              reinterpret_cast<uint64_t>(addr), s, event};
+        head.store(h + 1, std::memory_order_release);
+    }
+};
+
+class Tracer {
+public:
+    // Opens path (truncated) and starts draining every `interval`. False if already running or
+    // the file cannot be opened.
+    static bool start(const char* path, std::chrono::milliseconds interval = std::chrono::milliseconds(100)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_) return false;
+        file_ = std::fopen(path, "w");
+        if (!file_) return false;
+        calib_ticks_ = TraceClock::now();
+        calib_ns_ = TraceClock::mono_ns();
+        stopping_ = false;
+        drainer_ = std::thread([interval] { drain_loop(interval); });
+        enabled_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Stops recording, writes what the rings still hold and closes the file
+    static void stop() {
+        std::thread drainer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!file_) return;
+            enabled_.store(false, std::memory_order_release);
+            stopping_ = true;
+            drainer.swap(drainer_);
+        }
+        cv_.notify_all();
+        drainer.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_all();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Records lost to full rings since the process started
+    static uint64_t dropped() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t n = dropped_retired_;
+        for (TraceRing* r : rings_) n += r->dropped.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    // The probe: one relaxed load while tracing is off, a ring push while it is on
+    static void record(TraceEvent event, const void* probe, const void* addr) {
+        if (!enabled_.load(std::memory_order_relaxed)) return;
+        TraceRing* r = ring_;
+        if (!r && !(r = attach())) return;
+        r->push(event, probe, addr);
+    }
+
+private:
+    // Retires the thread's ring when the thread exits. Kept apart from ring_ so that the probe
+    // reads a plain pointer, not a thread_local with a destructor (and its init guard).
+    struct Owner {
+        TraceRing* ring; // Zero-initialized like every thread_local
+        ~Owner() {
+            exited_ = true;
+            ring_ = nullptr;
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    static TraceRing* attach() {
+        if (exited_) return nullptr; // Probes from thread_local destructors after Owner's
+        auto* r = new TraceRing;
+#if defined(__APPLE__)
+        pthread_threadid_np(nullptr, &r->tid);
+#else
+        r->tid = static_cast<uint64_t>(::syscall(SYS_gettid));
+#endif
+        owner_.ring = r;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(r);
+        }
+        ring_ = r;
+        return r;
+    }
+
+    static void drain_loop(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            cv_.wait_for(lock, interval, [] { return stopping_; });
+            drain_all();
+            std::fflush(file_);
+        }
+    }
+
+    // snprintf would cost the drainer several times more per record than the probe costs its thread
+    static char* put(char* p, std::string_view s) {
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+    static char* put_dec(char* p, uint64_t v) {
+        char tmp[20];
+        int n = 0;
+        do {
+            tmp[n++] = char('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n) *p++ = tmp[--n];
+        return p;
+    }
+    static char* put_hex(char* p, uint64_t v) { // 16 digits, zero-padded
+        for (int i = 15; i >= 0; --i, v >>= 4) p[i] = "0123456789abcdef"[v & 15];
+        return p + 16;
+    }
+
+    static constexpr const char* kNames[] = {"resume", "suspend", "pop", "steal", "global", "park",
+                                             "unpark", "io", "timer", "channel_wait", "mutex_wait"};
+    static_assert(std::size(kNames) == size_t(TraceEvent::kCount));
+
+    // Under mutex_. Ticks map to ns through two points: start() and now, so the rate estimate
+    // sharpens as the run gets longer.
+    static void drain_all() {
+        uint64_t ticks = TraceClock::now(), ns = TraceClock::mono_ns();
+        double scale = ticks > calib_ticks_ ? double(ns - calib_ns_) / double(ticks - calib_ticks_) : 1.0;
+        char out[64 * 1024]; // Lines are at most ~200 bytes
+        char* p = out;
+        for (size_t i = 0; i < rings_.size();) {
+            TraceRing* r = rings_[i];
+            bool retired = r->retired.load(std::memory_order_acquire);
+            uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            uint64_t head = r->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                const TraceRecord& rec = r->records[tail & TraceRing::kMask];
+                r->last_seq += uint32_t(rec.seq - uint32_t(r->last_seq));
+                int64_t ts = int64_t(calib_ns_) + int64_t(double(int64_t(rec.ts - calib_ticks_)) * scale);
+                bool active = rec.event != TraceEvent::kSuspend && rec.event != TraceEvent::kPark &&
+                              rec.event != TraceEvent::kChannelWait && rec.event != TraceEvent::kMutexWait;
+                if (p - out > int(sizeof(out)) - 256) {
+                    std::fwrite(out, 1, size_t(p - out), file_);
+                    p = out;
+                }
+                p = put(p, "{\"probe_id\":");
+                p = put_dec(p, rec.probe);
+                p = put(p, ",\"tid\":");
+                p = put_dec(p, r->tid);
+                p = put(p, ",\"addr\":\"0x");
+                p = put_hex(p, rec.addr);
+                p = put(p, "\",\"seq\":");
+                p = put_dec(p, r->last_seq);
+                p = put(p, active ? ",\"is_active\":true,\"ts\":" : ",\"is_active\":false,\"ts\":");
+                p = put_dec(p, uint64_t(std::max<int64_t>(ts, 0)));
+                p = put(p, ",\"event\":\"");
+                p = put(p, kNames[size_t(rec.event)]);
+                p = put(p, "\"}\n");
+            }
+            r->tail.store(tail, std::memory_order_release);
+            if (retired) {
+                dropped_retired_ += r->dropped.load(std::memory_order_relaxed);
+                delete r;
+                rings_[i] = rings_.back();
+                rings_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        std::fwrite(out, 1, size_t(p - out), file_);
+    }
+
+    inline static std::atomic<bool> enabled_{false};
+    inline static thread_local TraceRing* ring_ = nullptr;
+    inline static thread_local bool exited_ = false;
+    inline static thread_local Owner owner_;
+
+    inline static std::mutex mutex_;
+    inline static std::condition_variable cv_;
+    inline static std::vector<TraceRing*> rings_;
+    inline static std::thread drainer_;
+    inline static std::FILE* file_ = nullptr;
+    inline static bool stopping_ = false;
+    inline static uint64_t calib_ticks_ = 0;
+    inline static uint64_t calib_ns_ = 0;
+    inline static uint64_t dropped_retired_ = 0;
+};
+
+#else
+
+#define TINYCORO_TRACE_EVENT(event, probe, addr) ((void)0)
+
+// Compiled out: the same interface, doing nothing
+class Tracer {
+public:
+    static bool start(const char*, std::chrono::milliseconds = std::chrono::milliseconds(100)) { return false; }
+    static void stop() {}
+    static bool enabled() { return false; }
+    static uint64_t dropped() { return 0; }
+};
+
+#endif
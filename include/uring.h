@@ -0,0 +1,392 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+
+// io_uring Poller backend, built with -DTINYCORO_IO_URING (CMake: ENABLE_IO_URING=ON).
+// Talks to the kernel through the raw syscalls; no liburing dependency. Included by poller.h.
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+
+#include "spinlock.h"
+
+// An operation the backend performs itself (read, write, multishot accept/recv).
+// Submitted with user_data = tag(); complete() runs on the polling thread for every CQE and returns
+// a task address to resume (owning one reference) or nullptr.
+struct IoOp {
+    void* (*complete)(IoOp*, int32_t res, uint32_t flags) = nullptr;
+
+    void* tag() { return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(this) | 2); }
+};
+
+class UringPoller {
+public:
+    static constexpr unsigned kEntries = 1024;
+    // Provided buffer ring for multishot recv (group 0)
+    static constexpr uint16_t kBufGroup = 0;
+    static constexpr unsigned kBufCount = 1024; // Power of two
+    static constexpr unsigned kBufSize = 4096;
+
+    UringPoller() {
+        io_uring_params p{};
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, kEntries, &p));
+        if (ring_fd_ < 0) throw std::runtime_error("io_uring_setup failed");
+        // EXT_ARG (5.11) gives io_uring_enter a timeout without an extra TIMEOUT SQE
+        if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_EXT_ARG)) {
+            ::close(ring_fd_);
+            throw std::runtime_error("io_uring: kernel too old (need SINGLE_MMAP + EXT_ARG)");
+        }
+
+        ring_sz_ = std::max<size_t>(p.sq_off.array + p.sq_entries * sizeof(unsigned),
+                                    p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe));
+        ring_ = mmap(nullptr, ring_sz_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        sqes_sz_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_sz_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+            ::close(ring_fd_);
+            throw std::runtime_error("io_uring mmap failed");
+        }
+        char* base = static_cast<char*>(ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(base + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(base + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(base + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned*>(base + p.sq_off.array);
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+        cq_head_ = reinterpret_cast<unsigned*>(base + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(base + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(base + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(base + p.cq_off.cqes);
+        sq_tail_local_ = *sq_tail_;
+
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ == -1) throw std::runtime_error("eventfd failed");
+        arm_wake();
+
+        // Multishot accept needs 5.19; multishot recv needs 6.0 and a working provided buffer ring.
+        // Without them, accepts fall back to readiness and reads to direct ops.
+        multishot_accept_ = kernel_at_least(5, 19);
+        if (kernel_at_least(6, 0) && setup_buffer_ring()) {
+            multishot_recv_ = probe_buffer_ring();
+            if (!multishot_recv_) release_buffer_ring();
+        }
+    }
+
+    ~UringPoller() {
+        if (buf_ring_) munmap(buf_ring_, buf_ring_sz_);
+        if (buffers_) munmap(buffers_, size_t(kBufCount) * kBufSize);
+        munmap(sqes_, sqes_sz_);
+        munmap(ring_, ring_sz_);
+        ::close(wake_fd_);
+        ::close(ring_fd_);
+    }
+
+    UringPoller(const UringPoller&) = delete;
+    UringPoller& operator=(const UringPoller&) = delete;
+
+    void wake() {
+        uint64_t val = 1;
+        ::write(wake_fd_, &val, sizeof(val));
+    }
+
+    // Readiness (same contract as the epoll backend): one-shot POLL_ADD carrying udata
+    void add_read(int fd, void* udata) { prep_poll(fd, POLLIN | POLLRDHUP, udata); }
+    void add_write(int fd, void* udata) { prep_poll(fd, POLLOUT, udata); }
+
+    // Asynchronous: the cancelled request still delivers exactly one CQE (usually -ECANCELED)
+    void cancel(void* udata) {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = reinterpret_cast<uint64_t>(udata);
+            sqe->user_data = kIgnore;
+        });
+    }
+
+    // Direct ops: the CQE carries the syscall result, so the awaiter needs no retry read()/write()
+    void read(int fd, void* buf, size_t n, IoOp* op) { prep_rw(IORING_OP_READ, fd, buf, n, op); }
+    void write(int fd, const void* buf, size_t n, IoOp* op) { prep_rw(IORING_OP_WRITE, fd, const_cast<void*>(buf), n, op); }
+    void writev(int fd, const iovec* iov, int cnt, IoOp* op) { prep_rw(IORING_OP_WRITEV, fd, const_cast<iovec*>(iov), cnt, op); }
+
+    // One SQE, one CQE per accepted connection (fds are already non-blocking)
+    void accept_multishot(int fd, IoOp* op) {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = fd;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+            sqe->user_data = reinterpret_cast<uint64_t>(op->tag());
+        });
+    }
+
+    // One SQE, one CQE per received chunk; data lands in a provided buffer (flags >> 16 = buffer id)
+    void recv_multishot(int fd, IoOp* op) {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = fd;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = kBufGroup;
+            sqe->user_data = reinterpret_cast<uint64_t>(op->tag());
+        });
+    }
+
+    bool multishot_accept() const { return multishot_accept_; }
+    bool multishot_recv() const { return multishot_recv_; }
+    const char* buffer(uint16_t bid) const { return buffers_ + size_t(bid) * kBufSize; }
+
+    // Hand a provided buffer back to the kernel once its data has been consumed
+    void recycle(uint16_t bid) {
+        std::lock_guard<SpinLock> lock(buf_lock_);
+        // Index the ring memory itself: in C++ some kernel headers' __DECLARE_FLEX_ARRAY puts `bufs`
+        // at offset 8 instead of 0. bufs[0].resv aliases the ring tail: write the fields individually.
+        io_uring_buf& b = reinterpret_cast<io_uring_buf*>(buf_ring_)[buf_tail_ & (kBufCount - 1)];
+        b.addr = reinterpret_cast<uint64_t>(buffer(bid));
+        b.len = kBufSize;
+        b.bid = bid;
+        ++buf_tail_;
+        std::atomic_ref<uint16_t>(buf_ring_->tail).store(buf_tail_, std::memory_order_release);
+    }
+
+    // Submits everything queued since the last call (one io_uring_enter for the whole batch),
+    // then waits for and dispatches completions.
+    template <typename F>
+    int wait(int timeout_ms, F&& callback) {
+        unsigned to_submit;
+        bool block = timeout_ms != 0 && !cq_ready();
+        {
+            std::lock_guard<SpinLock> lock(sq_lock_);
+            to_submit = pending_;
+            pending_ = 0;
+            waiting_ = block;
+        }
+        if (to_submit || block) {
+            __kernel_timespec ts{};
+            io_uring_getevents_arg arg{};
+            if (timeout_ms > 0) {
+                ts.tv_sec = timeout_ms / 1000;
+                ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+                arg.ts = reinterpret_cast<uint64_t>(&ts);
+            }
+            unsigned flags = IORING_ENTER_EXT_ARG | (block ? IORING_ENTER_GETEVENTS : 0);
+            enter(to_submit, block ? 1 : 0, flags, &arg, sizeof(arg));
+        }
+        if (block) {
+            std::lock_guard<SpinLock> lock(sq_lock_);
+            waiting_ = false;
+        }
+        return reap(callback);
+    }
+
+private:
+    static constexpr uint64_t kWake = 0;   // wake eventfd poll
+    static constexpr uint64_t kIgnore = 2; // IoOp tag of nullptr: cancel requests
+
+    int ring_fd_ = -1;
+    void* ring_ = nullptr;
+    size_t ring_sz_ = 0;
+    size_t sqes_sz_ = 0;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    io_uring_sqe* sqes_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+    int wake_fd_ = -1;
+    uint64_t wake_buf_ = 0;
+
+    // Workers queue SQEs from any thread; the polling thread submits them with its next enter
+    SpinLock sq_lock_;
+    unsigned sq_tail_local_ = 0;
+    unsigned pending_ = 0;  // Queued but not yet submitted
+    bool waiting_ = false;  // Polling thread is blocked in io_uring_enter
+
+    bool multishot_accept_ = false;
+    bool multishot_recv_ = false;
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_sz_ = 0;
+    char* buffers_ = nullptr;
+    SpinLock buf_lock_;
+    uint16_t buf_tail_ = 0;
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, arg, argsz));
+    }
+
+    template <typename Prep>
+    void push(Prep&& prep) {
+        unsigned flush = 0;
+        {
+            std::lock_guard<SpinLock> lock(sq_lock_);
+            // Ring full: submit what we have (rare; only under huge bursts)
+            while (sq_tail_local_ - std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire) >= sq_entries_) {
+                enter(pending_, 0, 0, nullptr, 0);
+                pending_ = 0;
+            }
+            unsigned idx = sq_tail_local_ & sq_mask_;
+            io_uring_sqe* sqe = &sqes_[idx];
+            std::memset(sqe, 0, sizeof(*sqe));
+            prep(sqe);
+            sq_array_[idx] = idx;
+            ++sq_tail_local_;
+            std::atomic_ref<unsigned>(*sq_tail_).store(sq_tail_local_, std::memory_order_release);
+            ++pending_;
+            // The polling thread is asleep in io_uring_enter and would not see this SQE before its
+            // next wake-up: submit it ourselves. Otherwise it rides along with the next batch.
+            if (waiting_) {
+                flush = pending_;
+                pending_ = 0;
+            }
+        }
+        if (flush) enter(flush, 0, 0, nullptr, 0);
+    }
+
+    void prep_poll(int fd, unsigned events, void* udata) {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = fd;
+            sqe->poll32_events = events;
+            sqe->user_data = reinterpret_cast<uint64_t>(udata);
+        });
+    }
+
+    void prep_rw(uint8_t opcode, int fd, void* buf, size_t n, IoOp* op) {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = opcode;
+            sqe->fd = fd;
+            sqe->off = static_cast<uint64_t>(-1); // Current file position; ignored for sockets
+            sqe->addr = reinterpret_cast<uint64_t>(buf);
+            sqe->len = static_cast<uint32_t>(n);
+            sqe->user_data = reinterpret_cast<uint64_t>(op->tag());
+        });
+    }
+
+    void arm_wake() {
+        push([&](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = wake_fd_;
+            sqe->len = IORING_POLL_ADD_MULTI;
+            sqe->poll32_events = POLLIN;
+            sqe->user_data = kWake;
+        });
+    }
+
+    bool cq_ready() const {
+        return std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire) != *cq_head_;
+    }
+
+    template <typename F>
+    int reap(F& callback) {
+        unsigned head = *cq_head_;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        int n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            uint64_t ud = cqe.user_data;
+            int32_t res = cqe.res;
+            uint32_t flags = cqe.flags;
+            if (ud == kWake) {
+                ::read(wake_fd_, &wake_buf_, sizeof(wake_buf_));
+                if (!(flags & IORING_CQE_F_MORE)) arm_wake();
+                continue;
+            }
+            if (ud == kIgnore) continue;
+            if (ud & 2) {
+                IoOp* op = reinterpret_cast<IoOp*>(ud & ~uint64_t(3));
+                if (void* task = op->complete(op, res, flags)) callback(task, kPollReadable | kPollWritable);
+                continue;
+            }
+            // Readiness: coroutine address or IoWaiter tag (one-shot, so the direction is implied)
+            callback(reinterpret_cast<void*>(ud), kPollReadable | kPollWritable);
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return n;
+    }
+
+    bool setup_buffer_ring() {
+        buf_ring_sz_ = kBufCount * sizeof(io_uring_buf);
+        void* ring = mmap(nullptr, buf_ring_sz_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        void* bufs = mmap(nullptr, size_t(kBufCount) * kBufSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ring == MAP_FAILED || bufs == MAP_FAILED) {
+            if (ring != MAP_FAILED) munmap(ring, buf_ring_sz_);
+            if (bufs != MAP_FAILED) munmap(bufs, size_t(kBufCount) * kBufSize);
+            return false;
+        }
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+        reg.ring_entries = kBufCount;
+        reg.bgid = kBufGroup;
+        if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            munmap(ring, buf_ring_sz_);
+            munmap(bufs, size_t(kBufCount) * kBufSize);
+            return false;
+        }
+        buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+        buffers_ = static_cast<char*>(bufs);
+        for (unsigned i = 0; i < kBufCount; ++i) recycle(static_cast<uint16_t>(i));
+        return true;
+    }
+
+    void release_buffer_ring() {
+        io_uring_buf_reg reg{};
+        reg.bgid = kBufGroup;
+        syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        munmap(buf_ring_, buf_ring_sz_);
+        munmap(buffers_, size_t(kBufCount) * kBufSize);
+        buf_ring_ = nullptr;
+        buffers_ = nullptr;
+    }
+
+    // Some kernels accept the ring registration yet never select from it (every recv fails with
+    // ENOBUFS). One buffer-select recv on a socketpair tells; runs before anything else is in flight.
+    bool probe_buffer_ring() {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) return false;
+        bool ok = false;
+        if (::write(sv[1], "p", 1) == 1) {
+            push([&](io_uring_sqe* sqe) {
+                sqe->opcode = IORING_OP_RECV;
+                sqe->fd = sv[0];
+                sqe->flags = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = kBufGroup;
+                sqe->user_data = kIgnore;
+            });
+            unsigned to_submit = pending_;
+            pending_ = 0;
+            if (enter(to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0 && cq_ready()) {
+                unsigned head = *cq_head_;
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                ok = cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER);
+                if (ok) recycle(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+                std::atomic_ref<unsigned>(*cq_head_).store(head + 1, std::memory_order_release);
+            }
+        }
+        ::close(sv[0]);
+        ::close(sv[1]);
+        return ok;
+    }
+
+    static bool kernel_at_least(int major, int minor) {
+        utsname u{};
+        int ma = 0, mi = 0;
+        if (uname(&u) != 0 || std::sscanf(u.release, "%d.%d", &ma, &mi) != 2) return false;
+        return ma > major || (ma == major && mi >= minor);
+    }
+};
+#endif
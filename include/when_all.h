@@ -0,0 +1,166 @@
+// Licensed under MIT (Commercial Allowed). See DUAL_LICENSING_NOTICE for details.
+#pragma once
+#include "scheduler.h"
+#include <atomic>
+#include <cassert>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Fan-out / join for Lazy<T>. Each child runs in a small Task of its own: the first one on the
+// awaiting thread by symmetric transfer, the rest pushed to the global queue in one batch for
+// idle Workers to pick up. The parent is resumed by the child that brings one shared counter to
+// zero (when_all) or that is first to finish (when_any).
+
+struct WhenAllLatch {
+    Scheduler& sched;
+    std::atomic<size_t> pending{0};
+    void* parent = nullptr; // Owns one reference, handed to spawn() by the last arrival
+
+    void arrive() {
+        // acq_rel: every child's result happens before the parent reads them
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) sched.spawn(Task::from_address(parent));
+    }
+};
+
+template <typename T>
+Task when_all_part(Lazy<T> t, std::optional<T>& out, WhenAllLatch& latch) {
+    out.emplace(co_await std::move(t));
+    latch.arrive();
+}
+
+// Starts parts[0] inline and the rest through the global queue. Nothing here may touch the
+// awaiter afterwards: the parent can only resume once parts[0] has run, but then it may do so anywhere.
+inline std::coroutine_handle<> when_all_launch(WhenAllLatch& latch, std::coroutine_handle<Task::Promise> h,
+                                               Task* parts, void** ptrs, size_t n) {
+    latch.pending.store(n, std::memory_order_relaxed);
+    latch.parent = h.address();
+    Task::retain(h);
+    for (size_t i = 1; i < n; ++i) ptrs[i - 1] = parts[i].detach();
+    if (n > 1) latch.sched.spawn_batch(ptrs, n - 1);
+    return Task::run_inline(std::move(parts[0]));
+}
+
+// co_await when_all(sched, a(), b(), c()) -> std::tuple<A, B, C>
+template <typename... Ts>
+class WhenAll {
+public:
+    WhenAll(Scheduler& s, Lazy<Ts>... tasks) : latch_{s}, tasks_(std::move(tasks)...) {}
+
+    bool await_ready() const noexcept { return sizeof...(Ts) == 0; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Task::Promise> h) {
+        return launch(h, std::index_sequence_for<Ts...>{});
+    }
+    std::tuple<Ts...> await_resume() {
+        return std::apply([](auto&... r) { return std::tuple<Ts...>(std::move(*r)...); }, results_);
+    }
+
+private:
+    WhenAllLatch latch_;
+    std::tuple<Lazy<Ts>...> tasks_;
+    std::tuple<std::optional<Ts>...> results_;
+
+    template <size_t... I>
+    std::coroutine_handle<> launch(std::coroutine_handle<Task::Promise> h, std::index_sequence<I...>) {
+        Task parts[] = {when_all_part(std::move(std::get<I>(tasks_)), std::get<I>(results_), latch_)...};
+        void* ptrs[sizeof...(Ts)];
+        return when_all_launch(latch_, h, parts, ptrs, sizeof...(Ts));
+    }
+};
+
+// co_await when_all(sched, std::move(tasks)) -> std::vector<T>, in input order
+template <typename T>
+class WhenAllRange {
+public:
+    WhenAllRange(Scheduler& s, std::vector<Lazy<T>> tasks)
+        : latch_{s}, tasks_(std::move(tasks)), results_(tasks_.size()) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Task::Promise> h) {
+        size_t n = tasks_.size();
+        std::vector<Task> parts;
+        parts.reserve(n);
+        for (size_t i = 0; i < n; ++i) parts.push_back(when_all_part(std::move(tasks_[i]), results_[i], latch_));
+        std::vector<void*> ptrs(n);
+        return when_all_launch(latch_, h, parts.data(), ptrs.data(), n);
+    }
+    std::vector<T> await_resume() {
+        std::vector<T> out;
+        out.reserve(results_.size());
+        for (auto& r : results_) out.push_back(std::move(*r));
+        return out;
+    }
+
+private:
+    WhenAllLatch latch_;
+    std::vector<Lazy<T>> tasks_;
+    std::vector<std::optional<T>> results_;
+};
+
+// Shared by the when_any parts, which may outlive the awaiter: the last one to finish frees it.
+// The count of unfinished parts is the only shared word; whoever takes it down from n first wins.
+struct WhenAnyState {
+    std::atomic<size_t> left;
+};
+
+template <typename T>
+Task when_any_part(Lazy<T> t, size_t index, size_t n, WhenAnyState* state, Scheduler& sched, void* parent,
+                   std::optional<std::pair<size_t, T>>* out) {
+    T value = co_await std::move(t);
+    size_t prev = state->left.fetch_sub(1, std::memory_order_acq_rel);
+    if (prev == n) {
+        // Winner: the parent is still suspended, so its awaiter is still there
+        out->emplace(index, std::move(value));
+        sched.spawn(Task::from_address(parent));
+    }
+    if (prev == 1) delete state;
+}
+
+// co_await when_any(sched, std::move(tasks)) -> {index, value} of the first to finish. The others
+// run to completion and their results are dropped. `tasks` must not be empty: with no part to win,
+// nothing would ever resume the parent.
+template <typename T>
+class WhenAny {
+public:
+    WhenAny(Scheduler& s, std::vector<Lazy<T>> tasks) : sched_(s), tasks_(std::move(tasks)) {
+        assert(!tasks_.empty() && "when_any() needs at least one task");
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Task::Promise> h) {
+        size_t n = tasks_.size();
+        auto* state = new WhenAnyState{n};
+        std::vector<Task> parts;
+        parts.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            parts.push_back(when_any_part(std::move(tasks_[i]), i, n, state, sched_, h.address(), &result_));
+        }
+        Task::retain(h); // Handed to spawn() by the winner
+        std::vector<void*> ptrs(n);
+        for (size_t i = 1; i < n; ++i) ptrs[i - 1] = parts[i].detach();
+        if (n > 1) sched_.spawn_batch(ptrs.data(), n - 1);
+        return Task::run_inline(std::move(parts[0]));
+    }
+    std::pair<size_t, T> await_resume() { return std::move(*result_); }
+
+private:
+    Scheduler& sched_;
+    std::vector<Lazy<T>> tasks_;
+    std::optional<std::pair<size_t, T>> result_;
+};
+
+template <typename... Ts>
+WhenAll<Ts...> when_all(Scheduler& s, Lazy<Ts>... tasks) {
+    return WhenAll<Ts...>(s, std::move(tasks)...);
+}
+
+template <typename T>
+WhenAllRange<T> when_all(Scheduler& s, std::vector<Lazy<T>> tasks) {
+    return WhenAllRange<T>(s, std::move(tasks));
+}
+
+template <typename T>
+WhenAny<T> when_any(Scheduler& s, std::vector<Lazy<T>> tasks) {
+    return WhenAny<T>(s, std::move(tasks));
+}
@@ -1,129 +1,140 @@
 #include "scheduler.h"
 #include "socket.h"
-#include "async_mutex.h"
+#include "redis/kv_store.h"
+#include "redis/resp_parser.h"
 #include <iostream>
 #include <string>
-#include <map>
 #include <vector>
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 
-struct RedisDB {
+// Storage engine: anything with set / get(key, f) / del, see redis/kv_store.h
+using KvEngine = ShardedKvStore;
 
-    std::map<std::string, std::string> kv_store;
-    AsyncMutex mutex;
+struct RedisDB {
+    KvEngine kv_store;
 
-    RedisDB(Scheduler& sched) : mutex(sched) {}
+    explicit RedisDB(size_t shards) : kv_store(shards) {}
 };
 
-std::vector<std::string> parse_resp(const std::string& data) {
-    std::vector<std::string> tokens;
-    size_t pos = 0;
-    while (pos < data.size()) {
-        size_t rn = data.find("\r\n", pos);
-        if (rn == std::string::npos) break;
-        std::string line = data.substr(pos, rn - pos);
-        pos = rn + 2;
-
-        if (line.empty()) continue;
-        if (line[0] == '*' || line[0] == '$') continue;
-
-        tokens.push_back(line);
+static bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) != b[i]) return false;
     }
-    return tokens;
+    return true;
 }
 
-Task handle_client(AsyncSocket client, RedisDB& db) {
-    char buf[4096];
+static void append_bulk(std::string& out, std::string_view v) {
+    out.append("$").append(std::to_string(v.size())).append("\r\n").append(v).append("\r\n");
+}
 
-    while (true) {
-        ssize_t n = co_await client.read(buf, sizeof(buf));
-        if (n <= 0) {
-            std::cout << "[Client Disconnected] fd: " << client.fd() << "\n";
-            co_return;
-        }
+// Appends the reply to `out`; returns false once the client has asked to QUIT
+bool execute(const std::vector<std::string_view>& args, RedisDB& db, std::string& out) {
+    std::string_view cmd = args[0];
 
-        std::string req_data(buf, n);
-        auto args = parse_resp(req_data);
-        if (args.empty()) continue;
+    if (iequals(cmd, "PING")) {
+        if (args.size() > 1) append_bulk(out, args[1]);
+        else out.append("+PONG\r\n");
 
-        std::string cmd = args[0];
-        std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
+    } else if (iequals(cmd, "SET") && args.size() >= 3) {
+        db.kv_store.set(args[1], args[2]);
+        out.append("+OK\r\n");
 
-        if (cmd == "PING") {
-            co_await client.write("+PONG\r\n");
+    } else if (iequals(cmd, "GET") && args.size() == 2) {
+        // The reply is formatted straight from the table, under the shard lock
+        if (!db.kv_store.get(args[1], [&](std::string_view v) { append_bulk(out, v); })) {
+            out.append("$-1\r\n");
+        }
 
-        } else if (cmd == "SET" && args.size() >= 3) {
-            const std::string& key = args[1];
-            const std::string& val = args[2];
+    } else if (iequals(cmd, "DEL") && args.size() >= 2) {
+        int count = 0;
+        for (size_t i = 1; i < args.size(); ++i) count += db.kv_store.del(args[i]) ? 1 : 0;
+        out.append(":").append(std::to_string(count)).append("\r\n");
 
-            {
-                auto guard = co_await db.mutex.lock();
-                db.kv_store[key] = val; // std::map 支持相同的下标操作
-            }
+    } else if (iequals(cmd, "QUIT")) {
+        out.append("+OK\r\n");
+        return false;
 
-            co_await client.write("+OK\r\n");
+    } else {
+        out.append("-ERR unknown command\r\n");
+    }
+    return true;
+}
 
-        } else if (cmd == "GET" && args.size() >= 2) {
-            const std::string& key = args[1];
-            std::string response;
+Task handle_client(AsyncSocket client, RedisDB& db) {
+    // A pipeline whose replies outgrow this is answered in several writes
+    constexpr size_t kMaxPendingReply = 64 * 1024;
+
+    // Holds pooled chunks only while unparsed bytes are in it: an idle connection holds none
+    IoBuffer in;
+    RespParser parser;
+    std::vector<std::string_view> args;
+    std::string out;
+    bool open = true;
+
+    while (open) {
+        // A command known to be larger than what is buffered gets one run big enough for all of it,
+        // so large bulk strings are read straight into place
+        if (parser.needed() > in.size()) in.reserve(parser.needed());
+        ssize_t n = co_await client.read(in);
+        if (n <= 0) {
+            std::cout << "[Client Disconnected] fd: " << client.fd() << "\n";
+            co_return;
+        }
 
-            {
-                auto guard = co_await db.mutex.lock();
-                auto it = db.kv_store.find(key); // std::map 支持相同的 find 操作
-                if (it != db.kv_store.end()) {
-                    response = "$" + std::to_string(it->second.size()) + "\r\n" + it->second + "\r\n";
-                } else {
-                    response = "$-1\r\n";
+        // Pipelining: run every complete command in the buffer, answer them with a single write
+        bool more = true;
+        while (more) {
+            more = false;
+            while (open) {
+                if (out.size() >= kMaxPendingReply) {
+                    more = true;
+                    break;
+                }
+                std::string_view w = in.front();
+                long used = parser.parse(w.data(), w.size(), args);
+                if (used == RespParser::kIncomplete) {
+                    // The command may go on in the next chunk: join them and try again
+                    if (in.grow_front(std::max(parser.needed(), w.size() + 1))) continue;
+                    break;
+                }
+                if (used == RespParser::kError) {
+                    out.append("-ERR Protocol error\r\n");
+                    open = false;
+                    break;
                 }
+                if (!args.empty()) open = execute(args, db, out);
+                in.consume(used); // Views into `in` die here: the chunk may go back to the pool
             }
-            co_await client.write(response);
 
-        } else if (cmd == "DEL" && args.size() >= 2) {
-            const std::string& key = args[1];
-            int count = 0;
-
-            {
-                auto guard = co_await db.mutex.lock();
-                count = db.kv_store.erase(key); // std::map 支持相同的 erase 操作
+            if (!out.empty()) {
+                if (co_await client.write_all(out.data(), out.size()) < 0) co_return;
+                out.clear();
             }
-            co_await client.write(":" + std::to_string(count) + "\r\n");
-
-        } else if (cmd == "QUIT") {
-            co_await client.write("+OK\r\n");
-            co_return;
-
-        } else {
-            co_await client.write("-ERR unknown command\r\n");
         }
     }
 }
 
-Task start_redis_server(Scheduler& sched, int port) {
-    TcpListener listener(sched.reactor());
-    if (listener.bind("0.0.0.0", port) < 0) {
-        std::cerr << "Miniredis bind failed on port " << port << "!\n";
-        co_return;
-    }
-
-    std::cout << "=> Miniredis is running on 0.0.0.0:" << port << "\n";
-    std::cout << "=> Using std::map (Red-Black Tree) for KV storage.\n";
-
-    RedisDB db(sched);
-
-    while (true) {
-        AsyncSocket client = co_await listener.accept();
-        sched.spawn(handle_client(std::move(client), db));
-    }
-}
-
 int main() {
+    // One Poller per Worker: a connection's wake-ups come back to the Worker that accepted it
+    Scheduler sched(SchedulerOptions{.workers = 4, .poller_per_worker = true, .pin_workers = true});
+    RedisDB db(sched.worker_count() * 16);
+
+    // One SO_REUSEPORT listener + accept loop per Worker
+    auto on_accept = [&db](AsyncSocket client) { return handle_client(std::move(client), db); };
+    if (!serve_sharded(sched, "0.0.0.0", 6379, on_accept)) {
+        std::cerr << "Miniredis bind failed on port 6379!\n";
+        return 1;
+    }
 
-    Scheduler sched(4);
-    sched.spawn(start_redis_server(sched, 6379));
+    std::cout << "=> Miniredis is running on 0.0.0.0:6379 (" << sched.worker_count() << " listeners)\n";
+    std::cout << "=> Using a " << db.kv_store.shard_count() << "-way sharded hash table for KV storage.\n";
 
     while (true) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-    
+
     return 0;
-}
\ No newline at end of file
+}
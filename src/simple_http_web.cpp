@@ -1,55 +1,44 @@
 #include "scheduler.h"
 #include "socket.h"
+#include "http/http_connection.h"
 #include <string_view>
 
-static constexpr std::string_view RAW_RESPONSE =
-    "HTTP/1.1 200 OK\r\n"
-    "Content-Type: text/plain\r\n"
-    "Content-Length: 13\r\n"
-    "Connection: keep-alive\r\n"
-    "\r\n"
-    "Hello, World!";
+int main() {
 
+    HttpRouter router;
 
-Task handle_client(AsyncSocket socket) {
+    // Same reply as src/main.go, now per parsed request: pipelined requests each get theirs
+    router.get("/", [](const HttpRequest&, HttpResponse& res) {
+        res.body_ref = "Hello, World!";
+    });
 
-    char buf[1024];
+    router.get("/json", [](const HttpRequest&, HttpResponse& res) {
+        res.content_type = "application/json";
+        res.body_ref = R"({"message":"Hello, World!"})";
+    });
 
-    while (true) {
-        ssize_t n = co_await socket.read(buf, sizeof(buf));
+    // Content-Length or chunked: the connection hands over the whole body
+    router.post("/echo", [](const HttpRequest& req, HttpResponse& res) {
+        res.content_type = "application/octet-stream";
+        res.body.assign(req.body);
+    });
 
-        if (n <= 0) break;
+    // Handlers returning Task may suspend; the connection awaits them in order
+    router.get("/slow", [](const HttpRequest&, HttpResponse& res) -> Task {
+        co_await sleep_for(Worker::current()->scheduler(), 10);
+        res.body_ref = "Slept 10 ms";
+    });
 
-        ssize_t ret = co_await socket.write(RAW_RESPONSE.data(), RAW_RESPONSE.size());
+    // Per-Worker Pollers + one SO_REUSEPORT listener per Worker: no single accept path
+    Scheduler sched(SchedulerOptions{.poller_per_worker = true});
 
-        if (ret <= 0) break;
-    }
-
-}
-
-Task start_server(Scheduler& sched, int port) {
-    TcpListener listener(sched.reactor());
-
-    if (listener.bind("0.0.0.0", port) < 0) {
-        co_return;
+    if (!serve_sharded(sched, "0.0.0.0", 8080, [&](AsyncSocket s) { return HttpConnection::serve(std::move(s), router); })) {
+        return 1;
     }
 
-    while (true) {
-        AsyncSocket client = co_await listener.accept();
-
-        sched.spawn(handle_client(std::move(client)));
-    }
-}
-
-int main() {
-
-    Scheduler sched;
-
-    sched.spawn(start_server(sched, 8080));
-
     while (true) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
     return 0;
-}
\ No newline at end of file
+}